@@ -17,7 +17,10 @@
 
 var odbc = require("bindings")("odbc_bindings")
   , SimpleQueue = require("./simple-queue")
+  , StatementCache = require("./statement-cache")
   , util = require("util")
+  , Readable = require("stream").Readable
+  , StringDecoder = require("string_decoder").StringDecoder
   ;
 
 module.exports = function (options) {
@@ -32,6 +35,8 @@ module.exports.ODBCConnection = odbc.ODBCConnection;
 module.exports.ODBCStatement = odbc.ODBCStatement;
 module.exports.ODBCResult = odbc.ODBCResult;
 module.exports.loadODBCLibrary = odbc.loadODBCLibrary;
+module.exports.setGlobalLock = odbc.setGlobalLock;
+module.exports.setWorkerThreads = odbc.setWorkerThreads;
 
 module.exports.open = function (connectionString, options, cb) {
   var db;
@@ -68,6 +73,16 @@ function Database(options) {
   self.odbc = (options.odbc) ? options.odbc : new odbc.ODBC();
   self.queue = new SimpleQueue();
   self.fetchMode = options.fetchMode || null;
+  self.chunkSize = options.chunkSize || null;
+  self.rowArraySize = options.rowArraySize || null;
+  //how timestamps are returned: odbc.DATE_OBJECT, DATE_NUMBER or DATE_STRING
+  self.dateMode = options.dateMode || null;
+  //fetch BIGINT as BigInt and NUMERIC/DECIMAL as decimal strings
+  self.exactNumbers = options.exactNumbers || false;
+  //number of prepared statements kept for parameterized queries; 0 disables
+  self.statementCache = new StatementCache(options.statementCacheSize);
+  //seconds a query may run before it fails with HYT00; 0 means no limit
+  self.queryTimeout = options.queryTimeout || 0;
   self.connected = false;
   self.connectTimeout = (options.hasOwnProperty('connectTimeout')) 
     ? options.connectTimeout
@@ -165,6 +180,8 @@ Database.prototype.close = function (cb) {
       if (cb) cb(null);
       return next();
     }
+    
+    self.clearStatementCache();
 
     self.conn.close(function (err) {
       self.connected = false;
@@ -179,6 +196,8 @@ Database.prototype.close = function (cb) {
 Database.prototype.closeSync = function () {
   var self = this;
   
+  self.clearStatementCache();
+  
   var result = self.conn.closeSync();
   
   self.connected = false;
@@ -201,16 +220,44 @@ Database.prototype.query = function (sql, params, cb) {
   
   self.queue.push(function (next) {
     function cbQuery (initialErr, result) {
+      if (!result) {
+        //a cached statement failed to prepare or execute
+        cb(initialErr, [], false);
+        
+        return next();
+      }
+      
       fetchMore();
       
       function fetchMore() {
         if (self.fetchMode) {
           result.fetchMode = self.fetchMode;
         }
+        
+        if (self.chunkSize) {
+          result.chunkSize = self.chunkSize;
+        }
+        
+        if (self.rowArraySize) {
+          result.rowArraySize = self.rowArraySize;
+        }
+        
+        if (self.dateMode) {
+          result.dateMode = self.dateMode;
+        }
+        
+        if (self.exactNumbers) {
+          result.exactNumbers = true;
+        }
+        
+        //so that cancel() can stop the fetch as well as the execution
+        self.activeResult = result;
          
         result.fetchAll(function (err, data) {
           var moreResults, moreResultsError = null;
           
+          self.activeResult = null;
+          
           try {
             moreResults = result.moreResultsSync();
           }
@@ -251,7 +298,13 @@ Database.prototype.query = function (sql, params, cb) {
       }
     }
     
-    if (params) {
+    if (params && params.length && self.statementCache.size) {
+      self.executeCached(sql, params, cbQuery);
+    }
+    else if (self.queryTimeout) {
+      self.conn.query({ sql : sql, params : params || [], timeout : self.queryTimeout }, cbQuery);
+    }
+    else if (params) {
       self.conn.query(sql, params, cbQuery);
     }
     else {
@@ -260,6 +313,136 @@ Database.prototype.query = function (sql, params, cb) {
   });
 };
 
+//cancel the query this connection is executing or fetching the rows of, if
+//any. Its callback is called with an error. Returns whether there was
+//anything to cancel.
+Database.prototype.cancel = function () {
+  var self = this;
+  
+  if (!self.connected) {
+    return false;
+  }
+  
+  if (self.activeResult) {
+    return self.activeResult.cancel();
+  }
+  
+  if (self.activeStatement) {
+    return self.activeStatement.cancel();
+  }
+  
+  return self.conn.cancel();
+};
+
+//execute sql with a prepared statement from the statement cache,
+//preparing and caching one first if needed
+Database.prototype.executeCached = function (sql, params, cb) {
+  var self = this
+    , stmt = self.statementCache.get(sql)
+    ;
+  
+  if (stmt) {
+    return execute(stmt);
+  }
+  
+  self.conn.createStatement(function (err, stmt) {
+    if (err) {
+      return cb(err);
+    }
+    
+    stmt.prepare(sql, function (err) {
+      if (err) {
+        stmt.closeSync();
+        
+        return cb(err);
+      }
+      
+      if (self.queryTimeout) {
+        stmt.setQueryTimeoutSync(self.queryTimeout);
+      }
+      
+      self.statementCache.set(sql, stmt);
+      
+      execute(stmt);
+    });
+  });
+  
+  function execute (stmt) {
+    //so that cancel() can find it
+    self.activeStatement = stmt;
+    
+    stmt.execute(params, function (err, result) {
+      self.activeStatement = null;
+      
+      //the statement may have been invalidated, by a schema change for
+      //instance; prepare it again next time
+      if (err && !keepsCachedStatement(err)) {
+        self.statementCache.remove(sql);
+      }
+      
+      cb(err, result);
+    });
+  }
+};
+
+//whether a statement that failed with err is still worth keeping in the
+//statement cache: the data was at fault (integrity constraint violations,
+//class 23) or the execution was cancelled or timed out
+function keepsCachedStatement (err) {
+  var state = err && err.state;
+  
+  return typeof state === 'string'
+    && (state.indexOf('23') === 0 || state === 'HY008' || state === 'HYT00');
+}
+
+Database.prototype.executeCachedSync = function (sql, params) {
+  var self = this
+    , stmt = self.statementCache.get(sql)
+    ;
+  
+  if (!stmt) {
+    stmt = self.conn.createStatementSync();
+    
+    try {
+      stmt.prepareSync(sql);
+    }
+    catch (e) {
+      stmt.closeSync();
+      
+      throw e;
+    }
+    
+    if (self.queryTimeout) {
+      stmt.setQueryTimeoutSync(self.queryTimeout);
+    }
+    
+    self.statementCache.set(sql, stmt);
+  }
+  
+  try {
+    stmt.bindSync(params);
+    
+    return stmt.executeSync();
+  }
+  catch (e) {
+    if (!keepsCachedStatement(e)) {
+      self.statementCache.remove(sql);
+    }
+    
+    throw e;
+  }
+};
+
+//close all cached prepared statements. Called when the connection is closed
+//or reset, since the server may have dropped the prepared plans.
+Database.prototype.clearStatementCache = function () {
+  this.statementCache.clear();
+};
+
+Database.prototype.getStatementCacheStats = function () {
+  return this.statementCache.stats();
+};
+
 Database.prototype.queryResult = function (sql, params, cb) {
   var self = this;
   
@@ -292,6 +475,22 @@ Database.prototype.queryResult = function (sql, params, cb) {
         result.fetchMode = self.fetchMode;
       }
       
+      if (self.chunkSize) {
+        result.chunkSize = self.chunkSize;
+      }
+      
+      if (self.rowArraySize) {
+        result.rowArraySize = self.rowArraySize;
+      }
+      
+      if (self.dateMode) {
+        result.dateMode = self.dateMode;
+      }
+      
+      if (self.exactNumbers) {
+        result.exactNumbers = true;
+      }
+      
       cb(err, result);
       
       return next();
@@ -317,6 +516,14 @@ Database.prototype.queryResultSync = function (sql, params) {
     result.fetchMode = self.fetchMode;
   }
   
+  if (self.dateMode) {
+    result.dateMode = self.dateMode;
+  }
+  
+  if (self.exactNumbers) {
+    result.exactNumbers = true;
+  }
+  
   return result;
 };
 
@@ -327,7 +534,13 @@ Database.prototype.querySync = function (sql, params) {
     throw ({ message : "Connection not open."});
   }
   
-  if (params) {
+  if (params && params.length && self.statementCache.size) {
+    result = self.executeCachedSync(sql, params);
+  }
+  else if (self.queryTimeout) {
+    result = self.conn.querySync({ sql : sql, params : params || [], timeout : self.queryTimeout });
+  }
+  else if (params) {
     result = self.conn.querySync(sql, params);
   }
   else {
@@ -338,6 +551,14 @@ Database.prototype.querySync = function (sql, params) {
     result.fetchMode = self.fetchMode;
   }
   
+  if (self.dateMode) {
+    result.dateMode = self.dateMode;
+  }
+  
+  if (self.exactNumbers) {
+    result.exactNumbers = true;
+  }
+  
   var data = result.fetchAllSync();
   
   result.closeSync();
@@ -345,6 +566,205 @@ Database.prototype.querySync = function (sql, params) {
   return data;
 };
 
+Database.prototype.queryStream = function (sql, params, options) {
+  var self = this, stream, result = null, reading = false, querying = false
+    , done = false, finished = false, destroyed = false, release = null;
+  
+  if (!Array.isArray(params)) {
+    options = params;
+    params = null;
+  }
+  
+  options = options || {};
+  
+  //each chunk pushed to the stream is an array of up to chunkSize rows;
+  //only one chunk is buffered ahead of the consumer so the next fetchBatch
+  //isn't issued until the previous chunk has been read
+  stream = new Readable({ objectMode : true, highWaterMark : 1 });
+  
+  stream._read = function () {
+    if (reading || done) {
+      return;
+    }
+    
+    if (!result) {
+      //wait for the query to run
+      return;
+    }
+    
+    fetchBatch();
+  };
+  
+  //a consumer that stops early (destroy, pipeline errors) must still close
+  //the result and free the connection for the queries queued behind it
+  stream._destroy = function (err, cb) {
+    abort();
+    cb(err);
+  };
+  
+  //streams of older node versions have no destroy()
+  if (typeof stream.destroy !== 'function') {
+    stream.destroy = function (err) {
+      abort();
+      
+      if (err) {
+        stream.emit("error", err);
+      }
+      
+      stream.emit("close");
+    };
+  }
+  
+  if (!self.connected) {
+    process.nextTick(function () {
+      done = true;
+      stream.emit("error", { message : "Connection not open."});
+    });
+    
+    return stream;
+  }
+  
+  //the connection is held for the life of the stream because the
+  //result set has to stay open between batches
+  self.queue.push(function (next) {
+    if (destroyed) {
+      return next();
+    }
+    
+    release = next;
+    querying = true;
+    
+    if (self.queryTimeout) {
+      self.conn.query({ sql : sql, params : params || [], timeout : self.queryTimeout }, cbQuery);
+    }
+    else if (params) {
+      self.conn.query(sql, params, cbQuery);
+    }
+    else {
+      self.conn.query(sql, cbQuery);
+    }
+  });
+  
+  return stream;
+  
+  function cbQuery (err, res) {
+    querying = false;
+    
+    if (err) {
+      return finish(err);
+    }
+    
+    result = res;
+    
+    if (destroyed) {
+      return finish(null);
+    }
+    
+    if (options.fetchMode || self.fetchMode) {
+      result.fetchMode = options.fetchMode || self.fetchMode;
+    }
+    
+    if (options.chunkSize || self.chunkSize) {
+      result.chunkSize = options.chunkSize || self.chunkSize;
+    }
+    
+    if (options.rowArraySize || self.rowArraySize) {
+      result.rowArraySize = options.rowArraySize || self.rowArraySize;
+    }
+    
+    if (options.dateMode || self.dateMode) {
+      result.dateMode = options.dateMode || self.dateMode;
+    }
+    
+    if (options.exactNumbers || self.exactNumbers) {
+      result.exactNumbers = true;
+    }
+    
+    fetchBatch();
+  }
+  
+  function fetchBatch () {
+    //the consumer may have destroyed the stream while a chunk was pushed
+    if (done) {
+      return;
+    }
+    
+    reading = true;
+    
+    result.fetchBatch(function (err, rows, moreRows) {
+      reading = false;
+      
+      if (destroyed) {
+        return finish(null);
+      }
+      
+      if (err) {
+        return finish(err);
+      }
+      
+      if (!moreRows) {
+        if (!Array.isArray(rows) || rows.length) {
+          stream.push(rows);
+        }
+        
+        return finish(null);
+      }
+      
+      if (stream.push(rows)) {
+        fetchBatch();
+      }
+    });
+  }
+  
+  //destroy the stream: finish now if nothing is in flight, otherwise once
+  //the running query or fetch calls back
+  function abort () {
+    if (destroyed || finished) {
+      return;
+    }
+    
+    destroyed = true;
+    done = true;
+    
+    if (release && !querying && !reading) {
+      finish(null);
+    }
+  }
+  
+  function finish (err) {
+    if (finished) {
+      return;
+    }
+    
+    finished = true;
+    done = true;
+    
+    if (result) {
+      try {
+        result.closeSync();
+      }
+      catch (e) {
+        err = err || e;
+      }
+      
+      result = null;
+    }
+    
+    release();
+    
+    if (destroyed) {
+      return;
+    }
+    
+    if (err) {
+      stream.emit("error", err);
+    }
+    else {
+      stream.push(null);
+    }
+  }
+};
+
 Database.prototype.beginTransaction = function (cb) {
   var self = this;
   
@@ -533,36 +953,41 @@ odbc.ODBCStatement.prototype._executeDirect = odbc.ODBCStatement.prototype.execu
 odbc.ODBCStatement.prototype._executeNonQuery = odbc.ODBCStatement.prototype.executeNonQuery;
 odbc.ODBCStatement.prototype._prepare = odbc.ODBCStatement.prototype.prepare;
 odbc.ODBCStatement.prototype._bind = odbc.ODBCStatement.prototype.bind;
+odbc.ODBCStatement.prototype._executeBatch = odbc.ODBCStatement.prototype.executeBatch;
 
 odbc.ODBCStatement.prototype.execute = function (params, cb) {
   var self = this;
   
-  self.queue = self.queue || new SimpleQueue();
-  
-  if (!cb) {
+  if (typeof params === 'function') {
     cb = params;
     params = null;
   }
   
+  if (!cb) {
+    return promised(self, self.execute, [params]);
+  }
+  
+  self.queue = self.queue || new SimpleQueue();
+  
   self.queue.push(function (next) {
     //If params were passed to this function, then bind them and
     //then execute.
     if (params) {
-      self._bind(params, function (err) {
+      bindParams(self, params, function (err) {
         if (err) {
           return cb(err);
         }
         
-        self._execute(function (err, result) {
+        self._execute(withParamData(self, false, function (err, result) {
           cb(err, result);
           
           return next();
-        });
+        }));
       });
     }
     //Otherwise execute and pop the next bind call
     else {
-      self._execute(function (err, result) {
+      self._execute(withParamData(self, false, function (err, result) {
         cb(err, result);
         
         //NOTE: We only execute the next queued bind call after
@@ -572,7 +997,7 @@ odbc.ODBCStatement.prototype.execute = function (params, cb) {
         self.bindQueue && self.bindQueue.next();
         
         return next();
-      });
+      }));
     }
   });
 };
@@ -580,6 +1005,10 @@ odbc.ODBCStatement.prototype.execute = function (params, cb) {
 odbc.ODBCStatement.prototype.executeDirect = function (sql, cb) {
   var self = this;
   
+  if (!cb) {
+    return promised(self, self.executeDirect, [sql]);
+  }
+  
   self.queue = self.queue || new SimpleQueue();
   
   self.queue.push(function (next) {
@@ -594,32 +1023,36 @@ odbc.ODBCStatement.prototype.executeDirect = function (sql, cb) {
 odbc.ODBCStatement.prototype.executeNonQuery = function (params, cb) {
   var self = this;
   
-  self.queue = self.queue || new SimpleQueue();
-  
-  if (!cb) {
+  if (typeof params === 'function') {
     cb = params;
     params = null;
   }
   
+  if (!cb) {
+    return promised(self, self.executeNonQuery, [params]);
+  }
+  
+  self.queue = self.queue || new SimpleQueue();
+  
   self.queue.push(function (next) {
     //If params were passed to this function, then bind them and
     //then executeNonQuery.
     if (params) {
-      self._bind(params, function (err) {
+      bindParams(self, params, function (err) {
         if (err) {
           return cb(err);
         }
         
-        self._executeNonQuery(function (err, result) {
+        self._executeNonQuery(withParamData(self, true, function (err, result) {
           cb(err, result);
           
           return next();
-        });
+        }));
       });
     }
     //Otherwise executeNonQuery and pop the next bind call
     else {
-      self._executeNonQuery(function (err, result) {
+      self._executeNonQuery(withParamData(self, true, function (err, result) {
         cb(err, result);
         
         //NOTE: We only execute the next queued bind call after
@@ -628,15 +1061,45 @@ odbc.ODBCStatement.prototype.executeNonQuery = function (params, cb) {
         // actually executing that bind. Not 
         self.bindQueue && self.bindQueue.next();
         
+        return next();
+      }));
+    }
+  });
+};
+
+odbc.ODBCStatement.prototype.executeBatch = function (rows, cb) {
+  var self = this;
+  
+  if (!cb) {
+    return promised(self, self.executeBatch, [rows]);
+  }
+  
+  self.queue = self.queue || new SimpleQueue();
+  
+  self.queue.push(function (next) {
+    //bad rows are rejected synchronously; don't let that stall the queue
+    try {
+      self._executeBatch(rows, function (err, result) {
+        cb(err, result);
+        
         return next();
       });
     }
+    catch (e) {
+      cb(e);
+      
+      return next();
+    }
   });
 };
 
 odbc.ODBCStatement.prototype.prepare = function (sql, cb) {
   var self = this;
   
+  if (!cb) {
+    return promised(self, self.prepare, [sql]);
+  }
+  
   self.queue = self.queue || new SimpleQueue();
   
   self.queue.push(function (next) {
@@ -651,10 +1114,14 @@ odbc.ODBCStatement.prototype.prepare = function (sql, cb) {
 odbc.ODBCStatement.prototype.bind = function (ary, cb) {
   var self = this;
   
+  if (!cb) {
+    return promised(self, self.bind, [ary]);
+  }
+  
   self.bindQueue = self.bindQueue || new SimpleQueue();
   
   self.bindQueue.push(function () {
-    self._bind(ary, function (err) {
+    bindParams(self, ary, function (err) {
       cb(err);
       
       //NOTE: we do not call next() here because
@@ -665,154 +1132,924 @@ odbc.ODBCStatement.prototype.bind = function (ary, cb) {
 };
 
 
-//proxy the ODBCResult fetch function so that it is queued
-odbc.ODBCResult.prototype._fetch = odbc.ODBCResult.prototype.fetch;
+//odbc.streamParameter(source, options) - wrap a Readable stream or an Array
+//  of Buffers so that it is sent in chunks with SQLPutData while a prepared
+//  statement executes, instead of being bound as one value.
+//options.text - send the data as character data instead of binary
+//options.length - total byte length, for drivers that need it up front
+module.exports.streamParameter = function (source, options) {
+  return new StreamParameter(source, options);
+};
 
-odbc.ODBCResult.prototype.fetch = function (cb) {
-  var self = this;
+function StreamParameter (source, options) {
+  options = options || {};
+  
+  this.source = source;
+  this.binary = !options.text;
+  this.length = (typeof options.length === 'number') ? options.length : null;
+  
+  if (this.length === null && Array.isArray(source)) {
+    this.length = source.reduce(function (total, chunk) {
+      return total + chunk.length;
+    }, 0);
+  }
+}
 
-  self.queue = self.queue || new SimpleQueue();
+module.exports.StreamParameter = StreamParameter;
 
-  self.queue.push(function (next) {
-    self._fetch(function (err, data) {
-      if (cb) cb(err, data);
+//bind params, replacing streamed parameters with data-at-execution
+//descriptors. A Readable or an Array of Buffers passed directly is
+//streamed as binary data.
+function bindParams (stmt, params, cb) {
+  var streams = null;
+  
+  params = params.map(function (param, index) {
+    if (!(param instanceof StreamParameter)) {
+      if (isReadable(param) || isBufferList(param)) {
+        param = new StreamParameter(param);
+      }
+      else {
+        return param;
+      }
+    }
+    
+    streams = streams || {};
+    streams[index] = param;
+    
+    //a byte length of UTF-8 text does not tell the length once it is sent
+    //as UTF-16, so wide text is sent without one
+    return {
+      dataAtExec : true,
+      binary : param.binary,
+      length : (param.binary || !odbc.ODBC.UNICODE) ? param.length : null
+    };
+  });
+  
+  stmt.streamParams = streams;
+  
+  stmt._bind(params, cb);
+}
 
-      return next();
+//call a queued method with a callback that settles a new Promise. The
+//native methods return their Promise directly; these wrappers have to wait
+//for the statement or result queue first. Builds without native Promises
+//still require the callback.
+function promised (self, fn, args) {
+  if (!odbc.ODBC.NATIVE_PROMISES) {
+    throw new TypeError("Argument " + args.length + " must be a function");
+  }
+  
+  return new Promise(function (resolve, reject) {
+    fn.apply(self, args.concat(function (err, result) {
+      if (err) {
+        return reject(err);
+      }
+      
+      resolve(result);
+    }));
+  });
+}
+
+function isReadable (obj) {
+  return obj !== null && typeof obj === 'object' 
+    && typeof obj.pipe === 'function' && typeof obj.on === 'function';
+}
+
+function isBufferList (obj) {
+  return Array.isArray(obj) && obj.length > 0 && obj.every(Buffer.isBuffer);
+}
+
+//wrap a native execute callback so that data-at-execution parameters are
+//sent when the driver asks for them. For executeNonQuery the result is
+//closed and the row count is passed on instead.
+function withParamData (stmt, nonQuery, cb) {
+  return function (err, result, needData) {
+    if (err || !needData) {
+      return cb(err, result);
+    }
+    
+    putParams(stmt, function (err, result, rowCount) {
+      //the streams have been consumed; a later execute without new params
+      //fails in putParams instead of waiting on them
+      stmt.streamParams = null;
+      
+      if (err || !nonQuery) {
+        return cb(err, result);
+      }
+      
+      result.closeSync();
+      
+      return cb(null, rowCount);
+    });
+  };
+}
+
+function putParams (stmt, cb) {
+  stmt.paramData(function (err, index, result, rowCount) {
+    if (err) {
+      return cb(err);
+    }
+    
+    if (index === -1) {
+      return cb(null, result, rowCount);
+    }
+    
+    var param = stmt.streamParams && stmt.streamParams[index];
+    
+    if (!param) {
+      stmt.cancel();
+      
+      return cb({ message : "No stream is bound to parameter " + index
+        + "; a streamed parameter is consumed by one execution, bind a new one" });
+    }
+    
+    putParam(stmt, param, function (err) {
+      if (err) {
+        stmt.cancel();
+        
+        return cb(err);
+      }
+      
+      putParams(stmt, cb);
     });
   });
+}
+
+//send every chunk of param.source with putData, one at a time. A stream is
+//paused while its chunk is being sent so no more than one chunk is held in
+//memory.
+function putParam (stmt, param, cb) {
+  var source = param.source
+    , encode = chunkEncoder(param)
+    , sent = 0, pending = false, ended = false, done = false;
+  
+  if (Array.isArray(source)) {
+    return (function putChunk (i) {
+      var chunk = (i < source.length) ? encode(source[i]) : encode(null);
+      
+      if (i >= source.length && !chunk.length) {
+        return (sent) ? cb(null) : stmt.putData(new Buffer(0), cb);
+      }
+      
+      if (!chunk.length) {
+        return putChunk(i + 1);
+      }
+      
+      sent++;
+      
+      stmt.putData(chunk, function (err) {
+        if (err) {
+          return cb(err);
+        }
+        
+        putChunk(i + 1);
+      });
+    })(0);
+  }
+  
+  if ((source._readableState && source._readableState.endEmitted)
+    || source.readableEnded) {
+    return cb({ message : "The stream of a parameter has already ended" });
+  }
+  
+  source.on('data', onData);
+  source.once('end', onEnd);
+  source.once('error', finish);
+  
+  function onData (chunk) {
+    chunk = encode(chunk);
+    
+    if (!chunk.length) {
+      return;
+    }
+    
+    source.pause();
+    pending = true;
+    sent++;
+    
+    stmt.putData(chunk, function (err) {
+      pending = false;
+      
+      if (err) {
+        return finish(err);
+      }
+      
+      if (ended) {
+        return putLast();
+      }
+      
+      source.resume();
+    });
+  }
+  
+  function onEnd () {
+    ended = true;
+    
+    if (!pending) {
+      putLast();
+    }
+  }
+  
+  //send what the encoder held back, or an empty chunk if nothing was sent
+  function putLast () {
+    var chunk = encode(null);
+    
+    if (sent && !chunk.length) {
+      return finish(null);
+    }
+    
+    stmt.putData(chunk, finish);
+  }
+  
+  function finish (err) {
+    if (done) {
+      return;
+    }
+    
+    done = true;
+    
+    source.removeListener('data', onData);
+    source.removeListener('end', onEnd);
+    source.removeListener('error', finish);
+    
+    cb(err || null);
+  }
+}
+
+//return a function that turns a chunk of a streamed parameter into the
+//Buffer sent with putData, or flushes what is left when passed null. Text is
+//re-encoded as UTF-16LE for UNICODE builds, which bind it as SQL_C_WCHAR;
+//UTF-8 sequences split across chunks are held back until they are complete.
+function chunkEncoder (param) {
+  var decoder;
+  
+  if (param.binary || !odbc.ODBC.UNICODE) {
+    return function (chunk) {
+      if (chunk === null) {
+        return new Buffer(0);
+      }
+      
+      return (Buffer.isBuffer(chunk)) ? chunk : new Buffer(String(chunk));
+    };
+  }
+  
+  decoder = new StringDecoder('utf8');
+  
+  return function (chunk) {
+    if (chunk === null) {
+      return new Buffer(decoder.end(), 'ucs2');
+    }
+    
+    return new Buffer((Buffer.isBuffer(chunk))
+      ? decoder.write(chunk)
+      : String(chunk), 'ucs2');
+  };
+}
+
+
+//proxy the ODBCResult fetch function so that it is queued
+odbc.ODBCResult.prototype._fetch = odbc.ODBCResult.prototype.fetch;
+
+//options.streamColumns - names or indexes of columns that are returned as
+//  Readable streams of Buffers instead of values. They must be the last
+//  columns of the select list and be read in order; the next fetch waits
+//  until every stream of the current row has read its column or has been
+//  destroyed. Streams nobody is reading when the next fetch is called are
+//  destroyed. A NULL column is null instead of a stream, unless it follows
+//  a column that is a stream.
+//options.streamChunkSize - bytes read per SQLGetData call (default 65536)
+odbc.ODBCResult.prototype.fetch = function (options, cb) {
+  var self = this;
+  
+  if (typeof options === 'function') {
+    cb = options;
+    options = null;
+  }
+  
+  if (!cb) {
+    return promised(self, self.fetch, [options]);
+  }
+  
+  //the previous row must be released before this fetch can run, so skip
+  //the columns the consumer has left alone
+  if (self.columnStreams) {
+    self.columnStreams.forEach(function (stream) {
+      if (!stream.columnEnded && !stream.listeners('data').length
+          && !stream.listeners('readable').length) {
+        stream.destroy();
+      }
+    });
+  }
+
+  self.queue = self.queue || new SimpleQueue();
+
+  self.queue.push(function (next) {
+    var streamColumns = null, names, fetchOptions = options;
+    
+    if (options && options.streamColumns) {
+      names = self.getColumnNamesSync();
+      streamColumns = getStreamColumns(names, options.streamColumns);
+      
+      if (streamColumns.error) {
+        if (cb) cb(streamColumns.error);
+        
+        return next();
+      }
+      
+      fetchOptions = {};
+      
+      Object.keys(options).forEach(function (key) {
+        fetchOptions[key] = options[key];
+      });
+      
+      fetchOptions.streamColumns = streamColumns;
+    }
+    
+    var done = function (err, data) {
+      var pending = 0, previous = null
+        , chunkSize = options && options.streamChunkSize || 65536;
+      
+      if (err || !data || !streamColumns) {
+        if (cb) cb(err, data);
+        
+        return next();
+      }
+      
+      self.columnStreams = [];
+      
+      //read the first chunk of each column to tell NULL from a value. That
+      //is only possible until a column turns out to be a stream, since
+      //looking at a later column would skip the rest of it.
+      (function probe (i) {
+        var column = streamColumns[i]
+          , key = (Array.isArray(data)) ? column : names[column];
+        
+        if (i === streamColumns.length) {
+          if (cb) cb(null, data);
+          
+          if (!pending) {
+            self.columnStreams = null;
+            next();
+          }
+          
+          return;
+        }
+        
+        if (previous) {
+          data[key] = addStream(column, null);
+          
+          return probe(i + 1);
+        }
+        
+        self.getData(column, chunkSize, function (err, chunk, more) {
+          if (err) {
+            self.columnStreams = null;
+            
+            if (cb) cb(err);
+            
+            return next();
+          }
+          
+          data[key] = (chunk) ? addStream(column, { chunk : chunk, more : more }) : null;
+          
+          probe(i + 1);
+        });
+      })(0);
+      
+      function addStream (column, first) {
+        var stream = createColumnStream(self, column, previous, chunkSize, first);
+        
+        //the row is done with once every stream has read its column to
+        //the end, whether or not the consumer has read it all yet
+        if (!stream.columnEnded) {
+          pending++;
+          stream.once('columnend', release);
+        }
+        
+        self.columnStreams.push(stream);
+        
+        return previous = stream;
+      }
+      
+      function release () {
+        if (--pending === 0) {
+          self.columnStreams = null;
+          next();
+        }
+      }
+    };
+    
+    if (fetchOptions) {
+      self._fetch(fetchOptions, done);
+    }
+    else {
+      self._fetch(done);
+    }
+  });
 };
 
+//resolve streamColumns to sorted column indexes and make sure no regular
+//column follows them, since SQLGetData can only move forward through a row
+function getStreamColumns (names, columns) {
+  var indexes = [], i, index;
+  
+  for (i = 0; i < columns.length; i++) {
+    index = (typeof columns[i] === 'number') ? columns[i] : names.indexOf(columns[i]);
+    
+    if (index < 0 || index >= names.length) {
+      indexes.error = { message : "Unknown stream column: " + columns[i] };
+      return indexes;
+    }
+    
+    if (indexes.indexOf(index) === -1) {
+      indexes.push(index);
+    }
+  }
+  
+  indexes.sort(function (a, b) { return a - b; });
+  
+  if (indexes[indexes.length - 1] - indexes[0] !== indexes.length - 1 
+      || indexes[indexes.length - 1] !== names.length - 1) {
+    indexes.error = { message : "Stream columns must be the last columns of the result." };
+  }
+  
+  return indexes;
+}
+
+//a Readable that pulls one column of the current row with getData, starting
+//with the chunk the row was probed with, if any. A stream for a later column
+//does not start reading until the previous one is done. Destroying a stream
+//gives up the rest of its column; the next getData or fetch skips it.
+function createColumnStream (result, column, previous, chunkSize, first) {
+  var stream, reading = false, destroyed = false;
+  
+  stream = new Readable({ highWaterMark : chunkSize });
+  stream.columnEnded = false;
+  
+  if (first) {
+    stream.push(first.chunk);
+    
+    if (!first.more) {
+      stream.columnEnded = true;
+      stream.push(null);
+    }
+  }
+  
+  stream._read = function () {
+    if (reading || stream.columnEnded || destroyed) {
+      return;
+    }
+    
+    reading = true;
+    
+    if (previous && !previous.columnEnded) {
+      return previous.once('columnend', function () {
+        reading = false;
+        
+        if (destroyed) {
+          return finish();
+        }
+        
+        stream._read();
+      });
+    }
+    
+    result.getData(column, chunkSize, function (err, chunk, more) {
+      var last = !chunk || !more;
+      
+      reading = false;
+      
+      if (destroyed) {
+        return finish();
+      }
+      
+      if (err) {
+        finish();
+        return stream.emit('error', err);
+      }
+      
+      //mark the column as done before pushing, push may call _read again
+      if (last) {
+        finish();
+      }
+      
+      if (chunk && chunk.length) {
+        stream.push(chunk);
+      }
+      
+      if (last) {
+        stream.push(null);
+      }
+    });
+  };
+  
+  stream._destroy = function (err, cb) {
+    skip();
+    cb(err);
+  };
+  
+  //streams of older node versions have no destroy()
+  if (typeof stream.destroy !== 'function') {
+    stream.destroy = function (err) {
+      skip();
+      
+      if (err) {
+        stream.emit('error', err);
+      }
+      
+      stream.emit('close');
+    };
+  }
+  
+  return stream;
+  
+  //a read in progress finishes the column when it calls back
+  function skip () {
+    if (destroyed) {
+      return;
+    }
+    
+    destroyed = true;
+    
+    if (!reading) {
+      finish();
+    }
+  }
+  
+  function finish () {
+    if (stream.columnEnded) {
+      return;
+    }
+    
+    stream.columnEnded = true;
+    stream.emit('columnend');
+  }
+}
+
 module.exports.Pool = Pool;
 
 Pool.count = 0;
 
+//options:
+//  maxPoolSize      - most connections open per connection string (0 = no limit)
+//  minPoolSize      - connections kept open even when idle
+//  acquireTimeout   - ms an open() may wait for a free connection (0 = forever)
+//  idleTimeout      - ms an idle connection above minPoolSize is kept (0 = forever)
+//  validationQuery  - run before handing out a connection; failures reconnect
+//  resetConnection  - reset connections with SQL_ATTR_RESET_CONNECTION (default true)
+//  resetStatement   - sql run to reset a connection the driver can't reset
+//
+//a connection that can't be reset is closed and reopened as before.
 function Pool (options) {
   var self = this;
   self.index = Pool.count++;
   self.availablePool = {};
   self.usedPool = {};
+  self.pendingCount = {};
+  self.waitingQueue = {};
   self.odbc = new odbc.ODBC();
   self.options = options || {}
   self.options.odbc = self.odbc;
+  self.maxPoolSize = self.options.maxPoolSize || 0;
+  self.minPoolSize = self.options.minPoolSize || 0;
+  self.acquireTimeout = self.options.acquireTimeout || 0;
+  self.idleTimeout = self.options.idleTimeout || 0;
+  self.validationQuery = self.options.validationQuery || null;
+  self.resetStatement = self.options.resetStatement || null;
+  self.resetConnection = self.options.resetConnection !== false;
+  self.closed = false;
 }
 
 Pool.prototype.open = function (connectionString, callback) {
   var self = this
-    , db
+    , waiter
     ;
 
-  //check to see if we already have a connection for this connection string
-  if (self.availablePool[connectionString] && self.availablePool[connectionString].length) {
-    db = self.availablePool[connectionString].shift()
-    self.usedPool[connectionString].push(db)
-
-    callback(null, db);
+  if (self.closed) {
+    return callback({ message : "Pool is closed." });
   }
-  else {
-    db = new Database(self.options);
-    db.realClose = db.close;
-    
-    db.close = function (cb) {
-      //call back early, we can do the rest of this stuff after the client thinks
-      //that the connection is closed.
-      cb(null);
-      
-      
-      //close the connection for real
-      //this will kill any temp tables or anything that might be a security issue.
-      db.realClose(function () {
-         //remove this db from the usedPool
-         self.usedPool[connectionString].splice(self.usedPool[connectionString].indexOf(db), 1);
-
-        //re-open the connection using the connection string
-        db.open(connectionString, function (error) {
-          if (error) {
-            console.error(error);
-            return;
-          }
-          
-          //add this clean connection to the connection pool
-          self.availablePool[connectionString] = self.availablePool[connectionString] || [];
-          self.availablePool[connectionString].push(db);
-          exports.debug && console.dir(self);
-        });
-      });
-    };
+
+  if (!self.availablePool[connectionString]) {
+    self.availablePool[connectionString] = [];
+    self.usedPool[connectionString] = [];
+    self.pendingCount[connectionString] = 0;
+    self.waitingQueue[connectionString] = [];
     
-    db.open(connectionString, function (error) {
-      exports.debug && console.log("odbc.js : pool[%s] : pool.db.open callback()", self.index);
+    self.fill(connectionString);
+  }
 
-      self.usedPool[connectionString] = self.usedPool[connectionString] || [];
+  //check to see if we already have a connection for this connection string
+  if (self.availablePool[connectionString].length) {
+    return self.checkout(connectionString, self.availablePool[connectionString].shift(), callback);
+  }
+  
+  if (!self.maxPoolSize || self.size(connectionString) < self.maxPoolSize) {
+    return self.connect(connectionString, function (error, db) {
+      if (error) {
+        return callback(error);
+      }
+      
       self.usedPool[connectionString].push(db);
-
-      callback(error, db);
+      
+      callback(null, db);
     });
   }
+  
+  //the pool is full; wait in line for a connection to be released
+  waiter = { callback : callback, timer : null };
+  
+  if (self.acquireTimeout) {
+    waiter.timer = setTimeout(function () {
+      var queue = self.waitingQueue[connectionString];
+      
+      queue.splice(queue.indexOf(waiter), 1);
+      
+      callback({ message : "Timed out waiting for a connection from the pool." });
+    }, self.acquireTimeout);
+  }
+  
+  self.waitingQueue[connectionString].push(waiter);
+  
+  exports.debug && console.log("odbc.js : pool[%s] : pool.open() - waiting, %s in queue", self.index, self.waitingQueue[connectionString].length);
 };
 
-Pool.prototype.close = function (callback) {
+Pool.prototype.size = function (connectionString) {
+  var self = this;
+  
+  return self.availablePool[connectionString].length 
+    + self.usedPool[connectionString].length 
+    + self.pendingCount[connectionString];
+};
+
+Pool.prototype.connect = function (connectionString, callback) {
   var self = this
-    , required = 0
-    , received = 0
-    , connections
-    , key
-    , x
+    , db = new Database(self.options)
     ;
-
-  exports.debug && console.log("odbc.js : pool[%s] : pool.close()", self.index);
-  //we set a timeout because a previous db.close() may
-  //have caused the a behind the scenes db.open() to prepare
-  //a new connection
-  setTimeout(function () {
-    //merge the available pool and the usedPool
-    var pools = {};
-
-    for (key in self.availablePool) {
-      pools[key] = (pools[key] || []).concat(self.availablePool[key]);
+  
+  self.pendingCount[connectionString] += 1;
+  
+  db.realClose = db.close;
+  
+  db.close = function (cb) {
+    //call back early, we can do the rest of this stuff after the client thinks
+    //that the connection is closed.
+    cb && cb(null);
+    
+    self.release(connectionString, db);
+  };
+  
+  db.open(connectionString, function (error) {
+    exports.debug && console.log("odbc.js : pool[%s] : pool.db.open callback()", self.index);
+    
+    self.pendingCount[connectionString] -= 1;
+    
+    if (error) {
+      return callback(error);
     }
-
-    for (key in self.usedPool) {
-      pools[key] = (pools[key] || []).concat(self.usedPool[key]);
+    
+    if (self.closed) {
+      db.realClose(function () {});
+      
+      return callback({ message : "Pool is closed." });
     }
+    
+    callback(null, db);
+  });
+};
 
-    exports.debug && console.log("odbc.js : pool[%s] : pool.close() - setTimeout() callback", self.index);
-    exports.debug && console.dir(pools);
+Pool.prototype.fill = function (connectionString) {
+  var self = this;
+  
+  while (!self.closed && self.size(connectionString) < self.minPoolSize) {
+    self.connect(connectionString, function (error, db) {
+      if (error) {
+        exports.debug && console.log("odbc.js : pool[%s] : pool.fill() - %s", self.index, error.message);
+        return;
+      }
+      
+      self.checkin(connectionString, db);
+    });
+  }
+};
 
-    if (Object.keys(pools).length == 0) {
-      return callback();
+Pool.prototype.checkout = function (connectionString, db, callback) {
+  var self = this;
+  
+  clearTimeout(db.idleTimer);
+  db.idleTimer = null;
+  
+  self.usedPool[connectionString].push(db);
+  
+  if (!self.validationQuery) {
+    return callback(null, db);
+  }
+  
+  db.query(self.validationQuery, function (error, data, moreResults) {
+    if (moreResults) {
+      return;
     }
+    
+    if (!error) {
+      return callback(null, db);
+    }
+    
+    exports.debug && console.log("odbc.js : pool[%s] : validation failed - %s", self.index, error.message);
+    
+    //drop the broken connection and try again with another one
+    self.destroy(connectionString, db);
+    self.open(connectionString, callback);
+  });
+};
 
-    for (key in pools) {
-      connections = pools[key];
-      required += connections.length;
-
-      exports.debug && console.log("odbc.js : pool[%s] : pool.close() - processing pools %s - connections: %s", self.index, key, connections.length);
+Pool.prototype.checkin = function (connectionString, db) {
+  var self = this
+    , available = self.availablePool[connectionString]
+    , waiter = self.waitingQueue[connectionString].shift()
+    ;
+  
+  if (waiter) {
+    clearTimeout(waiter.timer);
+    
+    return self.checkout(connectionString, db, waiter.callback);
+  }
+  
+  available.push(db);
+  
+  if (self.idleTimeout) {
+    db.idleTimer = setTimeout(function () {
+      db.idleTimer = null;
+      
+      if (self.size(connectionString) > self.minPoolSize && available.indexOf(db) !== -1) {
+        exports.debug && console.log("odbc.js : pool[%s] : closing idle connection", self.index);
+        
+        self.destroy(connectionString, db);
+      }
+    }, self.idleTimeout);
+  }
+  
+  exports.debug && console.dir(self);
+};
 
-      for (x = 0 ; x < connections.length; x ++) {
-        (function (x) {
-          //call the realClose method to avoid
-          //automatically re-opening the connection
-          exports.debug && console.log("odbc.js : pool[%s] : pool.close() - calling realClose() for connection #%s", self.index, x);
+Pool.prototype.release = function (connectionString, db) {
+  var self = this
+    , used = self.usedPool[connectionString]
+    , index = used.indexOf(db)
+    ;
+  
+  //already released, or pool.close() has already closed it
+  if (index === -1) {
+    return;
+  }
+  
+  used.splice(index, 1);
+  
+  //the connection is busy until it has been reset so that a waiter can't
+  //be handed one that still has another client's session state
+  self.pendingCount[connectionString] += 1;
+  
+  self.reset(db, function (error) {
+    self.pendingCount[connectionString] -= 1;
+    
+    //prepared plans don't survive a reset
+    db.clearStatementCache();
+    
+    if (!error && !self.closed) {
+      return self.checkin(connectionString, db);
+    }
+    
+    exports.debug && error && console.log("odbc.js : pool[%s] : reset failed, reconnecting - %s", self.index, error.message);
+    
+    //close the connection for real
+    //this will kill any temp tables or anything that might be a security issue.
+    self.destroy(connectionString, db);
+  });
+};
 
-          connections[x].realClose(function () {
-            exports.debug && console.log("odbc.js : pool[%s] : pool.close() - realClose() callback for connection #%s", self.index, x);
-            received += 1;
+Pool.prototype.reset = function (db, callback) {
+  var self = this;
+  
+  if (!self.resetConnection) {
+    return resetStatement({ message : "Connection reset is disabled." });
+  }
+  
+  db.conn.reset(function (error) {
+    if (!error) {
+      return callback(null);
+    }
+    
+    //the driver doesn't support SQL_ATTR_RESET_CONNECTION
+    resetStatement(error);
+  });
+  
+  function resetStatement (resetError) {
+    var statementError = null;
+    
+    if (!self.resetStatement) {
+      return callback(resetError);
+    }
+    
+    db.query(self.resetStatement, function (error, data, moreResults) {
+      statementError = statementError || error;
+      
+      if (!moreResults) {
+        callback(statementError);
+      }
+    });
+  }
+};
 
-            if (received === required) {
-              callback();
+Pool.prototype.destroy = function (connectionString, db) {
+  var self = this
+    , available = self.availablePool[connectionString]
+    , used = self.usedPool[connectionString]
+    , waiting = self.waitingQueue[connectionString]
+    ;
+  
+  clearTimeout(db.idleTimer);
+  
+  if (available.indexOf(db) !== -1) {
+    available.splice(available.indexOf(db), 1);
+  }
+  
+  if (used.indexOf(db) !== -1) {
+    used.splice(used.indexOf(db), 1);
+  }
+  
+  db.realClose(function () {});
+  
+  if (self.closed) {
+    return;
+  }
+  
+  //replace the connection for anyone waiting on one
+  while (waiting.length && (!self.maxPoolSize || self.size(connectionString) < self.maxPoolSize)) {
+    (function (waiter) {
+      clearTimeout(waiter.timer);
+      
+      self.connect(connectionString, function (error, db) {
+        if (error) {
+          return waiter.callback(error);
+        }
+        
+        self.usedPool[connectionString].push(db);
+        
+        waiter.callback(null, db);
+      });
+    })(waiting.shift());
+  }
+  
+  self.fill(connectionString);
+};
 
-              //prevent mem leaks
-              self = null;
-              connections = null;
-              required = null;
-              received = null;
-              key = null;
+Pool.prototype.close = function (callback) {
+  var self = this
+    , required = 0
+    , received = 0
+    , connections = []
+    , key
+    , x
+    ;
 
-              return;
-            }
-          });
-        })(x);
+  exports.debug && console.log("odbc.js : pool[%s] : pool.close()", self.index);
+  
+  self.closed = true;
+  
+  for (key in self.waitingQueue) {
+    self.waitingQueue[key].forEach(function (waiter) {
+      clearTimeout(waiter.timer);
+      waiter.callback({ message : "Pool is closed." });
+    });
+    
+    self.waitingQueue[key] = [];
+  }
+  
+  //merge the available pool and the usedPool. Connections still being
+  //opened or reset are closed as soon as they are done.
+  for (key in self.availablePool) {
+    connections = connections.concat(self.availablePool[key], self.usedPool[key]);
+    
+    self.availablePool[key] = [];
+    self.usedPool[key] = [];
+  }
+  
+  exports.debug && console.log("odbc.js : pool[%s] : pool.close() - %s connections", self.index, connections.length);
+  
+  if (connections.length == 0) {
+    return callback();
+  }
+  
+  required = connections.length;
+  
+  for (x = 0 ; x < connections.length; x ++) {
+    clearTimeout(connections[x].idleTimer);
+    
+    //call the realClose method to avoid returning the connection to the pool
+    connections[x].realClose(function () {
+      received += 1;
+      
+      if (received === required) {
+        callback();
       }
-    }
-  }, 2000);
+    });
+  }
 };
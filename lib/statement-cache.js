@@ -0,0 +1,93 @@
+module.exports = StatementCache;
+
+//least recently used cache of prepared ODBCStatements keyed by sql
+function StatementCache(size) {
+  var self = this;
+  
+  self.size = size || 0;
+  self.statements = {};
+  self.order = [];
+  self.hits = 0;
+  self.misses = 0;
+  self.evictions = 0;
+}
+
+StatementCache.prototype.get = function (sql) {
+  var self = this
+    , stmt = self.statements.hasOwnProperty(sql) ? self.statements[sql] : null
+    ;
+  
+  if (!stmt) {
+    self.misses += 1;
+    
+    return null;
+  }
+  
+  self.hits += 1;
+  
+  //move to the most recently used end
+  self.order.splice(self.order.indexOf(sql), 1);
+  self.order.push(sql);
+  
+  return stmt;
+};
+
+//add a statement, closing the least recently used one if the cache is full
+StatementCache.prototype.set = function (sql, stmt) {
+  var self = this
+    , evicted
+    ;
+  
+  self.remove(sql);
+  
+  if (self.order.length >= self.size) {
+    evicted = self.order.shift();
+    
+    self.statements[evicted].closeSync();
+    delete self.statements[evicted];
+    
+    self.evictions += 1;
+  }
+  
+  self.statements[sql] = stmt;
+  self.order.push(sql);
+};
+
+StatementCache.prototype.remove = function (sql) {
+  var self = this;
+  
+  if (self.statements.hasOwnProperty(sql)) {
+    self.statements[sql].closeSync();
+    delete self.statements[sql];
+    
+    self.order.splice(self.order.indexOf(sql), 1);
+  }
+};
+
+//close every cached statement; used when the connection is reset or closed
+StatementCache.prototype.clear = function () {
+  var self = this;
+  
+  self.order.forEach(function (sql) {
+    try {
+      self.statements[sql].closeSync();
+    }
+    catch (e) {
+      //the connection may already be gone
+    }
+  });
+  
+  self.statements = {};
+  self.order = [];
+};
+
+StatementCache.prototype.stats = function () {
+  var self = this;
+  
+  return {
+    hits : self.hits,
+    misses : self.misses,
+    evictions : self.evictions,
+    size : self.order.length
+  };
+};
@@ -101,6 +101,12 @@ pfnSQLDrivers           pSQLDrivers;
 pfnSQLDataSources       pSQLDataSources;
 pfnSQLGetInfo           pSQLGetInfo;
 pfnSQLMoreResults       pSQLMoreResults;
+pfnSQLSetStmtAttr       pSQLSetStmtAttr;
+pfnSQLSetPos            pSQLSetPos;
+pfnSQLParamData         pSQLParamData;
+pfnSQLPutData           pSQLPutData;
+pfnSQLNumParams         pSQLNumParams;
+pfnSQLDescribeParam     pSQLDescribeParam;
 
 //#define LOAD_ENTRY( hMod, Name ) (p##Name = (pfn##Name) GetProcAddress( (hMod), #Name ))
 #define LOAD_ENTRY( hMod, Name ) (p##Name = (pfn##Name) GetFunction( (hMod), #Name ))
@@ -149,8 +155,8 @@ BOOL DynLoadODBC( char* odbcModuleName )
 
   //Unused-> if (LOAD_ENTRY( hMod, SQLDataSources    )  )
 //#endif
-  //Unused-> if (LOAD_ENTRY( hMod, SQLBindCol        )  )
-  //Unused-> if (LOAD_ENTRY( hMod, SQLCancel         )  )
+  if (LOAD_ENTRY( hMod, SQLBindCol        )  )
+  if (LOAD_ENTRY( hMod, SQLCancel         )  )
   //Unused-> if (LOAD_ENTRY( hMod, SQLConnect       )  )
   //Unused-> if (LOAD_ENTRY( hMod, SQLDescribeCol    )  )
   if (LOAD_ENTRY( hMod, SQLDisconnect     )  )
@@ -175,7 +181,13 @@ BOOL DynLoadODBC( char* odbcModuleName )
   if (LOAD_ENTRY( hMod, SQLSetEnvAttr     )  )
   if (LOAD_ENTRY( hMod, SQLFreeStmt       )  )
   if (LOAD_ENTRY( hMod, SQLPrepare        )  )
-  //Unused-> if (LOAD_ENTRY( hMod, SQLGetInfo        )  )
+  if (LOAD_ENTRY( hMod, SQLGetInfo        )  )
+  if (LOAD_ENTRY( hMod, SQLSetStmtAttr    )  )
+  if (LOAD_ENTRY( hMod, SQLSetPos         )  )
+  if (LOAD_ENTRY( hMod, SQLParamData      )  )
+  if (LOAD_ENTRY( hMod, SQLPutData        )  )
+  if (LOAD_ENTRY( hMod, SQLNumParams      )  )
+  if (LOAD_ENTRY( hMod, SQLDescribeParam  )  )
   if (LOAD_ENTRY( hMod, SQLBindParameter  )  )
   if (LOAD_ENTRY( hMod, SQLMoreResults    )
           ) {
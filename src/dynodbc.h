@@ -34,12 +34,12 @@ typedef RETCODE (SQL_API * pfnSQLAllocStmt)(
   HSTMT  FAR *phstmt);
 
 typedef RETCODE (SQL_API * pfnSQLBindCol)(
-  HSTMT       hstmt,
-  UWORD       icol,
-  SWORD       fCType,
-  PTR         rgbValue,
-  SDWORD      cbValueMax,
-  SDWORD FAR *pcbValue);
+  SQLHSTMT       StatementHandle,
+  SQLUSMALLINT   ColumnNumber,
+  SQLSMALLINT    TargetType,
+  SQLPOINTER     TargetValuePtr,
+  SQLLEN         BufferLength,
+  SQLLEN *       StrLen_or_IndPtr);
 
 typedef RETCODE (SQL_API * pfnSQLCancel)(
   HSTMT       hstmt);
@@ -296,6 +296,39 @@ typedef RETCODE (SQL_API * pfnSQLGetInfo)(
 typedef RETCODE (SQL_API * pfnSQLMoreResults)(
   HSTMT       hstmt);
 
+typedef RETCODE (SQL_API * pfnSQLSetStmtAttr)(
+  SQLHSTMT       StatementHandle,
+  SQLINTEGER     Attribute,
+  SQLPOINTER     ValuePtr,
+  SQLINTEGER     StringLength);
+
+typedef RETCODE (SQL_API * pfnSQLSetPos)(
+  SQLHSTMT       StatementHandle,
+  SQLSETPOSIROW  RowNumber,
+  SQLUSMALLINT   Operation,
+  SQLUSMALLINT   LockType);
+
+typedef RETCODE (SQL_API * pfnSQLParamData)(
+  SQLHSTMT       StatementHandle,
+  SQLPOINTER *   ValuePtrPtr);
+
+typedef RETCODE (SQL_API * pfnSQLPutData)(
+  SQLHSTMT       StatementHandle,
+  SQLPOINTER     DataPtr,
+  SQLLEN         StrLen_or_Ind);
+
+typedef RETCODE (SQL_API * pfnSQLNumParams)(
+  SQLHSTMT       StatementHandle,
+  SQLSMALLINT *  ParameterCountPtr);
+
+typedef RETCODE (SQL_API * pfnSQLDescribeParam)(
+  SQLHSTMT       StatementHandle,
+  SQLUSMALLINT   ParameterNumber,
+  SQLSMALLINT *  DataTypePtr,
+  SQLULEN *      ParameterSizePtr,
+  SQLSMALLINT *  DecimalDigitsPtr,
+  SQLSMALLINT *  NullablePtr);
+
 extern pfnSQLGetData            pSQLGetData;
 extern pfnSQLGetFunctions       pSQLGetFunctions;
 extern pfnSQLAllocConnect       pSQLAllocConnect;
@@ -344,6 +377,12 @@ extern pfnSQLDataSources        pSQLDataSources;
 extern pfnSQLBindParameter      pSQLBindParameter;
 extern pfnSQLGetInfo            pSQLGetInfo;
 extern pfnSQLMoreResults        pSQLMoreResults;
+extern pfnSQLSetStmtAttr        pSQLSetStmtAttr;
+extern pfnSQLSetPos             pSQLSetPos;
+extern pfnSQLParamData          pSQLParamData;
+extern pfnSQLPutData            pSQLPutData;
+extern pfnSQLNumParams          pSQLNumParams;
+extern pfnSQLDescribeParam      pSQLDescribeParam;
 
 BOOL DynLoadODBC( char* odbcModuleName );
 
@@ -379,5 +418,12 @@ BOOL DynLoadODBC( char* odbcModuleName );
 #define SQLBindParameter pSQLBindParameter
 #define SQLPrimaryKeys pSQLPrimaryKeys
 #define SQLSetEnvAttr pSQLSetEnvAttr
+#define SQLSetStmtAttr pSQLSetStmtAttr
+#define SQLSetPos pSQLSetPos
+#define SQLParamData pSQLParamData
+#define SQLPutData pSQLPutData
+#define SQLNumParams pSQLNumParams
+#define SQLDescribeParam pSQLDescribeParam
+#define SQLCancel pSQLCancel
 #endif
 #endif // _SRC_DYNODBC_H_
@@ -20,6 +20,8 @@
 #include <node.h>
 #include <node_version.h>
 #include <time.h>
+#include <math.h>
+#include <stdio.h>
 #include <uv.h>
 
 #include "odbc.h"
@@ -39,7 +41,14 @@ using namespace v8;
 using namespace node;
 
 uv_mutex_t ODBC::g_odbcMutex;
+volatile bool ODBC::g_globalLock = false;
 uv_async_t ODBC::g_async;
+uv_mutex_t ODBC::g_bufferPoolMutex;
+BufferPool ODBC::g_bufferPool;
+uv_mutex_t ODBC::g_workerMutex;
+uv_cond_t ODBC::g_workerCond;
+uv_async_t ODBC::g_workerAsync;
+WorkerPool ODBC::g_workerPool;
 
 Persistent<Function> ODBC::constructor;
 
@@ -70,10 +79,58 @@ void ODBC::Init(v8::Handle<Object> exports) {
   constructor_template->Set(NanNew<String>("SQL_DESTROY"), NanNew<Number>(SQL_DESTROY), constant_attributes);
   constructor_template->Set(NanNew<String>("FETCH_ARRAY"), NanNew<Number>(FETCH_ARRAY), constant_attributes);
   NODE_ODBC_DEFINE_CONSTANT(constructor_template, FETCH_OBJECT);
+  NODE_ODBC_DEFINE_CONSTANT(constructor_template, FETCH_COLUMNS);
+  NODE_ODBC_DEFINE_CONSTANT(constructor_template, DATE_OBJECT);
+  NODE_ODBC_DEFINE_CONSTANT(constructor_template, DATE_NUMBER);
+  NODE_ODBC_DEFINE_CONSTANT(constructor_template, DATE_STRING);
+  NODE_ODBC_DEFINE_CONSTANT(constructor_template, SQL_PARAM_SUCCESS);
+  NODE_ODBC_DEFINE_CONSTANT(constructor_template, SQL_PARAM_SUCCESS_WITH_INFO);
+  NODE_ODBC_DEFINE_CONSTANT(constructor_template, SQL_PARAM_ERROR);
+  NODE_ODBC_DEFINE_CONSTANT(constructor_template, SQL_PARAM_UNUSED);
+  NODE_ODBC_DEFINE_CONSTANT(constructor_template, SQL_PARAM_DIAG_UNAVAILABLE);
+  
+  //SQL types for typed parameters
+  NODE_ODBC_DEFINE_CONSTANT(constructor_template, SQL_CHAR);
+  NODE_ODBC_DEFINE_CONSTANT(constructor_template, SQL_VARCHAR);
+  NODE_ODBC_DEFINE_CONSTANT(constructor_template, SQL_LONGVARCHAR);
+  NODE_ODBC_DEFINE_CONSTANT(constructor_template, SQL_WCHAR);
+  NODE_ODBC_DEFINE_CONSTANT(constructor_template, SQL_WVARCHAR);
+  NODE_ODBC_DEFINE_CONSTANT(constructor_template, SQL_WLONGVARCHAR);
+  NODE_ODBC_DEFINE_CONSTANT(constructor_template, SQL_DECIMAL);
+  NODE_ODBC_DEFINE_CONSTANT(constructor_template, SQL_NUMERIC);
+  NODE_ODBC_DEFINE_CONSTANT(constructor_template, SQL_BIT);
+  NODE_ODBC_DEFINE_CONSTANT(constructor_template, SQL_TINYINT);
+  NODE_ODBC_DEFINE_CONSTANT(constructor_template, SQL_SMALLINT);
+  NODE_ODBC_DEFINE_CONSTANT(constructor_template, SQL_INTEGER);
+  NODE_ODBC_DEFINE_CONSTANT(constructor_template, SQL_BIGINT);
+  NODE_ODBC_DEFINE_CONSTANT(constructor_template, SQL_REAL);
+  NODE_ODBC_DEFINE_CONSTANT(constructor_template, SQL_FLOAT);
+  NODE_ODBC_DEFINE_CONSTANT(constructor_template, SQL_DOUBLE);
+  NODE_ODBC_DEFINE_CONSTANT(constructor_template, SQL_BINARY);
+  NODE_ODBC_DEFINE_CONSTANT(constructor_template, SQL_VARBINARY);
+  NODE_ODBC_DEFINE_CONSTANT(constructor_template, SQL_LONGVARBINARY);
+  NODE_ODBC_DEFINE_CONSTANT(constructor_template, SQL_TYPE_DATE);
+  NODE_ODBC_DEFINE_CONSTANT(constructor_template, SQL_TYPE_TIME);
+  NODE_ODBC_DEFINE_CONSTANT(constructor_template, SQL_TYPE_TIMESTAMP);
+  
+  //whether async methods called without a callback return a Promise
+#ifdef NODE_ODBC_PROMISE
+  constructor_template->Set(NanNew<String>("NATIVE_PROMISES"), NanTrue(), constant_attributes);
+#else
+  constructor_template->Set(NanNew<String>("NATIVE_PROMISES"), NanFalse(), constant_attributes);
+#endif
+  
+  //whether character data is exchanged with the driver as UTF-16
+#ifdef UNICODE
+  constructor_template->Set(NanNew<String>("UNICODE"), NanTrue(), constant_attributes);
+#else
+  constructor_template->Set(NanNew<String>("UNICODE"), NanFalse(), constant_attributes);
+#endif
   
   // Prototype Methods
   NODE_SET_PROTOTYPE_METHOD(constructor_template, "createConnection", CreateConnection);
   NODE_SET_PROTOTYPE_METHOD(constructor_template, "createConnectionSync", CreateConnectionSync);
+  NODE_SET_PROTOTYPE_METHOD(constructor_template, "getBufferStats", GetBufferStats);
 
   // Attach the Database Constructor to the target object
   NanAssignPersistent(constructor, constructor_template->GetFunction());
@@ -98,6 +155,217 @@ void ODBC::Init(v8::Handle<Object> exports) {
   
   // Initialize the cross platform mutex provided by libuv
   uv_mutex_init(&ODBC::g_odbcMutex);
+  uv_mutex_init(&ODBC::g_bufferPoolMutex);
+  
+  //completion of work run on our own worker threads. It is only
+  //referenced while there is work outstanding.
+  uv_mutex_init(&ODBC::g_workerMutex);
+  uv_cond_init(&ODBC::g_workerCond);
+  uv_async_init(uv_default_loop(), &ODBC::g_workerAsync, ODBC::WorkerDone);
+  uv_unref((uv_handle_t *) &ODBC::g_workerAsync);
+}
+
+/*
+ * GlobalLock
+ *
+ * Take g_odbcMutex if global locking is on. Returns whether it was taken,
+ * which has to be passed to GlobalUnlock so that turning global locking on
+ * or off in the meantime can't unbalance the mutex.
+ */
+
+bool ODBC::GlobalLock() {
+  bool locked = g_globalLock;
+  
+  if (locked) {
+    uv_mutex_lock(&ODBC::g_odbcMutex);
+  }
+  
+  return locked;
+}
+
+/*
+ * GlobalUnlock
+ */
+
+void ODBC::GlobalUnlock(bool locked) {
+  if (locked) {
+    uv_mutex_unlock(&ODBC::g_odbcMutex);
+  }
+}
+
+/*
+ * SetGlobalLock
+ *
+ * setGlobalLock(true) serializes connecting and all statement handle
+ * management across the process, as every operation used to be. It is meant
+ * to be called before any connection is opened; work already running on the
+ * thread pool keeps the setting it started with, so toggling it while work is
+ * in flight is unsupported.
+ */
+
+NAN_METHOD(ODBC::SetGlobalLock) {
+  NanScope();
+  
+  REQ_BOOL_ARG(0, globalLock);
+  
+  //waits for a locked operation to finish before turning the lock off
+  uv_mutex_lock(&ODBC::g_odbcMutex);
+  g_globalLock = globalLock->Value();
+  uv_mutex_unlock(&ODBC::g_odbcMutex);
+  
+  NanReturnUndefined();
+}
+
+/*
+ * QueueWork
+ *
+ * Run work on a worker thread and then after on the event loop thread.
+ * Uses the libuv threadpool unless setWorkerThreads() has started threads
+ * of our own, so that slow queries can't starve fs/dns work or each other.
+ */
+
+int ODBC::QueueWork(uv_work_t* req, uv_work_cb work, uv_after_work_cb after) {
+  if (g_workerPool.threadCount == 0) {
+    return uv_queue_work(uv_default_loop(), req, work, after);
+  }
+  
+  WorkItem* item = (WorkItem *) calloc(1, sizeof(WorkItem));
+  
+  item->req = req;
+  item->work = work;
+  item->after = after;
+  
+  //keep the loop alive until the work has been completed
+  if (g_workerPool.outstanding++ == 0) {
+    uv_ref((uv_handle_t *) &g_workerAsync);
+  }
+  
+  uv_mutex_lock(&g_workerMutex);
+  
+  if (g_workerPool.pendingTail) {
+    g_workerPool.pendingTail->next = item;
+  }
+  else {
+    g_workerPool.pendingHead = item;
+  }
+  
+  g_workerPool.pendingTail = item;
+  
+  uv_cond_signal(&g_workerCond);
+  
+  uv_mutex_unlock(&g_workerMutex);
+  
+  return 0;
+}
+
+/*
+ * WorkerThread
+ */
+
+void ODBC::WorkerThread(void* arg) {
+  for (;;) {
+    uv_mutex_lock(&g_workerMutex);
+    
+    while (g_workerPool.pendingHead == NULL) {
+      uv_cond_wait(&g_workerCond, &g_workerMutex);
+    }
+    
+    WorkItem* item = g_workerPool.pendingHead;
+    
+    g_workerPool.pendingHead = item->next;
+    
+    if (g_workerPool.pendingHead == NULL) {
+      g_workerPool.pendingTail = NULL;
+    }
+    
+    uv_mutex_unlock(&g_workerMutex);
+    
+    item->next = NULL;
+    item->work(item->req);
+    
+    uv_mutex_lock(&g_workerMutex);
+    
+    if (g_workerPool.doneTail) {
+      g_workerPool.doneTail->next = item;
+    }
+    else {
+      g_workerPool.doneHead = item;
+    }
+    
+    g_workerPool.doneTail = item;
+    
+    uv_mutex_unlock(&g_workerMutex);
+    
+    //several sends may be coalesced into a single WorkerDone call
+    uv_async_send(&g_workerAsync);
+  }
+}
+
+/*
+ * WorkerDone
+ *
+ * Run the after callbacks of everything the worker threads have finished.
+ */
+
+NAUV_WORK_CB(ODBC::WorkerDone) {
+  uv_mutex_lock(&g_workerMutex);
+  
+  WorkItem* item = g_workerPool.doneHead;
+  
+  g_workerPool.doneHead = NULL;
+  g_workerPool.doneTail = NULL;
+  
+  uv_mutex_unlock(&g_workerMutex);
+  
+  while (item) {
+    WorkItem* next = item->next;
+    
+    g_workerPool.outstanding--;
+    
+    //this may queue more work, e.g. the next fetchAll chunk
+    item->after(item->req, 0);
+    
+    free(item);
+    
+    item = next;
+  }
+  
+  if (g_workerPool.outstanding == 0) {
+    uv_unref((uv_handle_t *) &g_workerAsync);
+  }
+}
+
+/*
+ * SetWorkerThreads
+ *
+ * setWorkerThreads(n) runs all ODBC work on n threads owned by this module
+ * instead of the libuv threadpool. Threads can be added but not removed.
+ */
+
+NAN_METHOD(ODBC::SetWorkerThreads) {
+  NanScope();
+  
+  if (args.Length() < 1 || !args[0]->IsInt32() || args[0]->Int32Value() < 0) {
+    return NanThrowTypeError("Argument 0 must be a non-negative integer");
+  }
+  
+  int threadCount = args[0]->Int32Value();
+  
+  if (threadCount < g_workerPool.threadCount) {
+    return NanThrowError("Worker threads can't be stopped once started");
+  }
+  
+  while (g_workerPool.threadCount < threadCount) {
+    uv_thread_t thread;
+    
+    if (uv_thread_create(&thread, WorkerThread, NULL) != 0) {
+      return NanThrowError("Could not start an ODBC worker thread");
+    }
+    
+    g_workerPool.threadCount++;
+  }
+  
+  NanReturnUndefined();
 }
 
 ODBC::~ODBC() {
@@ -180,7 +448,7 @@ NAN_METHOD(ODBC::CreateConnection) {
 
   work_req->data = data;
   
-  uv_queue_work(uv_default_loop(), work_req, UV_CreateConnection, (uv_after_work_cb)UV_AfterCreateConnection);
+  ODBC::QueueWork(work_req, UV_CreateConnection, (uv_after_work_cb)UV_AfterCreateConnection);
 
   dbo->Ref();
 
@@ -296,6 +564,8 @@ Column* ODBC::GetColumns(SQLHSTMT hStmt, short* colCount) {
   for (int i = 0; i < *colCount; i++) {
     //save the index number of this column
     columns[i].index = i + 1;
+    columns[i].dateMode = DATE_OBJECT;
+    columns[i].exactNumbers = false;
     //TODO:that's a lot of memory for each field name....
     columns[i].name = new unsigned char[MAX_FIELD_SIZE];
     
@@ -315,451 +585,2950 @@ Column* ODBC::GetColumns(SQLHSTMT hStmt, short* colCount) {
                            (SQLSMALLINT *) &buflen,
                            NULL);
     
-    //store the len attribute
-    columns[i].len = buflen;
+    //store the len attribute
+    columns[i].len = buflen;
+    
+    //get the column type and store it directly in column[i].type
+    ret = SQLColAttribute( hStmt,
+                           columns[i].index,
+                           SQL_DESC_TYPE,
+                           NULL,
+                           0,
+                           NULL,
+                           &columns[i].type);
+    
+    //only variable length columns need it, see GetColumnOctetLength
+    columns[i].octetLength = 0;
+    columns[i].hasOctetLength = false;
+  }
+  
+  return columns;
+}
+
+/*
+ * GetColumnOctetLength
+ *
+ * The maximum size of a column in bytes, asked of the driver the first time
+ * it is needed and remembered in the column after that.
+ */
+
+SQLLEN ODBC::GetColumnOctetLength(SQLHSTMT hStmt, Column* column) {
+  if (!column->hasOctetLength) {
+    column->octetLength = 0;
+    
+    SQLColAttribute( hStmt,
+                     column->index,
+                     SQL_DESC_OCTET_LENGTH,
+                     NULL,
+                     0,
+                     NULL,
+                     &column->octetLength);
+    
+    column->hasOctetLength = true;
+  }
+  
+  return column->octetLength;
+}
+
+/*
+ * FreeColumns
+ */
+
+void ODBC::FreeColumns(Column* columns, short* colCount) {
+  for(int i = 0; i < *colCount; i++) {
+      delete [] columns[i].name;
+  }
+
+  delete [] columns;
+  
+  *colCount = 0;
+}
+
+/*
+ * CreateColumnCache
+ *
+ * Take ownership of columns returned by GetColumns. The cache starts with a
+ * single reference held by the caller.
+ */
+
+ColumnCache* ODBC::CreateColumnCache(Column* columns, short colCount) {
+  DEBUG_PRINTF("ODBC::CreateColumnCache colCount=%i\n", colCount);
+  
+  ColumnCache* cache = (ColumnCache *) calloc(1, sizeof(ColumnCache));
+  
+  cache->columns = columns;
+  cache->colCount = colCount;
+  cache->refCount = 1;
+  cache->names = NULL;
+  
+  return cache;
+}
+
+/*
+ * ReleaseColumnCache
+ *
+ * Drop a reference to the cache, freeing it with the last one. Must be
+ * called on the event loop thread because of the V8 names.
+ */
+
+void ODBC::ReleaseColumnCache(ColumnCache* cache) {
+  if (--cache->refCount > 0) {
+    return;
+  }
+  
+  DEBUG_PRINTF("ODBC::ReleaseColumnCache - freeing\n");
+  
+  if (cache->names != NULL) {
+    for (int i = 0; i < cache->colCount; i++) {
+      NanDisposePersistent(cache->names[i]);
+    }
+    
+    delete [] cache->names;
+    
+    NanDisposePersistent(cache->rowTemplate);
+  }
+  
+  FreeColumns(cache->columns, &cache->colCount);
+  
+  free(cache);
+}
+
+/*
+ * GetColumnNames
+ *
+ * Return the column names of the cache as internalized V8 strings, creating
+ * them and the row template the first time. Must be called on the event
+ * loop thread.
+ */
+
+Persistent<String>* ODBC::GetColumnNames(ColumnCache* cache) {
+  if (cache->names == NULL) {
+    cache->names = new Persistent<String>[cache->colCount];
+    
+    Local<ObjectTemplate> rowTemplate = NanNew<ObjectTemplate>();
+    
+    for (int i = 0; i < cache->colCount; i++) {
+      Local<String> name;
+      
+#if (NODE_MODULE_VERSION < NODE_0_12_MODULE_VERSION)
+#ifdef UNICODE
+      name = NanNew((uint16_t *) cache->columns[i].name);
+#else
+      name = String::NewSymbol((const char *) cache->columns[i].name);
+#endif
+#else
+#ifdef UNICODE
+      name = String::NewFromTwoByte(
+        Isolate::GetCurrent(),
+        (uint16_t *) cache->columns[i].name,
+        String::kInternalizedString);
+#else
+      name = String::NewFromUtf8(
+        Isolate::GetCurrent(),
+        (const char *) cache->columns[i].name,
+        String::kInternalizedString);
+#endif
+#endif
+      
+      NanAssignPersistent(cache->names[i], name);
+      
+      rowTemplate->Set(name, NanNull());
+    }
+    
+    NanAssignPersistent(cache->rowTemplate, rowTemplate);
+  }
+  
+  return cache->names;
+}
+
+/*
+ * GetBufferLength
+ *
+ * Work out how big the SQLGetData buffer for a result set has to be so that
+ * every value can be read in one call. Long and LOB columns (no usable octet
+ * length) get the maximum size; they are read in chunks of that size anyway.
+ */
+
+int ODBC::GetBufferLength(SQLHSTMT hStmt, Column* columns, short* colCount) {
+  SQLLEN length = BUFFER_POOL_MIN_SIZE;
+  
+  for (int i = 0; i < *colCount; i++) {
+    SQLLEN needed, octetLength;
+    
+    switch ((int) columns[i].type) {
+      case SQL_INTEGER :
+      case SQL_SMALLINT :
+      case SQL_TINYINT :
+      case SQL_NUMERIC :
+      case SQL_DECIMAL :
+      case SQL_BIGINT :
+      case SQL_FLOAT :
+      case SQL_REAL :
+      case SQL_DOUBLE :
+      case SQL_DATETIME :
+      case SQL_TIMESTAMP :
+      case SQL_BIT :
+        //fixed size; always fits in the smallest buffer
+        continue;
+      default :
+        octetLength = GetColumnOctetLength(hStmt, &columns[i]);
+        
+        if (octetLength <= 0 || octetLength >= MAX_VALUE_SIZE) {
+          return MAX_VALUE_SIZE;
+        }
+        
+        //a narrow character can come back as one wide character
+        needed = (octetLength + 1) * sizeof(SQLTCHAR);
+        break;
+    }
+    
+    if (needed > length) {
+      length = needed;
+    }
+  }
+  
+  return (length > MAX_VALUE_SIZE) ? MAX_VALUE_SIZE : (int) length;
+}
+
+/*
+ * AcquireBuffer
+ *
+ * Get a buffer of at least minLength bytes from the process wide buffer
+ * pool. The size actually handed out is stored in bufferLength and must be
+ * passed back to ReleaseBuffer. Safe to call from the thread pool.
+ */
+
+uint16_t* ODBC::AcquireBuffer(int minLength, int* bufferLength) {
+  int sizeClass = 0;
+  int size = BUFFER_POOL_MIN_SIZE;
+  
+  while (size < minLength && sizeClass < BUFFER_POOL_CLASSES - 1) {
+    size <<= 1;
+    sizeClass++;
+  }
+  
+  uint16_t* buffer = NULL;
+  
+  uv_mutex_lock(&ODBC::g_bufferPoolMutex);
+  
+  if (g_bufferPool.freeCount[sizeClass] > 0) {
+    buffer = g_bufferPool.buffers[sizeClass][--g_bufferPool.freeCount[sizeClass]];
+    g_bufferPool.bytesPooled -= size;
+  }
+  else {
+    g_bufferPool.allocations++;
+  }
+  
+  g_bufferPool.bytesInUse += size;
+  g_bufferPool.buffersInUse++;
+  
+  uv_mutex_unlock(&ODBC::g_bufferPoolMutex);
+  
+  if (buffer == NULL) {
+    buffer = (uint16_t *) malloc(size);
+  }
+  
+  DEBUG_PRINTF("ODBC::AcquireBuffer minLength=%i size=%i\n", minLength, size);
+  
+  *bufferLength = size;
+  
+  return buffer;
+}
+
+/*
+ * ReleaseBuffer
+ */
+
+void ODBC::ReleaseBuffer(uint16_t* buffer, int bufferLength) {
+  DEBUG_PRINTF("ODBC::ReleaseBuffer bufferLength=%i\n", bufferLength);
+  
+  int sizeClass = 0;
+  int size = BUFFER_POOL_MIN_SIZE;
+  
+  while (size < bufferLength && sizeClass < BUFFER_POOL_CLASSES - 1) {
+    size <<= 1;
+    sizeClass++;
+  }
+  
+  uv_mutex_lock(&ODBC::g_bufferPoolMutex);
+  
+  g_bufferPool.bytesInUse -= bufferLength;
+  g_bufferPool.buffersInUse--;
+  
+  if (size == bufferLength && g_bufferPool.freeCount[sizeClass] < BUFFER_POOL_MAX_FREE) {
+    g_bufferPool.buffers[sizeClass][g_bufferPool.freeCount[sizeClass]++] = buffer;
+    g_bufferPool.bytesPooled += bufferLength;
+    
+    buffer = NULL;
+  }
+  
+  uv_mutex_unlock(&ODBC::g_bufferPoolMutex);
+  
+  //the pool is full for this size
+  free(buffer);
+}
+
+/*
+ * GetBufferStats
+ */
+
+NAN_METHOD(ODBC::GetBufferStats) {
+  DEBUG_PRINTF("ODBC::GetBufferStats\n");
+  NanScope();
+  
+  Local<Object> stats = NanNew<Object>();
+  
+  uv_mutex_lock(&ODBC::g_bufferPoolMutex);
+  
+  int buffersPooled = 0;
+  
+  for (int i = 0; i < BUFFER_POOL_CLASSES; i++) {
+    buffersPooled += g_bufferPool.freeCount[i];
+  }
+  
+  stats->Set(NanNew("bytesInUse"), NanNew<Number>(g_bufferPool.bytesInUse));
+  stats->Set(NanNew("buffersInUse"), NanNew<Number>(g_bufferPool.buffersInUse));
+  stats->Set(NanNew("bytesPooled"), NanNew<Number>(g_bufferPool.bytesPooled));
+  stats->Set(NanNew("buffersPooled"), NanNew<Number>(buffersPooled));
+  stats->Set(NanNew("allocations"), NanNew<Number>(g_bufferPool.allocations));
+  
+  uv_mutex_unlock(&ODBC::g_bufferPoolMutex);
+  
+  NanReturnValue(stats);
+}
+
+/*
+ * CreateStatementPool
+ *
+ * The pool starts with a single reference held by the connection.
+ */
+
+StatementPool* ODBC::CreateStatementPool(HDBC hDBC) {
+  StatementPool* pool = (StatementPool *) calloc(1, sizeof(StatementPool));
+  
+  uv_mutex_init(&pool->mutex);
+  
+  pool->hDBC = hDBC;
+  pool->refCount = 1;
+  
+  return pool;
+}
+
+/*
+ * RetainStatementPool
+ */
+
+void ODBC::RetainStatementPool(StatementPool* pool) {
+  uv_mutex_lock(&pool->mutex);
+  
+  pool->refCount++;
+  
+  uv_mutex_unlock(&pool->mutex);
+}
+
+/*
+ * ReleaseStatementPool
+ *
+ * Drop a reference to the pool, freeing it with the last one. The pool
+ * must have been closed by its connection by then.
+ */
+
+void ODBC::ReleaseStatementPool(StatementPool* pool) {
+  uv_mutex_lock(&pool->mutex);
+  
+  int refCount = --pool->refCount;
+  
+  uv_mutex_unlock(&pool->mutex);
+  
+  if (refCount > 0) {
+    return;
+  }
+  
+  DEBUG_PRINTF("ODBC::ReleaseStatementPool - freeing\n");
+  
+  uv_mutex_destroy(&pool->mutex);
+  
+  free(pool);
+}
+
+/*
+ * CloseStatementPool
+ *
+ * Free every pooled handle. Called by the connection before it
+ * disconnects; handles returned after this are freed instead of pooled.
+ */
+
+void ODBC::CloseStatementPool(StatementPool* pool) {
+  uv_mutex_lock(&pool->mutex);
+  
+  pool->closed = true;
+  
+  bool locked = ODBC::GlobalLock();
+  
+  for (int i = 0; i < pool->count; i++) {
+    SQLFreeHandle(SQL_HANDLE_STMT, pool->handles[i]);
+  }
+  
+  ODBC::GlobalUnlock(locked);
+  
+  pool->count = 0;
+  
+  uv_mutex_unlock(&pool->mutex);
+}
+
+/*
+ * AllocStatement
+ *
+ * Take a statement handle from the pool, or allocate a new one when the
+ * pool is empty. Safe to call from the worker threads.
+ */
+
+SQLRETURN ODBC::AllocStatement(StatementPool* pool, HSTMT* hSTMT) {
+  uv_mutex_lock(&pool->mutex);
+  
+  if (pool->count > 0) {
+    *hSTMT = pool->handles[--pool->count];
+    pool->hits++;
+    
+    uv_mutex_unlock(&pool->mutex);
+    
+    return SQL_SUCCESS;
+  }
+  
+  pool->misses++;
+  
+  uv_mutex_unlock(&pool->mutex);
+  
+  bool locked = ODBC::GlobalLock();
+  
+  //allocate a new statment handle
+  SQLRETURN ret = SQLAllocHandle(SQL_HANDLE_STMT, pool->hDBC, hSTMT);
+  
+  ODBC::GlobalUnlock(locked);
+  
+  return ret;
+}
+
+/*
+ * FreeStatement
+ *
+ * Close the cursor, unbind the columns and parameters and keep the handle
+ * for the next AllocStatement. The handle is freed for real if it can't be
+ * reset, the pool is full or the connection has been closed.
+ */
+
+void ODBC::FreeStatement(StatementPool* pool, HSTMT hSTMT) {
+  bool pooled = false;
+  
+  uv_mutex_lock(&pool->mutex);
+  
+  bool closed = pool->closed;
+  
+  uv_mutex_unlock(&pool->mutex);
+  
+  SQLRETURN ret = SQL_ERROR;
+  
+  if (!closed) {
+    ret = SQLFreeStmt(hSTMT, SQL_CLOSE);
+  }
+  
+  if (SQL_SUCCEEDED(ret)) {
+    ret = SQLFreeStmt(hSTMT, SQL_UNBIND);
+  }
+  
+  if (SQL_SUCCEEDED(ret)) {
+    ret = SQLFreeStmt(hSTMT, SQL_RESET_PARAMS);
+  }
+  
+  //undo a per query timeout; drivers without timeouts may refuse this
+  if (SQL_SUCCEEDED(ret)) {
+    SQLSetStmtAttr(hSTMT, SQL_ATTR_QUERY_TIMEOUT, (SQLPOINTER) 0, SQL_IS_UINTEGER);
+  }
+  
+  uv_mutex_lock(&pool->mutex);
+  
+  if (SQL_SUCCEEDED(ret) && !pool->closed && pool->count < STATEMENT_POOL_SIZE) {
+    pool->handles[pool->count++] = hSTMT;
+    pooled = true;
+  }
+  
+  uv_mutex_unlock(&pool->mutex);
+  
+  if (!pooled) {
+    bool locked = ODBC::GlobalLock();
+    
+    SQLFreeHandle(SQL_HANDLE_STMT, hSTMT);
+    
+    ODBC::GlobalUnlock(locked);
+  }
+}
+
+/*
+ * GetStatementPoolStats
+ */
+
+Local<Object> ODBC::GetStatementPoolStats(StatementPool* pool) {
+  NanEscapableScope();
+  
+  Local<Object> stats = NanNew<Object>();
+  
+  uv_mutex_lock(&pool->mutex);
+  
+  stats->Set(NanNew("hits"), NanNew<Number>(pool->hits));
+  stats->Set(NanNew("misses"), NanNew<Number>(pool->misses));
+  stats->Set(NanNew("pooled"), NanNew<Number>(pool->count));
+  
+  uv_mutex_unlock(&pool->mutex);
+  
+  return NanEscapeScope(stats);
+}
+
+/*
+ * GetColumnValue
+ */
+
+Handle<Value> ODBC::GetColumnValue( SQLHSTMT hStmt, Column column,
+                                        uint16_t* buffer, int bufferLength) {
+  ColumnData data;
+
+  SQLRETURN ret = GetColumnData(hStmt, column, &data, buffer, bufferLength);
+
+  if (!SQL_SUCCEEDED(ret)) {
+    //an error has occured
+    //possible values for ret are SQL_ERROR (-1) and SQL_INVALID_HANDLE (-2)
+
+    //If we have an invalid handle, then stuff is way bad and we should abort
+    //immediately. Memory errors are bound to follow as we must be in an
+    //inconsisant state.
+    assert(ret != SQL_INVALID_HANDLE);
+
+    //Not sure if throwing here will work out well for us but we can try
+    //since we should have a valid handle and the error is something we
+    //can look into
+    NanThrowError(ODBC::GetSQLError(
+       SQL_HANDLE_STMT,
+       hStmt,
+       (char *) "[node-odbc] Error in ODBC::GetColumnValue"
+     ));
+
+    return NanUndefined();
+  }
+
+  Handle<Value> value = GetColumnValue(column, &data);
+
+  FreeColumnData(&data, 1);
+
+  return value;
+}
+
+/*
+ * GetColumnData
+ *
+ * Calls SQLGetData for one column of the current row and stores the result in
+ * `data`. This does not touch V8 at all so it is safe to call from the thread
+ * pool. Any memory allocated here must be released with FreeColumnData.
+ */
+
+SQLRETURN ODBC::GetColumnData( SQLHSTMT hStmt, Column column, ColumnData* data,
+                               uint16_t* buffer, int bufferLength) {
+  SQLRETURN ret = SQL_SUCCESS;
+
+  data->len = 0;
+  data->data = NULL;
+
+  switch (GetColumnType(column)) {
+    case SQL_INTEGER :
+    case SQL_SMALLINT :
+    case SQL_TINYINT :
+      data->intValue = 0;
+
+      ret = SQLGetData(
+        hStmt,
+        column.index,
+        SQL_C_SLONG,
+        &data->intValue,
+        sizeof(data->intValue),
+        &data->len);
+
+      DEBUG_PRINTF("ODBC::GetColumnData - Integer: index=%i name=%s type=%i len=%i ret=%i val=%li\n",
+                  column.index, column.name, column.type, data->len, ret, data->intValue);
+
+      //errors for fixed size values have always been reported as the value
+      //we happened to get back, so keep doing that
+      return SQL_SUCCESS;
+    case SQL_EXACT_BIGINT :
+      data->bigintValue = 0;
+
+      ret = SQLGetData(
+        hStmt,
+        column.index,
+        SQL_C_SBIGINT,
+        &data->bigintValue,
+        sizeof(data->bigintValue),
+        &data->len);
+
+      DEBUG_PRINTF("ODBC::GetColumnData - BigInt: index=%i name=%s type=%i len=%i ret=%i val=%lld\n",
+                  column.index, column.name, column.type, data->len, ret, (long long) data->bigintValue);
+
+      return SQL_SUCCESS;
+    case SQL_NUMERIC :
+    case SQL_DECIMAL :
+    case SQL_BIGINT :
+    case SQL_FLOAT :
+    case SQL_REAL :
+    case SQL_DOUBLE :
+      data->doubleValue = 0;
+
+      ret = SQLGetData(
+        hStmt,
+        column.index,
+        SQL_C_DOUBLE,
+        &data->doubleValue,
+        sizeof(data->doubleValue),
+        &data->len);
+
+      DEBUG_PRINTF("ODBC::GetColumnData - Number: index=%i name=%s type=%i len=%i ret=%i val=%f\n",
+                  column.index, column.name, column.type, data->len, ret, data->doubleValue);
+
+      return SQL_SUCCESS;
+    case SQL_DATETIME :
+    case SQL_TIMESTAMP :
+#ifdef _WIN32
+      ret = SQLGetData(
+        hStmt,
+        column.index,
+        SQL_C_CHAR,
+        (char *) buffer,
+        bufferLength,
+        &data->len);
+
+      DEBUG_PRINTF("ODBC::GetColumnData - W32 Timestamp: index=%i name=%s type=%i len=%i\n",
+                    column.index, column.name, column.type, data->len);
+
+      if (SQL_SUCCEEDED(ret) && data->len != SQL_NULL_DATA) {
+        size_t length = strlen((char *) buffer);
+
+        data->data = (unsigned char *) malloc(length + 1);
+        memcpy(data->data, buffer, length + 1);
+        data->len = length;
+      }
+      else {
+        data->len = SQL_NULL_DATA;
+      }
+#else
+      memset(&data->timestampValue, 0, sizeof(SQL_TIMESTAMP_STRUCT));
+
+      ret = SQLGetData(
+        hStmt,
+        column.index,
+        SQL_C_TYPE_TIMESTAMP,
+        &data->timestampValue,
+        sizeof(SQL_TIMESTAMP_STRUCT),
+        &data->len);
+
+      DEBUG_PRINTF("ODBC::GetColumnData - Unix Timestamp: index=%i name=%s type=%i len=%i\n",
+                    column.index, column.name, column.type, data->len);
+#endif
+      return SQL_SUCCESS;
+    case SQL_BIT :
+      //again, i'm not sure if this is cross database safe, but it works for
+      //MSSQL
+      ((char *) buffer)[0] = '\0';
+
+      ret = SQLGetData(
+        hStmt,
+        column.index,
+        SQL_C_CHAR,
+        (char *) buffer,
+        bufferLength,
+        &data->len);
+
+      DEBUG_PRINTF("ODBC::GetColumnData - Bit: index=%i name=%s type=%i len=%i\n",
+                    column.index, column.name, column.type, data->len);
+
+      data->bitValue = (((char *) buffer)[0] == '0') ? false : true;
+
+      return SQL_SUCCESS;
+    default : {
+      //binary values are read as raw bytes, which SQLGetData does not null
+      //terminate, everything else as text
+      bool binary = IsBinaryColumn(column);
+      SQLSMALLINT cType = binary ? SQL_C_BINARY : SQL_C_TCHAR;
+      SQLLEN terminator = binary ? 0 : sizeof(SQLTCHAR);
+
+      SQLLEN allocated = 0;
+      SQLLEN len = 0;
+
+      //long values are returned in multiple chunks. Accumulate all of them
+      //into one native buffer so only a single string or Buffer has to be
+      //created on the event loop thread. As soon as the driver reports the
+      //total length that buffer is allocated at its final size and the rest
+      //of the value is read straight into it.
+      do {
+        bool direct = (data->data != NULL && allocated - data->len > bufferLength);
+        unsigned char* target = direct ? data->data + data->len : (unsigned char *) buffer;
+        SQLLEN targetLength = direct ? allocated - data->len : bufferLength;
+
+        ret = SQLGetData(
+          hStmt,
+          column.index,
+          cType,
+          target,
+          targetLength,
+          &len);
+
+        DEBUG_PRINTF("ODBC::GetColumnData - %s: index=%i name=%s type=%i len=%i ret=%i targetLength=%i\n",
+                      binary ? "Binary" : "String", column.index, column.name, column.type, len, ret, targetLength);
+
+        if (ret == SQL_NO_DATA) {
+          //we have captured all of the data
+          //double check that we have some data else return null
+          if (data->data == NULL) {
+            data->len = SQL_NULL_DATA;
+          }
+
+          return SQL_SUCCESS;
+        }
+
+        if (!SQL_SUCCEEDED(ret)) {
+          FreeColumnData(data, 1);
+
+          return ret;
+        }
+
+        if (len == SQL_NULL_DATA) {
+          data->len = SQL_NULL_DATA;
+
+          return ret;
+        }
+
+        //the number of data bytes SQLGetData can place in target while still
+        //leaving room for the null terminator it appends to text
+        SQLLEN chunkMax = ((targetLength - terminator) / sizeof(SQLTCHAR))
+                          * sizeof(SQLTCHAR);
+        SQLLEN chunkLen = (len == SQL_NO_TOTAL || len > chunkMax) ? chunkMax : len;
+
+        if (!direct) {
+          //len is what was left of the value before this call, when known
+          SQLLEN needed = data->len
+                        + ((len == SQL_NO_TOTAL) ? chunkLen : len)
+                        + (SQLLEN) sizeof(SQLTCHAR);
+
+          if (needed > allocated) {
+            allocated = needed;
+
+            if (len == SQL_NO_TOTAL && allocated < data->len * 2) {
+              allocated = data->len * 2;
+            }
+
+            data->data = (unsigned char *) realloc(data->data, allocated);
+          }
+
+          memcpy(data->data + data->len, buffer, chunkLen);
+        }
+
+        data->len += chunkLen;
+
+        //only go back for more if the driver told us that it truncated the
+        //value. Some ODBC drivers do not correctly report SQL_NO_DATA on the
+        //following call which would otherwise cause an infinite loop here.
+        if (ret != SQL_SUCCESS_WITH_INFO || len == 0
+            || (len != SQL_NO_TOTAL && len <= chunkMax)) {
+          break;
+        }
+      } while (true);
+
+      memset(data->data + data->len, 0, sizeof(SQLTCHAR));
+
+      return SQL_SUCCESS;
+    }
+  }
+}
+
+/*
+ * FreeColumnData
+ */
+
+void ODBC::FreeColumnData(ColumnData* data, int count) {
+  for (int i = 0; i < count; i++) {
+    if (data[i].data != NULL) {
+      free(data[i].data);
+      data[i].data = NULL;
+    }
+  }
+}
+
+/*
+ * IsBinaryColumn
+ */
+
+bool ODBC::IsBinaryColumn(Column column) {
+  switch ((int) column.type) {
+    case SQL_BINARY :
+    case SQL_VARBINARY :
+    case SQL_LONGVARBINARY :
+      return true;
+    default :
+      return false;
+  }
+}
+
+/*
+ * GetColumnType
+ *
+ * The type that decides how a column is read and converted: the SQL type of
+ * the column, or SQL_EXACT_BIGINT/SQL_EXACT_DECIMAL for BIGINT and
+ * NUMERIC/DECIMAL columns of a result fetched with exactNumbers.
+ */
+
+int ODBC::GetColumnType(Column column) {
+  if (column.exactNumbers) {
+    switch ((int) column.type) {
+      case SQL_BIGINT :
+        return SQL_EXACT_BIGINT;
+      case SQL_NUMERIC :
+      case SQL_DECIMAL :
+        return SQL_EXACT_DECIMAL;
+    }
+  }
+
+  return (int) column.type;
+}
+
+/*
+ * FormatBigInt
+ *
+ * Write the decimal digits of value to buffer, which must have room for 21
+ * characters.
+ */
+
+static void FormatBigInt(int64_t value, char* buffer) {
+  sprintf(buffer, "%lld", (long long) value);
+}
+
+/*
+ * FreeColumnValue
+ *
+ * Free callback for Buffers created over memory allocated by GetColumnData.
+ */
+
+void ODBC::FreeColumnValue(char* data, void* hint) {
+  free(data);
+}
+
+//owns the memory GetColumnData read a long value into and exposes it to V8
+//as the contents of an external string. The memory is reported to V8 so that
+//large results put pressure on the garbage collector like heap strings do.
+#ifdef UNICODE
+class ColumnStringResource : public String::ExternalStringResource {
+  public:
+    ColumnStringResource(unsigned char* data, size_t length) :
+      m_data((uint16_t *) data), m_length(length / sizeof(uint16_t)) {
+      NanAdjustExternalMemory((int) (m_length * sizeof(uint16_t)));
+    }
+    ~ColumnStringResource() {
+      free(m_data);
+      NanAdjustExternalMemory(-(int) (m_length * sizeof(uint16_t)));
+    }
+    const uint16_t* data() const { return m_data; }
+    size_t length() const { return m_length; }
+  private:
+    uint16_t* m_data;
+    size_t m_length;
+};
+#else
+class ColumnStringResource : public NanExternalOneByteStringResource {
+  public:
+    ColumnStringResource(unsigned char* data, size_t length) :
+      m_data((char *) data), m_length(length) {
+      NanAdjustExternalMemory((int) m_length);
+    }
+    ~ColumnStringResource() {
+      free(m_data);
+      NanAdjustExternalMemory(-(int) m_length);
+    }
+    const char* data() const { return m_data; }
+    size_t length() const { return m_length; }
+  private:
+    char* m_data;
+    size_t m_length;
+};
+#endif
+
+/*
+ * NewExternalString
+ *
+ * Create a string that uses the memory of `data` directly instead of copying
+ * it onto the V8 heap, taking ownership of that memory. Without UNICODE this
+ * is only possible for pure ASCII values, since V8 reads one byte external
+ * strings as Latin-1 rather than UTF-8; an empty handle is returned otherwise
+ * and `data` is left untouched.
+ */
+
+static Local<String> NewExternalString(ColumnData* data) {
+#ifndef UNICODE
+  for (SQLLEN i = 0; i < data->len; i++) {
+    if (data->data[i] & 0x80) {
+      return Local<String>();
+    }
+  }
+#endif
+  //GetColumnData may have grown the buffer well past the length of the
+  //value, don't keep that slack alive for the life of the string
+  unsigned char* bytes = (unsigned char *) realloc(data->data, data->len + sizeof(SQLTCHAR));
+
+  if (bytes == NULL) {
+    bytes = data->data;
+  }
+
+  data->data = NULL;
+
+#ifdef UNICODE
+  String::ExternalStringResource* resource = new ColumnStringResource(bytes, data->len);
+#else
+  NanExternalOneByteStringResource* resource = new ColumnStringResource(bytes, data->len);
+#endif
+
+  return NanNew(resource);
+}
+
+/*
+ * DaysFromCivil
+ *
+ * Number of days between 1970-01-01 and the given proleptic Gregorian date.
+ * Pure integer arithmetic so that converting a timestamp never has to call
+ * into timegm or the TZ database.
+ */
+
+static double DaysFromCivil(int year, int month, int day) {
+  year -= month <= 2;
+
+  int era = (year >= 0 ? year : year - 399) / 400;
+  int yearOfEra = year - era * 400;
+  int dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+  int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+
+  return double(era) * 146097 + dayOfEra - 719468;
+}
+
+/*
+ * CivilFromDays
+ *
+ * The inverse of DaysFromCivil.
+ */
+
+static void CivilFromDays(double days, int* year, int* month, int* day) {
+  days += 719468;
+
+  int era = (int) floor(days / 146097);
+  int dayOfEra = (int) (days - double(era) * 146097);
+  int yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+  int dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+  int mp = (5 * dayOfYear + 2) / 153;
+
+  *day = dayOfYear - (153 * mp + 2) / 5 + 1;
+  *month = mp < 10 ? mp + 3 : mp - 9;
+  *year = yearOfEra + era * 400 + (*month <= 2);
+}
+
+#ifndef TIMEGM
+//local time offsets are looked up once per wall clock hour and remembered
+//here, keyed by the number of hours since the epoch in local time. Only used
+//from the event loop thread so there is no locking.
+#define LOCAL_OFFSET_CACHE_SIZE 512
+
+typedef struct {
+  double hour;
+  double offset;
+  bool valid;
+} LocalOffset;
+
+static LocalOffset g_localOffsets[LOCAL_OFFSET_CACHE_SIZE];
+
+/*
+ * LocalTimeToEpoch
+ *
+ * Seconds since the epoch of a local wall clock time. localSeconds is that
+ * wall clock time expressed as if it were UTC.
+ */
+
+static double LocalTimeToEpoch(double localSeconds) {
+  double days = floor(localSeconds / 86400);
+  double secondsOfDay = localSeconds - days * 86400;
+  int year, month, day;
+
+  CivilFromDays(days, &year, &month, &day);
+
+  struct tm timeInfo = {};
+
+  timeInfo.tm_year = year - 1900;
+  timeInfo.tm_mon = month - 1;
+  timeInfo.tm_mday = day;
+  timeInfo.tm_hour = (int) (secondsOfDay / 3600);
+  timeInfo.tm_min = (int) (secondsOfDay / 60) % 60;
+  timeInfo.tm_sec = (int) secondsOfDay % 60;
+
+  //a negative value means that mktime() should use timezone information
+  //and system databases to attempt to determine whether DST is in effect
+  //at the specified time.
+  timeInfo.tm_isdst = -1;
+
+  return double(mktime(&timeInfo));
+}
+
+/*
+ * GetLocalOffset
+ *
+ * The difference in seconds between local wall clock time and UTC at the
+ * given local time.
+ */
+
+static double GetLocalOffset(double localSeconds) {
+  double hour = floor(localSeconds / 3600);
+  LocalOffset* entry = &g_localOffsets[((long long) hour) & (LOCAL_OFFSET_CACHE_SIZE - 1)];
+
+  if (entry->valid && entry->hour == hour) {
+    return entry->offset;
+  }
+
+  double start = hour * 3600;
+  double offset = start - LocalTimeToEpoch(start);
+
+  //an hour that ends in or contains a DST transition does not have a single
+  //offset, so it is never cached and every value in it goes through mktime()
+  if (offset != (start + 3599) - LocalTimeToEpoch(start + 3599)
+      || offset != (start + 3600) - LocalTimeToEpoch(start + 3600)) {
+    return localSeconds - LocalTimeToEpoch(localSeconds);
+  }
+
+  entry->hour = hour;
+  entry->offset = offset;
+  entry->valid = true;
+
+  return offset;
+}
+#endif
+
+/*
+ * GetTimestampEpoch
+ *
+ * Milliseconds since the epoch of an ODBC timestamp. The timestamp is taken
+ * as UTC when built with TIMEGM and as local time otherwise.
+ */
+
+double ODBC::GetTimestampEpoch(SQL_TIMESTAMP_STRUCT* timestamp) {
+  double seconds = DaysFromCivil(timestamp->year, timestamp->month, timestamp->day) * 86400
+                 + timestamp->hour * 3600
+                 + timestamp->minute * 60
+                 + timestamp->second;
+
+#ifndef TIMEGM
+  seconds -= GetLocalOffset(seconds);
+#endif
+
+  return (seconds * 1000) + (timestamp->fraction / 1000000);
+}
+
+/*
+ * FormatTimestampEpoch
+ *
+ * Write milliseconds since the epoch as an ISO 8601 UTC string, the same
+ * format as Date.prototype.toISOString. buffer must hold 32 bytes.
+ */
+
+void ODBC::FormatTimestampEpoch(double epoch, char* buffer) {
+  double days = floor(epoch / 86400000);
+  double milliseconds = epoch - days * 86400000;
+  int year, month, day;
+
+  CivilFromDays(days, &year, &month, &day);
+
+  int ms = (int) milliseconds;
+
+  sprintf(buffer, (year >= 0 && year <= 9999)
+                         ? "%04d-%02d-%02dT%02d:%02d:%02d.%03dZ"
+                         : "%+07d-%02d-%02dT%02d:%02d:%02d.%03dZ",
+           year, month, day,
+           ms / 3600000, (ms / 60000) % 60, (ms / 1000) % 60, ms % 1000);
+}
+
+/*
+ * GetTimestampFromEpoch
+ *
+ * The inverse of GetTimestampEpoch: split milliseconds since the epoch into
+ * a timestamp, in UTC when built with TIMEGM and in local time otherwise.
+ * Returns false, leaving timestamp untouched, if the C library can't convert
+ * the time to local time.
+ */
+
+bool ODBC::GetTimestampFromEpoch(double epoch, SQL_TIMESTAMP_STRUCT* timestamp) {
+  double seconds = floor(epoch / 1000);
+  int milliseconds = (int) (epoch - seconds * 1000);
+
+#ifndef TIMEGM
+  time_t time = (time_t) seconds;
+  struct tm timeInfo;
+
+#ifdef _WIN32
+  if (localtime_s(&timeInfo, &time) != 0) {
+    return false;
+  }
+#else
+  if (localtime_r(&time, &timeInfo) == NULL) {
+    return false;
+  }
+#endif
+
+  timestamp->year = timeInfo.tm_year + 1900;
+  timestamp->month = timeInfo.tm_mon + 1;
+  timestamp->day = timeInfo.tm_mday;
+  timestamp->hour = timeInfo.tm_hour;
+  timestamp->minute = timeInfo.tm_min;
+  timestamp->second = timeInfo.tm_sec;
+#else
+  double days = floor(seconds / 86400);
+  int secondsOfDay = (int) (seconds - days * 86400);
+  int year, month, day;
+
+  CivilFromDays(days, &year, &month, &day);
+
+  timestamp->year = year;
+  timestamp->month = month;
+  timestamp->day = day;
+  timestamp->hour = secondsOfDay / 3600;
+  timestamp->minute = (secondsOfDay / 60) % 60;
+  timestamp->second = secondsOfDay % 60;
+#endif
+
+  timestamp->fraction = milliseconds * 1000000;
+
+  return true;
+}
+
+/*
+ * GetColumnValue
+ *
+ * Create the V8 value for a column value previously retrieved with
+ * GetColumnData. Must be called from the event loop thread.
+ */
+
+Handle<Value> ODBC::GetColumnValue(Column column, ColumnData* data) {
+  NanEscapableScope();
+
+  if (data->len == SQL_NULL_DATA) {
+    return NanEscapeScope(NanNull());
+  }
+
+  switch (GetColumnType(column)) {
+    case SQL_INTEGER :
+    case SQL_SMALLINT :
+    case SQL_TINYINT :
+      return NanEscapeScope(NanNew<Integer>(data->intValue));
+    case SQL_EXACT_BIGINT : {
+#ifdef NODE_ODBC_BIGINT
+      return NanEscapeScope(BigInt::New(Isolate::GetCurrent(), data->bigintValue));
+#else
+      //no BigInt in this version of V8; a string keeps every digit
+      char digits[24];
+
+      FormatBigInt(data->bigintValue, digits);
+
+      return NanEscapeScope(NanNew(digits));
+#endif
+    }
+    case SQL_NUMERIC :
+    case SQL_DECIMAL :
+    case SQL_BIGINT :
+    case SQL_FLOAT :
+    case SQL_REAL :
+    case SQL_DOUBLE :
+      return NanEscapeScope(NanNew<Number>(data->doubleValue));
+    case SQL_DATETIME :
+    case SQL_TIMESTAMP : {
+#ifdef _WIN32
+      //I am not sure if this is locale-safe or cross database safe, but it
+      //works for me on MSSQL
+      struct tm timeInfo = {};
+      SQL_TIMESTAMP_STRUCT odbcTime = {};
+
+      if (!strptime((char *) data->data, "%Y-%m-%d %H:%M:%S", &timeInfo)) {
+        return NanEscapeScope(NanNew((char *) data->data));
+      }
+
+      odbcTime.year = timeInfo.tm_year + 1900;
+      odbcTime.month = timeInfo.tm_mon + 1;
+      odbcTime.day = timeInfo.tm_mday;
+      odbcTime.hour = timeInfo.tm_hour;
+      odbcTime.minute = timeInfo.tm_min;
+      odbcTime.second = timeInfo.tm_sec;
+#else
+      SQL_TIMESTAMP_STRUCT& odbcTime = data->timestampValue;
+#endif
+      double epoch = GetTimestampEpoch(&odbcTime);
+
+      if (column.dateMode == DATE_NUMBER) {
+        return NanEscapeScope(NanNew<Number>(epoch));
+      }
+      else if (column.dateMode == DATE_STRING) {
+        char iso[32];
+
+        FormatTimestampEpoch(epoch, iso);
+
+        return NanEscapeScope(NanNew(iso));
+      }
+
+      return NanEscapeScope(NanNew<Date>(epoch));
+    }
+    case SQL_BIT :
+      return NanEscapeScope(NanNew(data->bitValue));
+    case SQL_BINARY :
+    case SQL_VARBINARY :
+    case SQL_LONGVARBINARY : {
+      if (data->data == NULL) {
+        return NanEscapeScope(NanNewBufferHandle((uint32_t) 0));
+      }
+
+      //the Buffer takes ownership of the bytes read by GetColumnData instead
+      //of copying them
+      char* bytes = (char *) data->data;
+      data->data = NULL;
+
+      return NanEscapeScope(NanNewBufferHandle(bytes, (uint32_t) data->len, FreeColumnValue, NULL));
+    }
+    default :
+      if (data->len >= EXTERNAL_STRING_MIN_BYTES) {
+        Local<String> value = NewExternalString(data);
+
+        if (!value.IsEmpty()) {
+          return NanEscapeScope(value);
+        }
+      }
+#ifdef UNICODE
+      return NanEscapeScope(NanNew<String>(
+        (uint16_t *) data->data,
+        (int) (data->len / sizeof(uint16_t))));
+#else
+      return NanEscapeScope(NanNew<String>(
+        (char *) data->data,
+        (int) data->len));
+#endif
+  }
+}
+
+/*
+ * GetRecordData
+ *
+ * Retrieve every column of the current row into `row`, which must have room
+ * for `colCount` entries. Safe to call from the thread pool.
+ */
+
+SQLRETURN ODBC::GetRecordData ( SQLHSTMT hStmt, Column* columns,
+                                short* colCount, ColumnData* row,
+                                uint16_t* buffer, int bufferLength) {
+  SQLRETURN ret = SQL_SUCCESS;
+
+  for (int i = 0; i < *colCount; i++) {
+    ret = GetColumnData(hStmt, columns[i], &row[i], buffer, bufferLength);
+
+    if (!SQL_SUCCEEDED(ret)) {
+      //make sure the remaining columns are safe to free
+      for (int j = i; j < *colCount; j++) {
+        row[j].len = SQL_NULL_DATA;
+        row[j].data = NULL;
+      }
+
+      break;
+    }
+  }
+
+  return ret;
+}
+
+/*
+ * BindColumns
+ *
+ * Set the statement up for block cursor fetches: every column that has a
+ * bounded size gets a column-wise array of rowArraySize values bound with
+ * SQLBindCol so that a single SQLFetch returns up to rowArraySize rows.
+ * Unbounded (LOB) columns are left unbound and read with SQLGetData after
+ * positioning the cursor, which requires SQL_GD_BLOCK support from the
+ * driver. With that support a bound column is also unbound later on if one
+ * of its values turns out not to fit. Returns NULL if a block cursor can not
+ * be used, in which case the statement is left untouched.
+ */
+
+BoundColumn* ODBC::BindColumns ( HDBC hDBC, SQLHSTMT hStmt, Column* columns,
+                                 short* colCount, SQLULEN rowArraySize,
+                                 SQLULEN* rowsFetched, SQLUSMALLINT* rowStatus) {
+  DEBUG_PRINTF("ODBC::BindColumns rowArraySize=%i\n", rowArraySize);
+
+  SQLRETURN ret;
+  bool hasUnbound = false;
+
+  BoundColumn* boundColumns = (BoundColumn *) calloc(*colCount, sizeof(BoundColumn));
+
+  for (int i = 0; i < *colCount; i++) {
+    switch (GetColumnType(columns[i])) {
+      case SQL_INTEGER :
+      case SQL_SMALLINT :
+      case SQL_TINYINT :
+        boundColumns[i].cType = SQL_C_SLONG;
+        boundColumns[i].bufferLength = sizeof(int32_t);
+        break;
+      case SQL_EXACT_BIGINT :
+        boundColumns[i].cType = SQL_C_SBIGINT;
+        boundColumns[i].bufferLength = sizeof(int64_t);
+        break;
+      case SQL_EXACT_DECIMAL :
+        //sign, 38 digits, decimal point and terminator with room to spare
+        boundColumns[i].cType = SQL_C_TCHAR;
+        boundColumns[i].bufferLength = 64 * sizeof(SQLTCHAR);
+        break;
+      case SQL_NUMERIC :
+      case SQL_DECIMAL :
+      case SQL_BIGINT :
+      case SQL_FLOAT :
+      case SQL_REAL :
+      case SQL_DOUBLE :
+        boundColumns[i].cType = SQL_C_DOUBLE;
+        boundColumns[i].bufferLength = sizeof(double);
+        break;
+      case SQL_DATETIME :
+      case SQL_TIMESTAMP :
+#ifdef _WIN32
+        boundColumns[i].cType = SQL_C_CHAR;
+        boundColumns[i].bufferLength = 64;
+#else
+        boundColumns[i].cType = SQL_C_TYPE_TIMESTAMP;
+        boundColumns[i].bufferLength = sizeof(SQL_TIMESTAMP_STRUCT);
+#endif
+        break;
+      case SQL_BIT :
+        boundColumns[i].cType = SQL_C_CHAR;
+        boundColumns[i].bufferLength = 8;
+        break;
+      case SQL_CHAR :
+      case SQL_VARCHAR :
+      case SQL_WCHAR :
+      case SQL_WVARCHAR : {
+        SQLLEN length = 0;
+
+        SQLColAttribute( hStmt,
+                         columns[i].index,
+                         SQL_DESC_LENGTH,
+                         NULL,
+                         0,
+                         NULL,
+                         &length);
+
+        if (length > 0 && length <= MAX_BOUND_COLUMN_CHARS) {
+          boundColumns[i].cType = SQL_C_TCHAR;
+#ifdef UNICODE
+          boundColumns[i].bufferLength = (length + 1) * sizeof(SQLTCHAR);
+#else
+          //leave room for multi-byte characters
+          boundColumns[i].bufferLength = (length * 4) + 1;
+#endif
+          break;
+        }
+
+        hasUnbound = true;
+      } break;
+      case SQL_BINARY :
+      case SQL_VARBINARY : {
+        SQLLEN length = GetColumnOctetLength(hStmt, &columns[i]);
+
+        if (length > 0 && length <= MAX_BOUND_COLUMN_CHARS) {
+          boundColumns[i].cType = SQL_C_BINARY;
+          boundColumns[i].bufferLength = length;
+          break;
+        }
+
+        hasUnbound = true;
+      } break;
+      default :
+        hasUnbound = true;
+        break;
+    }
+  }
+
+  //reading unbound columns from a block cursor requires the driver to
+  //support SQLGetData on any column of any row in the rowset
+  SQLUINTEGER extensions = 0;
+
+  ret = SQLGetInfo(
+    hDBC,
+    SQL_GETDATA_EXTENSIONS,
+    &extensions,
+    sizeof(extensions),
+    NULL);
+
+  bool canGetData = SQL_SUCCEEDED(ret)
+                    && (extensions & SQL_GD_BLOCK)
+                    && (extensions & SQL_GD_ANY_COLUMN);
+
+  if (hasUnbound && !canGetData) {
+    DEBUG_PRINTF("ODBC::BindColumns - driver does not support SQL_GD_BLOCK\n");
+
+    free(boundColumns);
+
+    return NULL;
+  }
+
+  SQLSetStmtAttr(hStmt, SQL_ATTR_ROW_BIND_TYPE, (SQLPOINTER) SQL_BIND_BY_COLUMN, 0);
+
+  ret = SQLSetStmtAttr(hStmt, SQL_ATTR_ROW_ARRAY_SIZE, (SQLPOINTER) rowArraySize, 0);
+
+  if (ret != SQL_SUCCESS) {
+    //SQL_SUCCESS_WITH_INFO means the driver substituted a different
+    //array size which we would not know about
+    free(boundColumns);
+
+    SQLSetStmtAttr(hStmt, SQL_ATTR_ROW_ARRAY_SIZE, (SQLPOINTER) 1, 0);
+
+    return NULL;
+  }
+
+  SQLSetStmtAttr(hStmt, SQL_ATTR_ROWS_FETCHED_PTR, rowsFetched, 0);
+  SQLSetStmtAttr(hStmt, SQL_ATTR_ROW_STATUS_PTR, rowStatus, 0);
+
+  for (int i = 0; i < *colCount; i++) {
+    if (boundColumns[i].bufferLength == 0) {
+      continue;
+    }
+
+    boundColumns[i].buffer = (unsigned char *) malloc(rowArraySize * boundColumns[i].bufferLength);
+    boundColumns[i].indicators = (SQLLEN *) malloc(rowArraySize * sizeof(SQLLEN));
+    boundColumns[i].canUnbind = canGetData;
+
+    ret = SQLBindCol(
+      hStmt,
+      columns[i].index,
+      boundColumns[i].cType,
+      boundColumns[i].buffer,
+      boundColumns[i].bufferLength,
+      boundColumns[i].indicators);
+
+    if (!SQL_SUCCEEDED(ret)) {
+      UnbindColumns(hStmt, boundColumns, colCount);
+
+      return NULL;
+    }
+  }
+
+  return boundColumns;
+}
+
+/*
+ * UnbindColumns
+ *
+ * Undo BindColumns and return the statement to single row fetches.
+ */
+
+void ODBC::UnbindColumns (SQLHSTMT hStmt, BoundColumn* boundColumns, short* colCount) {
+  DEBUG_PRINTF("ODBC::UnbindColumns\n");
+
+  SQLFreeStmt(hStmt, SQL_UNBIND);
+
+  SQLSetStmtAttr(hStmt, SQL_ATTR_ROW_ARRAY_SIZE, (SQLPOINTER) 1, 0);
+  SQLSetStmtAttr(hStmt, SQL_ATTR_ROWS_FETCHED_PTR, NULL, 0);
+  SQLSetStmtAttr(hStmt, SQL_ATTR_ROW_STATUS_PTR, NULL, 0);
+
+  for (int i = 0; i < *colCount; i++) {
+    free(boundColumns[i].buffer);
+    free(boundColumns[i].indicators);
+  }
+
+  free(boundColumns);
+}
+
+/*
+ * GetBoundRecordData
+ *
+ * Copy row `rowIndex` of the current rowset out of the bound column arrays
+ * into `row`. Unbound columns are read with SQLGetData after positioning the
+ * cursor on that row. Safe to call from the thread pool.
+ */
+
+SQLRETURN ODBC::GetBoundRecordData ( SQLHSTMT hStmt, Column* columns,
+                                     short* colCount, BoundColumn* boundColumns,
+                                     SQLULEN rowIndex, ColumnData* row,
+                                     uint16_t* buffer, int bufferLength) {
+  SQLRETURN ret = SQL_SUCCESS;
+  bool positioned = false;
+
+  for (int i = 0; i < *colCount; i++) {
+    BoundColumn* bound = &boundColumns[i];
+
+    row[i].data = NULL;
+
+    if (bound->bufferLength == 0) {
+      if (!positioned) {
+        ret = SQLSetPos(hStmt, rowIndex + 1, SQL_POSITION, SQL_LOCK_NO_CHANGE);
+
+        positioned = true;
+      }
+
+      if (SQL_SUCCEEDED(ret)) {
+        ret = GetColumnData(hStmt, columns[i], &row[i], buffer, bufferLength);
+      }
+
+      if (!SQL_SUCCEEDED(ret)) {
+        //make sure the remaining columns are safe to free
+        for (int j = i; j < *colCount; j++) {
+          row[j].len = SQL_NULL_DATA;
+          row[j].data = NULL;
+        }
+
+        return ret;
+      }
+
+      continue;
+    }
+
+    unsigned char* value = bound->buffer + (rowIndex * bound->bufferLength);
+
+    row[i].len = bound->indicators[rowIndex];
+
+    if (row[i].len == SQL_NULL_DATA) {
+      continue;
+    }
+
+    switch (bound->cType) {
+      case SQL_C_SLONG :
+        memcpy(&row[i].intValue, value, sizeof(int32_t));
+        break;
+      case SQL_C_SBIGINT :
+        memcpy(&row[i].bigintValue, value, sizeof(int64_t));
+        break;
+      case SQL_C_DOUBLE :
+        memcpy(&row[i].doubleValue, value, sizeof(double));
+        break;
+#ifndef _WIN32
+      case SQL_C_TYPE_TIMESTAMP :
+        memcpy(&row[i].timestampValue, value, sizeof(SQL_TIMESTAMP_STRUCT));
+        break;
+#endif
+      default : {
+        if (columns[i].type == SQL_BIT) {
+          row[i].bitValue = (value[0] == '0') ? false : true;
+          break;
+        }
+
+        SQLLEN terminator = (bound->cType == SQL_C_BINARY) ? 0
+                          : (bound->cType == SQL_C_CHAR) ? 1 : sizeof(SQLTCHAR);
+
+        if (row[i].len == SQL_NO_TOTAL || row[i].len > bound->bufferLength - terminator) {
+          //the value did not fit in the bound buffer. Unbind the column for
+          //the rest of the result and read it again with SQLGetData, like a
+          //LOB column; the values of later rows in this rowset are read
+          //that way too.
+          if (bound->canUnbind
+              && SQL_SUCCEEDED(SQLBindCol(hStmt, columns[i].index, bound->cType, NULL, 0, NULL))) {
+            DEBUG_PRINTF("ODBC::GetBoundRecordData - unbinding truncated column %i\n", i);
+
+            free(bound->buffer);
+            free(bound->indicators);
+
+            bound->buffer = NULL;
+            bound->indicators = NULL;
+            bound->bufferLength = 0;
+
+            i--;
+            continue;
+          }
+
+          //SQLFetch will have returned SQL_SUCCESS_WITH_INFO with a 01004
+          //(right truncated) diagnostic; report that rather than handing
+          //back partial data.
+          for (int j = i; j < *colCount; j++) {
+            row[j].len = SQL_NULL_DATA;
+            row[j].data = NULL;
+          }
+
+          return SQL_ERROR;
+        }
+
+        //always allocate at least one byte so empty values are not null
+        row[i].data = (unsigned char *) malloc(row[i].len + terminator + 1);
+        memcpy(row[i].data, value, row[i].len);
+        memset(row[i].data + row[i].len, 0, terminator);
+      } break;
+    }
+  }
+
+  return ret;
+}
+
+/*
+ * GetRecordTuple
+ */
+
+Local<Object> ODBC::GetRecordTuple ( SQLHSTMT hStmt, Column* columns, 
+                                         short* colCount, uint16_t* buffer,
+                                         int bufferLength) {
+  NanEscapableScope();
+  
+  Local<Object> tuple = NanNew<Object>();
+        
+  for(int i = 0; i < *colCount; i++) {
+#ifdef UNICODE
+    tuple->Set( NanNew((uint16_t *) columns[i].name),
+                GetColumnValue( hStmt, columns[i], buffer, bufferLength));
+#else
+    tuple->Set( NanNew((const char *) columns[i].name),
+                GetColumnValue( hStmt, columns[i], buffer, bufferLength));
+#endif
+  }
+  
+  return NanEscapeScope(tuple);
+}
+
+Local<Object> ODBC::GetRecordTuple ( SQLHSTMT hStmt, ColumnCache* cache,
+                                     uint16_t* buffer, int bufferLength) {
+  NanEscapableScope();
+
+  Persistent<String>* names = GetColumnNames(cache);
+  
+  Local<Object> tuple = NanNew(cache->rowTemplate)->NewInstance();
+
+  for(int i = 0; i < cache->colCount; i++) {
+    tuple->Set( NanNew(names[i]),
+                GetColumnValue( hStmt, cache->columns[i], buffer, bufferLength));
+  }
+
+  return NanEscapeScope(tuple);
+}
+
+Local<Object> ODBC::GetRecordTuple ( ColumnCache* cache, ColumnData* row) {
+  NanEscapableScope();
+
+  Persistent<String>* names = GetColumnNames(cache);
+  
+  //every row starts out with all of the properties of the template so
+  //setting the values does not cause any hidden class transitions
+  Local<Object> tuple = NanNew(cache->rowTemplate)->NewInstance();
+
+  for(int i = 0; i < cache->colCount; i++) {
+    tuple->Set( NanNew(names[i]),
+                GetColumnValue( cache->columns[i], &row[i]));
+  }
+
+  return NanEscapeScope(tuple);
+}
+
+/*
+ * GetRecordArray
+ */
+
+Handle<Value> ODBC::GetRecordArray ( SQLHSTMT hStmt, Column* columns, 
+                                         short* colCount, uint16_t* buffer,
+                                         int bufferLength) {
+  NanEscapableScope();
+  
+  Local<Array> array = NanNew<Array>();
+        
+  for(int i = 0; i < *colCount; i++) {
+    array->Set( NanNew(i),
+                GetColumnValue( hStmt, columns[i], buffer, bufferLength));
+  }
+  
+  return NanEscapeScope(array);
+}
+
+Handle<Value> ODBC::GetRecordArray ( Column* columns, short* colCount,
+                                     ColumnData* row) {
+  NanEscapableScope();
+
+  Local<Array> array = NanNew<Array>();
+
+  for(int i = 0; i < *colCount; i++) {
+    array->Set( NanNew(i),
+                GetColumnValue( columns[i], &row[i]));
+  }
+
+  return NanEscapeScope(array);
+}
+
+/*
+ * GetParametersFromArray
+ * 
+ * descriptions, if given, are the SQL types of the first descriptionCount
+ * parameter markers.
+ */
+
+Parameter* ODBC::GetParametersFromArray (Local<Array> values, int *paramCount,
+                                         ParameterDescription* descriptions,
+                                         int descriptionCount) {
+  DEBUG_PRINTF("ODBC::GetParametersFromArray\n");
+  *paramCount = values->Length();
+  
+  Parameter* params = NULL;
+  
+  if (*paramCount > 0) {
+    params = (Parameter *) malloc(*paramCount * sizeof(Parameter));
+  }
+  
+  for (int i = 0; i < *paramCount; i++) {
+    GetParameterFromValue(
+      values->Get(i),
+      &params[i],
+      i,
+      (i < descriptionCount) ? &descriptions[i] : NULL);
+  } 
+  
+  return params;
+}
+
+/*
+ * IsParameterTypeFor
+ *
+ * Whether a value bound with the C type of param can be sent as sqlType
+ * without changing what kind of value it is. Null fits any type.
+ */
+
+static bool IsParameterTypeFor(Parameter* param, SQLSMALLINT sqlType) {
+  switch (param->ValueType) {
+    case SQL_C_DEFAULT :
+      return true;
+    case SQL_C_SBIGINT :
+    case SQL_C_DOUBLE :
+    case SQL_C_BIT :
+      switch (sqlType) {
+        case SQL_BIT :
+        case SQL_TINYINT :
+        case SQL_SMALLINT :
+        case SQL_INTEGER :
+        case SQL_BIGINT :
+        case SQL_REAL :
+        case SQL_FLOAT :
+        case SQL_DOUBLE :
+        case SQL_DECIMAL :
+        case SQL_NUMERIC :
+          return true;
+      }
+      return false;
+    case SQL_C_BINARY :
+      return sqlType == SQL_BINARY || sqlType == SQL_VARBINARY || sqlType == SQL_LONGVARBINARY;
+    case SQL_C_TYPE_TIMESTAMP :
+      //sending a timestamp as a date or time would drop part of it
+      return sqlType == SQL_TYPE_TIMESTAMP;
+    case SQL_C_CHAR :
+    case SQL_C_WCHAR :
+      switch (sqlType) {
+        case SQL_CHAR :
+        case SQL_VARCHAR :
+        case SQL_LONGVARCHAR :
+        case SQL_WCHAR :
+        case SQL_WVARCHAR :
+        case SQL_WLONGVARCHAR :
+          return true;
+      }
+      return false;
+  }
+  
+  return false;
+}
+
+static bool IsIntegerType(SQLSMALLINT sqlType) {
+  return sqlType == SQL_TINYINT || sqlType == SQL_SMALLINT
+    || sqlType == SQL_INTEGER || sqlType == SQL_BIGINT;
+}
+
+/*
+ * GetParameterFromValue
+ *
+ * Fill in the Parameter for one JS value, allocating the memory its value
+ * is bound from. index is the 0-based position of the parameter.
+ * 
+ * With a description the parameter is sent as the SQL type the statement
+ * expects, as long as that is the same kind of type as the value, so the
+ * server does not have to convert it. An object of the form
+ * { type, precision, scale, value } always binds value as that type.
+ */
+
+void ODBC::GetParameterFromValue (Local<Value> value, Parameter* param, int index,
+                                  ParameterDescription* description) {
+  ParameterDescription typed;
+  bool explicitType = false;
+  bool dataAtExec = false;
+  
+  if (value->IsObject() && !Buffer::HasInstance(value)) {
+    Local<Object> object = value->ToObject();
+    Local<String> typeKey = NanNew<String>("type");
+    Local<String> valueKey = NanNew<String>("value");
+    
+    if (object->Has(typeKey) && object->Has(valueKey)) {
+      Local<Value> precision = object->Get(NanNew<String>("precision"));
+      Local<Value> scale = object->Get(NanNew<String>("scale"));
+      
+      typed.DataType      = object->Get(typeKey)->Int32Value();
+      typed.ParameterSize = precision->IsNumber() ? precision->IntegerValue() : 0;
+      typed.DecimalDigits = scale->IsNumber() ? scale->Int32Value() : 0;
+      
+      value = object->Get(valueKey);
+      description = &typed;
+      explicitType = true;
+    }
+  }
+  
+  //values of unsupported types are bound as null
+  param->ValueType         = SQL_C_DEFAULT;
+  param->ParameterType     = SQL_VARCHAR;
+  param->ParameterValuePtr = NULL;
+  param->ColumnSize        = 0;
+  param->StrLen_or_IndPtr  = SQL_NULL_DATA;
+  param->BufferLength      = 0;
+  param->DecimalDigits     = 0;
+
+  DEBUG_PRINTF("ODBC::GetParameterFromValue - &param[%i].length = %X\n",
+               index, &param->StrLen_or_IndPtr);
+
+  //whole numbers for integer parameters are sent as integers, even the
+  //ones too big for an Int32
+  if (description != NULL && IsIntegerType(description->DataType) 
+      && value->IsNumber() && floor(value->NumberValue()) == value->NumberValue()
+      && fabs(value->NumberValue()) < 9.2e18) {
+    int64_t  *number = new int64_t(value->IntegerValue());
+    param->ValueType = SQL_C_SBIGINT;
+    param->ParameterType   = SQL_BIGINT;
+    param->ParameterValuePtr = number;
+    param->StrLen_or_IndPtr = 0;
+    
+    DEBUG_PRINTF("ODBC::GetParameterFromValue - IsInteger(): param[%i] c_type=%i type=%i buffer_length=%i size=%i length=%i value=%lld\n",
+                  index, param->ValueType, param->ParameterType,
+                  param->BufferLength, param->ColumnSize, param->StrLen_or_IndPtr,
+                  *number);
+  }
+  else if (value->IsString()) {
+    Local<String> string = value->ToString();
+    int length = string->Length();
+    
+    param->ValueType         = SQL_C_TCHAR;
+    param->ColumnSize        = 0; //SQL_SS_LENGTH_UNLIMITED 
+#ifdef UNICODE
+    param->ParameterType     = SQL_WVARCHAR;
+    param->BufferLength      = (length * sizeof(uint16_t)) + sizeof(uint16_t);
+#else
+    param->ParameterType     = SQL_VARCHAR;
+    param->BufferLength      = string->Utf8Length() + 1;
+#endif
+    param->ParameterValuePtr = malloc(param->BufferLength);
+    param->StrLen_or_IndPtr  = SQL_NTS;//param->BufferLength;
+
+#ifdef UNICODE
+    string->Write((uint16_t *) param->ParameterValuePtr);
+#else
+    string->WriteUtf8((char *) param->ParameterValuePtr);
+#endif
+
+    DEBUG_PRINTF("ODBC::GetParameterFromValue - IsString(): param[%i] c_type=%i type=%i buffer_length=%i size=%i length=%i value=%s\n",
+                  index, param->ValueType, param->ParameterType,
+                  param->BufferLength, param->ColumnSize, param->StrLen_or_IndPtr, 
+                  (char*) param->ParameterValuePtr);
+  }
+  else if (Buffer::HasInstance(value)) {
+    size_t length = Buffer::Length(value);
+    
+    //bound as raw bytes; the value is copied once because the Buffer may
+    //be collected before an asynchronous execute gets to it
+    param->ValueType         = SQL_C_BINARY;
+    param->ParameterType     = SQL_VARBINARY;
+    param->ColumnSize        = (length > 0) ? length : 1;
+    param->BufferLength      = length;
+    param->ParameterValuePtr = malloc((length > 0) ? length : 1);
+    param->StrLen_or_IndPtr  = length;
+    
+    memcpy(param->ParameterValuePtr, Buffer::Data(value), length);
+
+    DEBUG_PRINTF("ODBC::GetParameterFromValue - IsBuffer(): param[%i] c_type=%i type=%i buffer_length=%i size=%i length=%i\n",
+                 index, param->ValueType, param->ParameterType,
+                 param->BufferLength, param->ColumnSize, param->StrLen_or_IndPtr);
+  }
+  else if (value->IsDate()) {
+    SQL_TIMESTAMP_STRUCT timestamp;
+    
+    //invalid dates, and dates outside the range of the C library, are
+    //bound as null
+    if (!isnan(value->NumberValue())
+        && GetTimestampFromEpoch(value->NumberValue(), &timestamp)) {
+      param->ValueType         = SQL_C_TYPE_TIMESTAMP;
+      param->ParameterType     = SQL_TYPE_TIMESTAMP;
+      param->ColumnSize        = 23; //yyyy-mm-dd hh:mm:ss.fff
+      param->DecimalDigits     = 3;
+      param->BufferLength      = sizeof(SQL_TIMESTAMP_STRUCT);
+      param->ParameterValuePtr = malloc(sizeof(SQL_TIMESTAMP_STRUCT));
+      param->StrLen_or_IndPtr  = sizeof(SQL_TIMESTAMP_STRUCT);
+      
+      memcpy(param->ParameterValuePtr, &timestamp, sizeof(SQL_TIMESTAMP_STRUCT));
+    }
+
+    DEBUG_PRINTF("ODBC::GetParameterFromValue - IsDate(): param[%i] c_type=%i type=%i buffer_length=%i size=%i length=%i\n",
+                 index, param->ValueType, param->ParameterType,
+                 param->BufferLength, param->ColumnSize, param->StrLen_or_IndPtr);
+  }
+#ifdef NODE_ODBC_BIGINT
+  else if (value->IsBigInt()) {
+    bool lossless = true;
+    int64_t  *number = new int64_t(value.As<BigInt>()->Int64Value(&lossless));
+    
+    param->ValueType         = SQL_C_SBIGINT;
+    param->ParameterType     = SQL_BIGINT;
+    param->ParameterValuePtr = number;
+    param->StrLen_or_IndPtr  = 0;
+    
+    //too big for a BIGINT, send the digits instead
+    if (!lossless) {
+      Local<String> string = value->ToString();
+      
+      delete number;
+      
+      param->ValueType         = SQL_C_CHAR;
+      param->ParameterType     = SQL_DECIMAL;
+      param->ColumnSize        = string->Length();
+      param->BufferLength      = string->Utf8Length() + 1;
+      param->ParameterValuePtr = malloc(param->BufferLength);
+      param->StrLen_or_IndPtr  = SQL_NTS;
+      
+      string->WriteUtf8((char *) param->ParameterValuePtr);
+    }
+    
+    DEBUG_PRINTF("ODBC::GetParameterFromValue - IsBigInt(): param[%i] c_type=%i type=%i buffer_length=%i size=%i length=%i\n",
+                  index, param->ValueType, param->ParameterType,
+                  param->BufferLength, param->ColumnSize, param->StrLen_or_IndPtr);
+  }
+#endif
+  else if (value->IsObject() && value->ToObject()->Has(NanNew<String>("dataAtExec"))) {
+    Local<Object> descriptor = value->ToObject();
+    Local<Value> length = descriptor->Get(NanNew<String>("length"));
+    bool binary = descriptor->Get(NanNew<String>("binary"))->BooleanValue();
+
+    //the value is sent later with SQLPutData; SQLParamData hands the
+    //ParameterValuePtr back to us, so it holds the parameter index. Text
+    //chunks are encoded by the caller to match SQL_C_TCHAR.
+#ifdef UNICODE
+    param->ValueType         = binary ? SQL_C_BINARY : SQL_C_WCHAR;
+    param->ParameterType     = binary ? SQL_LONGVARBINARY : SQL_WLONGVARCHAR;
+#else
+    param->ValueType         = binary ? SQL_C_BINARY : SQL_C_CHAR;
+    param->ParameterType     = binary ? SQL_LONGVARBINARY : SQL_LONGVARCHAR;
+#endif
+    param->ParameterValuePtr = malloc(sizeof(int));
+    param->BufferLength      = 0;
+
+    *(int *) param->ParameterValuePtr = index;
+    dataAtExec = true;
+
+    if (length->IsNumber() && length->IntegerValue() >= 0) {
+      param->ColumnSize       = length->IntegerValue();
+      param->StrLen_or_IndPtr = SQL_LEN_DATA_AT_EXEC(param->ColumnSize);
+    }
+    else {
+      param->StrLen_or_IndPtr = SQL_DATA_AT_EXEC;
+    }
+
+    DEBUG_PRINTF("ODBC::GetParameterFromValue - IsDataAtExec(): param[%i] c_type=%i type=%i buffer_length=%i size=%i length=%i\n",
+                 index, param->ValueType, param->ParameterType,
+                 param->BufferLength, param->ColumnSize, param->StrLen_or_IndPtr);
+  }
+  else if (value->IsNull()) {
+    param->ValueType = SQL_C_DEFAULT;
+    param->ParameterType   = SQL_VARCHAR;
+    param->StrLen_or_IndPtr = SQL_NULL_DATA;
+
+    DEBUG_PRINTF("ODBC::GetParameterFromValue - IsNull(): param[%i] c_type=%i type=%i buffer_length=%i size=%i length=%i\n",
+                 index, param->ValueType, param->ParameterType,
+                 param->BufferLength, param->ColumnSize, param->StrLen_or_IndPtr);
+  }
+  else if (value->IsInt32()) {
+    int64_t  *number = new int64_t(value->IntegerValue());
+    param->ValueType = SQL_C_SBIGINT;
+    param->ParameterType   = SQL_BIGINT;
+    param->ParameterValuePtr = number;
+    param->StrLen_or_IndPtr = 0;
+    
+    DEBUG_PRINTF("ODBC::GetParameterFromValue - IsInt32(): param[%i] c_type=%i type=%i buffer_length=%i size=%i length=%i value=%lld\n",
+                  index, param->ValueType, param->ParameterType,
+                  param->BufferLength, param->ColumnSize, param->StrLen_or_IndPtr,
+                  *number);
+  }
+  else if (value->IsNumber()) {
+    double *number   = new double(value->NumberValue());
+    
+    param->ValueType         = SQL_C_DOUBLE;
+    param->ParameterType     = SQL_DECIMAL;
+    param->ParameterValuePtr = number;
+    param->BufferLength      = sizeof(double);
+    param->StrLen_or_IndPtr  = param->BufferLength;
+    param->DecimalDigits     = 7;
+    param->ColumnSize        = sizeof(double);
+
+    DEBUG_PRINTF("ODBC::GetParameterFromValue - IsNumber(): param[%i] c_type=%i type=%i buffer_length=%i size=%i length=%i value=%f\n",
+                  index, param->ValueType, param->ParameterType,
+                  param->BufferLength, param->ColumnSize, param->StrLen_or_IndPtr,
+		                *number);
+  }
+  else if (value->IsBoolean()) {
+    bool *boolean = new bool(value->BooleanValue());
+    param->ValueType         = SQL_C_BIT;
+    param->ParameterType     = SQL_BIT;
+    param->ParameterValuePtr = boolean;
+    param->StrLen_or_IndPtr  = 0;
+    
+    DEBUG_PRINTF("ODBC::GetParameterFromValue - IsBoolean(): param[%i] c_type=%i type=%i buffer_length=%i size=%i length=%i\n",
+                 index, param->ValueType, param->ParameterType,
+                 param->BufferLength, param->ColumnSize, param->StrLen_or_IndPtr);
+  }
+  
+  if (description != NULL && description->DataType != 0 && !dataAtExec
+      && (explicitType || IsParameterTypeFor(param, description->DataType))) {
+    SQLLEN size = description->ParameterSize;
+    SQLLEN needed = 0;
+    
+    //described strings and binary values are never declared shorter than
+    //they are; the server reports any truncation itself
+    if (!explicitType && param->ValueType == SQL_C_TCHAR) {
+      needed = (param->BufferLength / sizeof(SQLTCHAR)) - 1;
+    }
+    else if (!explicitType && param->ValueType == SQL_C_BINARY) {
+      needed = param->ColumnSize;
+    }
+    
+    if (needed > size) {
+      size = needed;
+    }
+    
+    param->ParameterType = description->DataType;
+    param->DecimalDigits = description->DecimalDigits;
+    
+    if (size > 0) {
+      param->ColumnSize = size;
+    }
+    
+    DEBUG_PRINTF("ODBC::GetParameterFromValue - described: param[%i] type=%i size=%i digits=%i\n",
+                 index, param->ParameterType, param->ColumnSize, param->DecimalDigits);
+  }
+}
+
+/*
+ * SetParameterValue
+ *
+ * Overwrite the value of an already bound Parameter in place. Returns false,
+ * leaving the Parameter as it was, if the value does not have the type the
+ * parameter was bound with or does not fit in its buffer; the Parameter
+ * then has to be rebuilt and bound again.
+ */
+
+bool ODBC::SetParameterValue (Local<Value> value, Parameter* param) {
+  //the indicator is only read at execute time, so any bound parameter can
+  //be set to null without binding it again
+  if (value->IsNull() || value->IsUndefined()) {
+    param->StrLen_or_IndPtr = SQL_NULL_DATA;
+    
+    return true;
+  }
+  
+  switch (param->ValueType) {
+    case SQL_C_TCHAR :
+      if (value->IsString()) {
+        Local<String> string = value->ToString();
+        
+#ifdef UNICODE
+        if ((SQLLEN) ((string->Length() * sizeof(uint16_t)) + sizeof(uint16_t)) > param->BufferLength) {
+          return false;
+        }
+        
+        string->Write((uint16_t *) param->ParameterValuePtr);
+#else
+        if (string->Utf8Length() + 1 > param->BufferLength) {
+          return false;
+        }
+        
+        string->WriteUtf8((char *) param->ParameterValuePtr);
+#endif
+        param->StrLen_or_IndPtr = SQL_NTS;
+        
+        return true;
+      }
+      break;
+    case SQL_C_BINARY :
+      if (Buffer::HasInstance(value)) {
+        SQLLEN length = Buffer::Length(value);
+        
+        if (length > param->BufferLength) {
+          return false;
+        }
+        
+        memcpy(param->ParameterValuePtr, Buffer::Data(value), length);
+        param->StrLen_or_IndPtr = length;
+        
+        return true;
+      }
+      break;
+    case SQL_C_SBIGINT :
+      if (value->IsInt32() || (value->IsNumber() 
+          && floor(value->NumberValue()) == value->NumberValue()
+          && fabs(value->NumberValue()) < 9.2e18)) {
+        *(int64_t *) param->ParameterValuePtr = value->IntegerValue();
+        param->StrLen_or_IndPtr = 0;
+        
+        return true;
+      }
+#ifdef NODE_ODBC_BIGINT
+      else if (value->IsBigInt()) {
+        bool lossless = true;
+        int64_t number = value.As<BigInt>()->Int64Value(&lossless);
+        
+        if (lossless) {
+          *(int64_t *) param->ParameterValuePtr = number;
+          param->StrLen_or_IndPtr = 0;
+        }
+        
+        return lossless;
+      }
+#endif
+      break;
+    case SQL_C_TYPE_TIMESTAMP :
+      if (value->IsDate() && !isnan(value->NumberValue())
+          && GetTimestampFromEpoch(
+            value->NumberValue(),
+            (SQL_TIMESTAMP_STRUCT *) param->ParameterValuePtr)) {
+        param->StrLen_or_IndPtr = sizeof(SQL_TIMESTAMP_STRUCT);
+        
+        return true;
+      }
+      break;
+    case SQL_C_DOUBLE :
+      if (value->IsNumber()) {
+        *(double *) param->ParameterValuePtr = value->NumberValue();
+        param->StrLen_or_IndPtr = sizeof(double);
+        
+        return true;
+      }
+      break;
+    case SQL_C_BIT :
+      if (value->IsBoolean()) {
+        *(bool *) param->ParameterValuePtr = value->BooleanValue();
+        param->StrLen_or_IndPtr = 0;
+        
+        return true;
+      }
+      break;
+  }
+  
+  return false;
+}
+
+/*
+ * FreeParameter
+ *
+ * Free the memory a Parameter's value is bound from.
+ */
+
+void ODBC::FreeParameter (Parameter* param) {
+  if (param->ParameterValuePtr == NULL) {
+    return;
+  }
+  
+  switch (param->ValueType) {
+    case SQL_C_WCHAR:   free(param->ParameterValuePtr);             break;
+    case SQL_C_CHAR:    free(param->ParameterValuePtr);             break; 
+    case SQL_C_BINARY:  free(param->ParameterValuePtr);             break;
+    case SQL_C_TYPE_TIMESTAMP: free(param->ParameterValuePtr);      break;
+    case SQL_C_SBIGINT: delete (int64_t *)param->ParameterValuePtr; break;
+    case SQL_C_DOUBLE:  delete (double  *)param->ParameterValuePtr; break;
+    case SQL_C_BIT:     delete (bool    *)param->ParameterValuePtr; break;
+  }
+  
+  param->ParameterValuePtr = NULL;
+}
+
+/*
+ * GetParameterArraysFromRows
+ *
+ * Convert an array of parameter arrays (one per row) into column-wise
+ * parameter arrays suitable for binding with SQL_ATTR_PARAMSET_SIZE. The type
+ * of each column is taken from its non-null values: int32 values are widened
+ * to doubles if the column also contains other numbers, BigInts only mix
+ * with int32 values, any other mix of types is rejected. Throws and returns NULL if the rows are not usable.
+ */
+
+ParameterArray* ODBC::GetParameterArraysFromRows (Local<Array> rows, int *paramCount, int *rowCount) {
+  DEBUG_PRINTF("ODBC::GetParameterArraysFromRows\n");
+  
+  *rowCount = rows->Length();
+  *paramCount = 0;
+  
+  if (*rowCount == 0 || !rows->Get(0)->IsArray()) {
+    NanThrowTypeError("Rows must be a non-empty Array of Arrays");
+    return NULL;
+  }
+  
+  int count = Local<Array>::Cast(rows->Get(0))->Length();
+  
+  if (count == 0) {
+    NanThrowTypeError("Rows must contain at least one parameter");
+    return NULL;
+  }
+  
+  ParameterArray* params = (ParameterArray *) calloc(count, sizeof(ParameterArray));
+  
+  //whether a column has BigInt values; they only mix with int32 numbers,
+  //whichever comes first
+  bool* bigints = (bool *) calloc(count, sizeof(bool));
+  
+  //first pass: work out the type and the element size of every column
+  for (int j = 0; j < *rowCount; j++) {
+    Local<Value> row = rows->Get(j);
+    
+    if (!row->IsArray() || Local<Array>::Cast(row)->Length() != (uint32_t) count) {
+      free(params);
+      free(bigints);
+      
+      NanThrowTypeError("Every row must be an Array with the same number of parameters");
+      return NULL;
+    }
+    
+    Local<Array> values = Local<Array>::Cast(row);
+    
+    for (int i = 0; i < count; i++) {
+      Local<Value> value = values->Get(i);
+      SQLSMALLINT valueType;
+      
+      if (value->IsNull() || value->IsUndefined()) {
+        continue;
+      }
+      else if (Buffer::HasInstance(value)) {
+        SQLLEN length = Buffer::Length(value);
+        
+        valueType = SQL_C_BINARY;
+        
+        if (length > params[i].BufferLength) {
+          params[i].BufferLength = length;
+          params[i].ColumnSize = length;
+        }
+      }
+      else if (value->IsString()) {
+        Local<String> string = value->ToString();
+        
+        valueType = SQL_C_TCHAR;
+        
+#ifdef UNICODE
+        SQLLEN length = (string->Length() * sizeof(uint16_t)) + sizeof(uint16_t);
+#else
+        SQLLEN length = string->Utf8Length() + 1;
+#endif
+        if (length > params[i].BufferLength) {
+          params[i].BufferLength = length;
+        }
+        
+        if (string->Length() > params[i].ColumnSize) {
+          params[i].ColumnSize = string->Length();
+        }
+      }
+      else if (value->IsInt32()) {
+        valueType = (params[i].ValueType == SQL_C_DOUBLE) ? SQL_C_DOUBLE : SQL_C_SBIGINT;
+      }
+      else if (value->IsNumber()) {
+        if (bigints[i]) {
+          free(params);
+          free(bigints);
+          
+          NanThrowTypeError("A parameter can't mix BigInt values with non-integer Numbers");
+          return NULL;
+        }
+        
+        valueType = SQL_C_DOUBLE;
+        
+        if (params[i].ValueType == SQL_C_SBIGINT) {
+          params[i].ValueType = SQL_C_DOUBLE;
+        }
+      }
+      else if (value->IsBoolean()) {
+        valueType = SQL_C_BIT;
+      }
+      else if (value->IsDate()) {
+        valueType = SQL_C_TYPE_TIMESTAMP;
+      }
+#ifdef NODE_ODBC_BIGINT
+      else if (value->IsBigInt()) {
+        if (params[i].ValueType == SQL_C_DOUBLE) {
+          free(params);
+          free(bigints);
+          
+          NanThrowTypeError("A parameter can't mix BigInt values with non-integer Numbers");
+          return NULL;
+        }
+        
+        bigints[i] = true;
+        valueType = SQL_C_SBIGINT;
+      }
+#endif
+      else {
+        free(params);
+        free(bigints);
+        
+        NanThrowTypeError("Unsupported parameter type in rows");
+        return NULL;
+      }
+      
+      if (params[i].ValueType == 0) {
+        params[i].ValueType = valueType;
+      }
+      else if (params[i].ValueType != valueType) {
+        free(params);
+        free(bigints);
+        
+        NanThrowTypeError("All non-null values of a parameter must have the same type");
+        return NULL;
+      }
+    }
+  }
+  
+  free(bigints);
+  
+  //second pass: allocate the arrays and copy the values in
+  for (int i = 0; i < count; i++) {
+    switch (params[i].ValueType) {
+      case SQL_C_SBIGINT :
+        params[i].ParameterType = SQL_BIGINT;
+        params[i].BufferLength  = sizeof(int64_t);
+        params[i].ColumnSize    = 0;
+        break;
+      case SQL_C_DOUBLE :
+        params[i].ParameterType = SQL_DECIMAL;
+        params[i].BufferLength  = sizeof(double);
+        params[i].ColumnSize    = sizeof(double);
+        params[i].DecimalDigits = 7;
+        break;
+      case SQL_C_BIT :
+        params[i].ParameterType = SQL_BIT;
+        params[i].BufferLength  = sizeof(unsigned char);
+        params[i].ColumnSize    = 0;
+        break;
+      case SQL_C_TYPE_TIMESTAMP :
+        params[i].ParameterType = SQL_TYPE_TIMESTAMP;
+        params[i].BufferLength  = sizeof(SQL_TIMESTAMP_STRUCT);
+        params[i].ColumnSize    = 23;
+        params[i].DecimalDigits = 3;
+        break;
+      case SQL_C_BINARY :
+        params[i].ParameterType = SQL_VARBINARY;
+        
+        if (params[i].BufferLength == 0) {
+          params[i].BufferLength = 1;
+          params[i].ColumnSize = 1;
+        }
+        break;
+      default :
+        //strings, and columns that only contain nulls
+        params[i].ValueType = SQL_C_TCHAR;
+#ifdef UNICODE
+        params[i].ParameterType = SQL_WVARCHAR;
+#else
+        params[i].ParameterType = SQL_VARCHAR;
+#endif
+        if (params[i].BufferLength == 0) {
+          params[i].BufferLength = sizeof(SQLTCHAR);
+        }
+        
+        if (params[i].ColumnSize == 0) {
+          params[i].ColumnSize = 1;
+        }
+        break;
+    }
+    
+    params[i].ParameterValuePtr = calloc(*rowCount, params[i].BufferLength);
+    params[i].StrLen_or_IndPtr = (SQLLEN *) malloc(*rowCount * sizeof(SQLLEN));
+  }
+  
+  for (int j = 0; j < *rowCount; j++) {
+    Local<Array> values = Local<Array>::Cast(rows->Get(j));
+    
+    for (int i = 0; i < count; i++) {
+      Local<Value> value = values->Get(i);
+      char* element = (char *) params[i].ParameterValuePtr + (j * params[i].BufferLength);
+      
+      if (value->IsNull() || value->IsUndefined()) {
+        params[i].StrLen_or_IndPtr[j] = SQL_NULL_DATA;
+        continue;
+      }
+      
+      switch (params[i].ValueType) {
+        case SQL_C_SBIGINT :
+#ifdef NODE_ODBC_BIGINT
+          *(int64_t *) element = value->IsBigInt()
+            ? value.As<BigInt>()->Int64Value()
+            : value->IntegerValue();
+#else
+          *(int64_t *) element = value->IntegerValue();
+#endif
+          params[i].StrLen_or_IndPtr[j] = 0;
+          break;
+        case SQL_C_TYPE_TIMESTAMP :
+          if (isnan(value->NumberValue())
+              || !GetTimestampFromEpoch(value->NumberValue(), (SQL_TIMESTAMP_STRUCT *) element)) {
+            params[i].StrLen_or_IndPtr[j] = SQL_NULL_DATA;
+            break;
+          }
+          
+          params[i].StrLen_or_IndPtr[j] = sizeof(SQL_TIMESTAMP_STRUCT);
+          break;
+        case SQL_C_DOUBLE :
+          *(double *) element = value->NumberValue();
+          params[i].StrLen_or_IndPtr[j] = sizeof(double);
+          break;
+        case SQL_C_BIT :
+          *(unsigned char *) element = value->BooleanValue() ? 1 : 0;
+          params[i].StrLen_or_IndPtr[j] = 0;
+          break;
+        case SQL_C_BINARY :
+          memcpy(element, Buffer::Data(value), Buffer::Length(value));
+          params[i].StrLen_or_IndPtr[j] = Buffer::Length(value);
+          break;
+        default :
+#ifdef UNICODE
+          value->ToString()->Write((uint16_t *) element);
+#else
+          value->ToString()->WriteUtf8(element);
+#endif
+          params[i].StrLen_or_IndPtr[j] = SQL_NTS;
+          break;
+      }
+    }
+  }
+  
+  *paramCount = count;
+  
+  return params;
+}
+
+/*
+ * FreeParameterArrays
+ */
+
+void ODBC::FreeParameterArrays (ParameterArray* params, int paramCount) {
+  DEBUG_PRINTF("ODBC::FreeParameterArrays\n");
+  
+  for (int i = 0; i < paramCount; i++) {
+    free(params[i].ParameterValuePtr);
+    free(params[i].StrLen_or_IndPtr);
+  }
+  
+  free(params);
+}
+
+/*
+ * ExecuteParameterArrays
+ *
+ * Bind column-wise parameter arrays to a prepared statement and execute it
+ * once for all rows. The status of each row is written to rowStatus. The
+ * statement is left bound; call UnbindParameterArrays once any diagnostics
+ * have been read. Safe to call from the thread pool.
+ */
+
+SQLRETURN ODBC::ExecuteParameterArrays (SQLHSTMT hStmt, ParameterArray* params,
+                                        int paramCount, int rowCount,
+                                        SQLUSMALLINT* rowStatus,
+                                        SQLLEN* affectedRows) {
+  DEBUG_PRINTF("ODBC::ExecuteParameterArrays paramCount=%i rowCount=%i\n",
+               paramCount, rowCount);
+  
+  SQLRETURN ret;
+  
+  *affectedRows = 0;
+  
+  //rows the driver never gets to are reported as unused
+  for (int j = 0; j < rowCount; j++) {
+    rowStatus[j] = SQL_PARAM_UNUSED;
+  }
+  
+  SQLSetStmtAttr(hStmt, SQL_ATTR_PARAM_BIND_TYPE, (SQLPOINTER) SQL_PARAM_BIND_BY_COLUMN, 0);
+  
+  ret = SQLSetStmtAttr(hStmt, SQL_ATTR_PARAMSET_SIZE, (SQLPOINTER) (SQLULEN) rowCount, 0);
+  
+  if (ret != SQL_SUCCESS) {
+    //SQL_SUCCESS_WITH_INFO (01S02) means the driver substituted a different
+    //set size, likely 1, and would only execute some of the rows
+    DEBUG_PRINTF("ODBC::ExecuteParameterArrays - parameter arrays not supported\n");
+    
+    SQLSetStmtAttr(hStmt, SQL_ATTR_PARAMSET_SIZE, (SQLPOINTER) 1, 0);
     
-    //get the column type and store it directly in column[i].type
-    ret = SQLColAttribute( hStmt,
-                           columns[i].index,
-                           SQL_DESC_TYPE,
-                           NULL,
-                           0,
-                           NULL,
-                           &columns[i].type);
+    return ExecuteParameterRows(hStmt, params, paramCount, rowCount, rowStatus, affectedRows);
   }
   
-  return columns;
+  SQLSetStmtAttr(hStmt, SQL_ATTR_PARAM_STATUS_PTR, rowStatus, 0);
+  
+  for (int i = 0; i < paramCount; i++) {
+    ret = SQLBindParameter(
+      hStmt,              //StatementHandle
+      i + 1,              //ParameterNumber
+      SQL_PARAM_INPUT,    //InputOutputType
+      params[i].ValueType,
+      params[i].ParameterType,
+      params[i].ColumnSize,
+      params[i].DecimalDigits,
+      params[i].ParameterValuePtr,
+      params[i].BufferLength,
+      params[i].StrLen_or_IndPtr);
+    
+    if (!SQL_SUCCEEDED(ret)) {
+      return ret;
+    }
+  }
+  
+  ret = SQLExecute(hStmt);
+  
+  //SQL_NO_DATA means that a searched update or delete matched nothing
+  if (ret == SQL_NO_DATA) {
+    ret = SQL_SUCCESS;
+  }
+  else if (SQL_SUCCEEDED(ret) && !SQL_SUCCEEDED(SQLRowCount(hStmt, affectedRows))) {
+    *affectedRows = 0;
+  }
+  
+  return ret;
 }
 
 /*
- * FreeColumns
+ * ExecuteParameterRows
+ *
+ * Fallback for drivers without parameter arrays: bind each row of the arrays
+ * in turn and execute it on its own. Stops at the first row that fails,
+ * leaving the rest SQL_PARAM_UNUSED, so that the diagnostics on the
+ * statement are those of that row.
  */
 
-void ODBC::FreeColumns(Column* columns, short* colCount) {
-  for(int i = 0; i < *colCount; i++) {
-      delete [] columns[i].name;
+SQLRETURN ODBC::ExecuteParameterRows (SQLHSTMT hStmt, ParameterArray* params,
+                                      int paramCount, int rowCount,
+                                      SQLUSMALLINT* rowStatus,
+                                      SQLLEN* affectedRows) {
+  SQLRETURN ret = SQL_SUCCESS;
+  
+  for (int j = 0; j < rowCount; j++) {
+    for (int i = 0; i < paramCount; i++) {
+      ret = SQLBindParameter(
+        hStmt,              //StatementHandle
+        i + 1,              //ParameterNumber
+        SQL_PARAM_INPUT,    //InputOutputType
+        params[i].ValueType,
+        params[i].ParameterType,
+        params[i].ColumnSize,
+        params[i].DecimalDigits,
+        (unsigned char *) params[i].ParameterValuePtr + (j * params[i].BufferLength),
+        params[i].BufferLength,
+        &params[i].StrLen_or_IndPtr[j]);
+      
+      if (!SQL_SUCCEEDED(ret)) {
+        rowStatus[j] = SQL_PARAM_ERROR;
+        
+        return ret;
+      }
+    }
+    
+    ret = SQLExecute(hStmt);
+    
+    if (ret == SQL_NO_DATA) {
+      rowStatus[j] = SQL_PARAM_SUCCESS;
+      ret = SQL_SUCCESS;
+      
+      continue;
+    }
+    
+    if (!SQL_SUCCEEDED(ret)) {
+      rowStatus[j] = SQL_PARAM_ERROR;
+      
+      return ret;
+    }
+    
+    rowStatus[j] = (ret == SQL_SUCCESS) ? SQL_PARAM_SUCCESS : SQL_PARAM_SUCCESS_WITH_INFO;
+    
+    SQLLEN rows = 0;
+    
+    if (SQL_SUCCEEDED(SQLRowCount(hStmt, &rows)) && rows > 0) {
+      *affectedRows += rows;
+    }
+    
+    //discard any result set so that the next row can be executed
+    SQLFreeStmt(hStmt, SQL_CLOSE);
   }
+  
+  return ret;
+}
 
-  delete [] columns;
+/*
+ * UnbindParameterArrays
+ *
+ * Return a statement used by ExecuteParameterArrays to single row execution
+ * and drop the bindings to the arrays so they can be freed.
+ */
+
+void ODBC::UnbindParameterArrays (SQLHSTMT hStmt) {
+  DEBUG_PRINTF("ODBC::UnbindParameterArrays\n");
   
-  *colCount = 0;
+  SQLFreeStmt(hStmt, SQL_CLOSE);
+  SQLFreeStmt(hStmt, SQL_RESET_PARAMS);
+  
+  SQLSetStmtAttr(hStmt, SQL_ATTR_PARAMSET_SIZE, (SQLPOINTER) 1, 0);
+  SQLSetStmtAttr(hStmt, SQL_ATTR_PARAM_STATUS_PTR, NULL, 0);
 }
 
 /*
- * GetColumnValue
+ * GetParameterArrayStatus
+ *
+ * Build the { affectedRows, status } object handed back by executeBatch
  */
 
-Handle<Value> ODBC::GetColumnValue( SQLHSTMT hStmt, Column column, 
-                                        uint16_t* buffer, int bufferLength) {
+Local<Object> ODBC::GetParameterArrayStatus (SQLUSMALLINT* rowStatus, int rowCount, SQLLEN affectedRows) {
   NanEscapableScope();
-  SQLLEN len = 0;
+  
+  Local<Object> objResult = NanNew<Object>();
+  Local<Array> status = NanNew<Array>(rowCount);
+  
+  for (int j = 0; j < rowCount; j++) {
+    status->Set(NanNew(j), NanNew<Number>(rowStatus[j]));
+  }
+  
+  objResult->Set(NanNew("affectedRows"), NanNew<Number>(affectedRows));
+  objResult->Set(NanNew("status"), status);
+  
+  return NanEscapeScope(objResult);
+}
+
+/*
+ * GetColumnBufferType
+ *
+ * How values of a column are stored for FETCH_COLUMNS; matches the
+ * conversions done by GetColumnValue.
+ */
 
-  //reset the buffer
-  buffer[0] = '\0';
+enum { COLUMN_INT32, COLUMN_DOUBLE, COLUMN_DATE, COLUMN_BOOLEAN, COLUMN_STRING };
 
-  //TODO: SQLGetData can supposedly return multiple chunks, need to do this to 
-  //retrieve large fields
-  int ret; 
-  
-  switch ((int) column.type) {
-    case SQL_INTEGER : 
+static int GetColumnBufferType(int type) {
+  switch (type) {
+    case SQL_INTEGER :
     case SQL_SMALLINT :
-    case SQL_TINYINT : {
-        int32_t value = 0;
-        
-        ret = SQLGetData(
-          hStmt, 
-          column.index, 
-          SQL_C_SLONG,
-          &value, 
-          sizeof(value), 
-          &len);
-        
-        DEBUG_PRINTF("ODBC::GetColumnValue - Integer: index=%i name=%s type=%i len=%i ret=%i val=%li\n", 
-                    column.index, column.name, column.type, len, ret, value);
-        
-        if (len == SQL_NULL_DATA) {
-          return NanEscapeScope(NanNull());
-        }
-        else {
-          return NanEscapeScope(NanNew<Integer>(value));
-        }
-      }
-      break;
+    case SQL_TINYINT :
+      return COLUMN_INT32;
     case SQL_NUMERIC :
     case SQL_DECIMAL :
     case SQL_BIGINT :
     case SQL_FLOAT :
     case SQL_REAL :
-    case SQL_DOUBLE : {
-        double value;
-        
-        ret = SQLGetData(
-          hStmt, 
-          column.index, 
-          SQL_C_DOUBLE,
-          &value, 
-          sizeof(value), 
-          &len);
-        
-         DEBUG_PRINTF("ODBC::GetColumnValue - Number: index=%i name=%s type=%i len=%i ret=%i val=%f\n", 
-                    column.index, column.name, column.type, len, ret, value);
-        
-        if (len == SQL_NULL_DATA) {
-          return NanEscapeScope(NanNull());
-          //return Null();
-        }
-        else {
-          return NanEscapeScope(NanNew<Number>(value));
-          //return Number::New(value);
-        }
-      }
-      break;
+    case SQL_DOUBLE :
+      return COLUMN_DOUBLE;
     case SQL_DATETIME :
-    case SQL_TIMESTAMP : {
-      //I am not sure if this is locale-safe or cross database safe, but it 
-      //works for me on MSSQL
-#ifdef _WIN32
-      struct tm timeInfo = {};
+    case SQL_TIMESTAMP :
+      return COLUMN_DATE;
+    case SQL_BIT :
+      return COLUMN_BOOLEAN;
+    default :
+      return COLUMN_STRING;
+  }
+}
 
-      ret = SQLGetData(
-        hStmt, 
-        column.index, 
-        SQL_C_CHAR,
-        (char *) buffer, 
-        bufferLength, 
-        &len);
+static void ReserveColumnValues(ColumnBuffer* buffer, size_t length) {
+  if (buffer->valuesLength + length <= buffer->valuesCapacity) {
+    return;
+  }
+  
+  size_t capacity = (buffer->valuesCapacity > 0) ? buffer->valuesCapacity * 2 : 256;
+  
+  while (capacity < buffer->valuesLength + length) {
+    capacity *= 2;
+  }
+  
+  buffer->values = (unsigned char *) realloc(buffer->values, capacity);
+  buffer->valuesCapacity = capacity;
+}
 
-      DEBUG_PRINTF("ODBC::GetColumnValue - W32 Timestamp: index=%i name=%s type=%i len=%i\n", 
-                    column.index, column.name, column.type, len);
+/*
+ * NewTypedArray
+ *
+ * Create a typed array with the global constructor `type` and copy count
+ * elements of data into it.
+ */
 
-      if (len == SQL_NULL_DATA) {
-        return NanEscapeScope(NanNull());
-        //return Null();
-      }
-      else {
-        if (strptime((char *) buffer, "%Y-%m-%d %H:%M:%S", &timeInfo)) {
-          //a negative value means that mktime() should use timezone information
-          //and system databases to attempt to determine whether DST is in effect
-          //at the specified time.
-          timeInfo.tm_isdst = -1;
-          
-          //return NanEscapeScope(Date::New(Isolate::GetCurrent(), (double(mktime(&timeInfo)) * 1000));
-          return NanEscapeScope(NanNew<Date>(double(mktime(&timeInfo)) * 1000));
-        }
-        else {
-          return NanEscapeScope(NanNew((char *)buffer));
-        }
-      }
-#else
-      struct tm timeInfo = { 
-        tm_sec : 0
-        , tm_min : 0
-        , tm_hour : 0
-        , tm_mday : 0
-        , tm_mon : 0
-        , tm_year : 0
-        , tm_wday : 0
-        , tm_yday : 0
-        , tm_isdst : 0
-        , tm_gmtoff : 0
-        , tm_zone : 0
-      };
-
-      SQL_TIMESTAMP_STRUCT odbcTime;
-      
-      ret = SQLGetData(
-        hStmt, 
-        column.index, 
-        SQL_C_TYPE_TIMESTAMP,
-        &odbcTime, 
-        bufferLength, 
-        &len);
+static Local<Object> NewTypedArray(const char* type, void* data, int count, size_t elementSize) {
+  NanEscapableScope();
+  
+  Local<Function> constructor = Local<Function>::Cast(
+    NanGetCurrentContext()->Global()->Get(NanNew(type)));
+  
+  Local<Value> argv[1] = { NanNew<Number>(count) };
+  Local<Object> array = constructor->NewInstance(1, argv);
+  
+  if (count > 0) {
+    memcpy(array->GetIndexedPropertiesExternalArrayData(), data, count * elementSize);
+  }
+  
+  return NanEscapeScope(array);
+}
 
-      DEBUG_PRINTF("ODBC::GetColumnValue - Unix Timestamp: index=%i name=%s type=%i len=%i\n", 
-                    column.index, column.name, column.type, len);
+/*
+ * CreateColumnBuffers
+ */
 
-      if (len == SQL_NULL_DATA) {
-        return NanEscapeScope(NanNull());
-        //return Null();
-      }
-      else {
-        timeInfo.tm_year = odbcTime.year - 1900;
-        timeInfo.tm_mon = odbcTime.month - 1;
-        timeInfo.tm_mday = odbcTime.day;
-        timeInfo.tm_hour = odbcTime.hour;
-        timeInfo.tm_min = odbcTime.minute;
-        timeInfo.tm_sec = odbcTime.second;
-
-        //a negative value means that mktime() should use timezone information 
-        //and system databases to attempt to determine whether DST is in effect 
-        //at the specified time.
-        timeInfo.tm_isdst = -1;
-#ifdef TIMEGM
-        return NanEscapeScope(NanNew<Date>((double(timegm(&timeInfo)) * 1000)
-                          + (odbcTime.fraction / 1000000)));
-#else
-        return NanEscapeScope(NanNew<Date>((double(timelocal(&timeInfo)) * 1000)
-                          + (odbcTime.fraction / 1000000)));
-#endif
-        //return Date::New((double(timegm(&timeInfo)) * 1000) 
-        //                  + (odbcTime.fraction / 1000000));
-      }
-#endif
-    } break;
-    case SQL_BIT :
-      //again, i'm not sure if this is cross database safe, but it works for 
-      //MSSQL
-      ret = SQLGetData(
-        hStmt, 
-        column.index, 
-        SQL_C_CHAR,
-        (char *) buffer, 
-        bufferLength, 
-        &len);
+ColumnBuffer* ODBC::CreateColumnBuffers(short colCount) {
+  DEBUG_PRINTF("ODBC::CreateColumnBuffers colCount=%i\n", colCount);
+  
+  return (ColumnBuffer *) calloc(colCount, sizeof(ColumnBuffer));
+}
 
-      DEBUG_PRINTF("ODBC::GetColumnValue - Bit: index=%i name=%s type=%i len=%i\n", 
-                    column.index, column.name, column.type, len);
+/*
+ * AppendColumnData
+ *
+ * Append one row, as returned by GetRecordData, to the column buffers.
+ * Date conversion goes through V8 so this must be called on the event loop
+ * thread.
+ */
 
-      if (len == SQL_NULL_DATA) {
-        return NanEscapeScope(NanNull());
-      }
-      else {
-        return NanEscapeScope(NanNew((*buffer == '0') ? false : true));
+void ODBC::AppendColumnData(ColumnBuffer* buffers, Column* columns,
+                            short* colCount, ColumnData* row) {
+  for (int i = 0; i < *colCount; i++) {
+    ColumnBuffer* buffer = &buffers[i];
+    int type = GetColumnBufferType(GetColumnType(columns[i]));
+    bool isNull = (row[i].len == SQL_NULL_DATA);
+    
+    if (buffer->count == buffer->capacity) {
+      int capacity = (buffer->capacity > 0) ? buffer->capacity * 2 : 64;
+      
+      buffer->nulls = (unsigned char *) realloc(buffer->nulls, (capacity + 7) / 8);
+      memset(buffer->nulls + ((buffer->capacity + 7) / 8), 0,
+             ((capacity + 7) / 8) - ((buffer->capacity + 7) / 8));
+      
+      if (type == COLUMN_STRING) {
+        buffer->offsets = (int32_t *) realloc(buffer->offsets, (capacity + 1) * sizeof(int32_t));
+        buffer->offsets[0] = 0;
       }
-    default :
-      Local<String> str;
-      int count = 0;
       
-      do {
-        ret = SQLGetData(
-          hStmt,
-          column.index,
-          SQL_C_TCHAR,
-          (char *) buffer,
-          bufferLength,
-          &len);
-
-        DEBUG_PRINTF("ODBC::GetColumnValue - String: index=%i name=%s type=%i len=%i value=%s ret=%i bufferLength=%i\n", 
-                      column.index, column.name, column.type, len,(char *) buffer, ret, bufferLength);
-
-        if (len == SQL_NULL_DATA && str.IsEmpty()) {
-          return NanEscapeScope(NanNull());
-          //return Null();
-        }
+      buffer->capacity = capacity;
+    }
+    
+    if (isNull) {
+      buffer->nulls[buffer->count / 8] |= (1 << (buffer->count % 8));
+    }
+    
+    switch (type) {
+      case COLUMN_INT32 : {
+        int32_t value = isNull ? 0 : row[i].intValue;
         
-        if (SQL_NO_DATA == ret) {
-          //we have captured all of the data
-          //double check that we have some data else return null
-          if (str.IsEmpty()){
-            return NanEscapeScope(NanNull());
-          }
-
-          break;
+        ReserveColumnValues(buffer, sizeof(int32_t));
+        memcpy(buffer->values + buffer->valuesLength, &value, sizeof(int32_t));
+        buffer->valuesLength += sizeof(int32_t);
+      } break;
+      case COLUMN_DOUBLE :
+      case COLUMN_DATE : {
+        double value = 0;
+        
+        if (!isNull && type == COLUMN_DOUBLE) {
+          value = row[i].doubleValue;
         }
-        else if (SQL_SUCCEEDED(ret)) {
-          //we have not captured all of the data yet
+        else if (!isNull) {
+#ifdef _WIN32
+          //don't let the Date handles pile up over a large result
+          NanScope();
           
-          if (count == 0) {
-            //no concatenation required, this is our first pass
-#ifdef UNICODE
-            str = NanNew((uint16_t*) buffer);
-#else
-            str = NanNew((char *) buffer);
-#endif
-          }
-          else {
-            //we need to concatenate
-#ifdef UNICODE
-            str = String::Concat(str, NanNew((uint16_t*) buffer));
+          Column column = columns[i];
+          column.dateMode = DATE_NUMBER;
+          
+          value = GetColumnValue(column, &row[i])->NumberValue();
 #else
-            str = String::Concat(str, NanNew((char *) buffer));
+          value = GetTimestampEpoch(&row[i].timestampValue);
 #endif
-          }
+        }
+        
+        ReserveColumnValues(buffer, sizeof(double));
+        memcpy(buffer->values + buffer->valuesLength, &value, sizeof(double));
+        buffer->valuesLength += sizeof(double);
+      } break;
+      case COLUMN_BOOLEAN :
+        ReserveColumnValues(buffer, 1);
+        buffer->values[buffer->valuesLength++] = (!isNull && row[i].bitValue) ? 1 : 0;
+        break;
+      default :
+        if (!isNull && GetColumnType(columns[i]) == SQL_EXACT_BIGINT) {
+          //kept as its decimal digits, like exact NUMERIC/DECIMAL values
+          char digits[24];
           
-          //if len is zero let's break out of the loop now and not attempt to
-          //call SQLGetData again. The specific reason for this is because
-          //some ODBC drivers may not correctly report SQL_NO_DATA the next
-          //time around causing an infinite loop here
-          if (len == 0) {
-            break;
-          }
+          FormatBigInt(row[i].bigintValue, digits);
+          
+          size_t length = strlen(digits);
           
-          count += 1;
+          ReserveColumnValues(buffer, length * sizeof(SQLTCHAR));
+          
+          for (size_t j = 0; j < length; j++) {
+            SQLTCHAR c = (SQLTCHAR) digits[j];
+            
+            memcpy(buffer->values + buffer->valuesLength, &c, sizeof(SQLTCHAR));
+            buffer->valuesLength += sizeof(SQLTCHAR);
+          }
         }
-        else {
-          //an error has occured
-          //possible values for ret are SQL_ERROR (-1) and SQL_INVALID_HANDLE (-2)
-
-          //If we have an invalid handle, then stuff is way bad and we should abort
-          //immediately. Memory errors are bound to follow as we must be in an
-          //inconsisant state.
-          assert(ret != SQL_INVALID_HANDLE);
-
-          //Not sure if throwing here will work out well for us but we can try
-          //since we should have a valid handle and the error is something we 
-          //can look into
-          NanThrowError(ODBC::GetSQLError(
-             SQL_HANDLE_STMT,
-             hStmt,
-             (char *) "[node-odbc] Error in ODBC::GetColumnValue"
-           ));
-          return NanEscapeScope(NanUndefined());
-          break;
+        else if (!isNull) {
+          ReserveColumnValues(buffer, row[i].len);
+          memcpy(buffer->values + buffer->valuesLength, row[i].data, row[i].len);
+          buffer->valuesLength += row[i].len;
         }
-      } while (true);
-      
-      return NanEscapeScope(str);
+        
+        buffer->offsets[buffer->count + 1] = (int32_t) buffer->valuesLength;
+        break;
+    }
+    
+    buffer->count++;
   }
 }
 
 /*
- * GetRecordTuple
+ * GetColumnBuffersObject
+ *
+ * Build the FETCH_COLUMNS result: an object with one key per column whose
+ * value holds the column as a typed array (`values`) and a null bitmap
+ * (`nulls`). String columns have all of their bytes in a Buffer with
+ * `offsets` giving the start of each value and the end of the last one.
  */
 
-Local<Object> ODBC::GetRecordTuple ( SQLHSTMT hStmt, Column* columns, 
-                                         short* colCount, uint16_t* buffer,
-                                         int bufferLength) {
+Local<Object> ODBC::GetColumnBuffersObject(ColumnBuffer* buffers, ColumnCache* cache) {
   NanEscapableScope();
   
-  Local<Object> tuple = NanNew<Object>();
+  Local<Object> result = NanNew<Object>();
+  
+  Persistent<String>* names = GetColumnNames(cache);
+  
+  for (int i = 0; i < cache->colCount; i++) {
+    ColumnBuffer* buffer = &buffers[i];
+    Local<Object> column = NanNew<Object>();
+    
+    switch (GetColumnBufferType(GetColumnType(cache->columns[i]))) {
+      case COLUMN_INT32 :
+        column->Set(NanNew("type"), NanNew("int32"));
+        column->Set(NanNew("values"), 
+          NewTypedArray("Int32Array", buffer->values, buffer->count, sizeof(int32_t)));
+        break;
+      case COLUMN_DOUBLE :
+        column->Set(NanNew("type"), NanNew("float64"));
+        column->Set(NanNew("values"), 
+          NewTypedArray("Float64Array", buffer->values, buffer->count, sizeof(double)));
+        break;
+      case COLUMN_DATE :
+        column->Set(NanNew("type"), NanNew("date"));
+        column->Set(NanNew("values"), 
+          NewTypedArray("Float64Array", buffer->values, buffer->count, sizeof(double)));
+        break;
+      case COLUMN_BOOLEAN :
+        column->Set(NanNew("type"), NanNew("boolean"));
+        column->Set(NanNew("values"), 
+          NewTypedArray("Uint8Array", buffer->values, buffer->count, 1));
+        break;
+      default : {
+        int32_t empty = 0;
+        bool binary = IsBinaryColumn(cache->columns[i]);
+        
+        column->Set(NanNew("type"), NanNew(binary ? "binary" : "string"));
+        column->Set(NanNew("values"), 
+          NanNewBufferHandle((char *) buffer->values, (uint32_t) buffer->valuesLength));
+        column->Set(NanNew("offsets"), 
+          NewTypedArray("Int32Array", 
+            (buffer->offsets != NULL) ? buffer->offsets : &empty,
+            buffer->count + 1, sizeof(int32_t)));
+        
+        if (binary) {
+          break;
+        }
         
-  for(int i = 0; i < *colCount; i++) {
 #ifdef UNICODE
-    tuple->Set( NanNew((uint16_t *) columns[i].name),
-                GetColumnValue( hStmt, columns[i], buffer, bufferLength));
+        column->Set(NanNew("encoding"), NanNew("utf16le"));
 #else
-    tuple->Set( NanNew((const char *) columns[i].name),
-                GetColumnValue( hStmt, columns[i], buffer, bufferLength));
+        column->Set(NanNew("encoding"), NanNew("utf8"));
 #endif
+      } break;
+    }
+    
+    column->Set(NanNew("nulls"), 
+      NewTypedArray("Uint8Array", buffer->nulls, (buffer->count + 7) / 8, 1));
+    
+    result->Set(NanNew(names[i]), column);
   }
   
-  return NanEscapeScope(tuple);
+  return NanEscapeScope(result);
 }
 
 /*
- * GetRecordArray
+ * FreeColumnBuffers
  */
 
-Handle<Value> ODBC::GetRecordArray ( SQLHSTMT hStmt, Column* columns, 
-                                         short* colCount, uint16_t* buffer,
-                                         int bufferLength) {
-  NanEscapableScope();
+void ODBC::FreeColumnBuffers(ColumnBuffer* buffers, short colCount) {
+  DEBUG_PRINTF("ODBC::FreeColumnBuffers\n");
   
-  Local<Array> array = NanNew<Array>();
-        
-  for(int i = 0; i < *colCount; i++) {
-    array->Set( NanNew(i),
-                GetColumnValue( hStmt, columns[i], buffer, bufferLength));
+  for (int i = 0; i < colCount; i++) {
+    free(buffers[i].values);
+    free(buffers[i].offsets);
+    free(buffers[i].nulls);
   }
   
-  return NanEscapeScope(array);
+  free(buffers);
 }
 
 /*
- * GetParametersFromArray
+ * NewPromiseCallback
+ *
+ * Create a Promise and a native function to pass on as the callback of an
+ * async method in its place. The function settles the Promise from the node
+ * style (err, value) arguments it is called with by the UV_After* callback,
+ * so no JavaScript closure is involved. Returns false when this version of
+ * V8 has no Promise support.
  */
 
-Parameter* ODBC::GetParametersFromArray (Local<Array> values, int *paramCount) {
-  DEBUG_PRINTF("ODBC::GetParametersFromArray\n");
-  *paramCount = values->Length();
+bool ODBC::NewPromiseCallback(Local<Function>* cb, Local<Value>* promise) {
+#ifdef NODE_ODBC_PROMISE
+  Local<Context> context = NanGetCurrentContext();
+  Local<Promise::Resolver> resolver;
   
-  Parameter* params = NULL;
+  if (!Promise::Resolver::New(context).ToLocal(&resolver)) {
+    return false;
+  }
   
-  if (*paramCount > 0) {
-    params = (Parameter *) malloc(*paramCount * sizeof(Parameter));
+  if (!Function::New(context, SettlePromise, resolver).ToLocal(cb)) {
+    return false;
   }
   
-  for (int i = 0; i < *paramCount; i++) {
-    Local<Value> value = values->Get(i);
-    
-    params[i].ColumnSize       = 0;
-    params[i].StrLen_or_IndPtr = SQL_NULL_DATA;
-    params[i].BufferLength     = 0;
-    params[i].DecimalDigits    = 0;
-
-    DEBUG_PRINTF("ODBC::GetParametersFromArray - &param[%i].length = %X\n",
-                 i, &params[i].StrLen_or_IndPtr);
-
-    if (value->IsString()) {
-      Local<String> string = value->ToString();
-      int length = string->Length();
-      
-      params[i].ValueType         = SQL_C_TCHAR;
-      params[i].ColumnSize        = 0; //SQL_SS_LENGTH_UNLIMITED 
-#ifdef UNICODE
-      params[i].ParameterType     = SQL_WVARCHAR;
-      params[i].BufferLength      = (length * sizeof(uint16_t)) + sizeof(uint16_t);
-#else
-      params[i].ParameterType     = SQL_VARCHAR;
-      params[i].BufferLength      = string->Utf8Length() + 1;
-#endif
-      params[i].ParameterValuePtr = malloc(params[i].BufferLength);
-      params[i].StrLen_or_IndPtr  = SQL_NTS;//params[i].BufferLength;
-
-#ifdef UNICODE
-      string->Write((uint16_t *) params[i].ParameterValuePtr);
+  *promise = resolver->GetPromise();
+  
+  return true;
 #else
-      string->WriteUtf8((char *) params[i].ParameterValuePtr);
+  return false;
 #endif
+}
 
-      DEBUG_PRINTF("ODBC::GetParametersFromArray - IsString(): params[%i] c_type=%i type=%i buffer_length=%i size=%i length=%i value=%s\n",
-                    i, params[i].ValueType, params[i].ParameterType,
-                    params[i].BufferLength, params[i].ColumnSize, params[i].StrLen_or_IndPtr, 
-                    (char*) params[i].ParameterValuePtr);
-    }
-    else if (value->IsNull()) {
-      params[i].ValueType = SQL_C_DEFAULT;
-      params[i].ParameterType   = SQL_VARCHAR;
-      params[i].StrLen_or_IndPtr = SQL_NULL_DATA;
+#ifdef NODE_ODBC_PROMISE
+/*
+ * SettlePromise
+ *
+ * The callback created by NewPromiseCallback: reject with err, or resolve
+ * with value. Any further arguments are dropped.
+ */
 
-      DEBUG_PRINTF("ODBC::GetParametersFromArray - IsNull(): params[%i] c_type=%i type=%i buffer_length=%i size=%i length=%i\n",
-                   i, params[i].ValueType, params[i].ParameterType,
-                   params[i].BufferLength, params[i].ColumnSize, params[i].StrLen_or_IndPtr);
-    }
-    else if (value->IsInt32()) {
-      int64_t  *number = new int64_t(value->IntegerValue());
-      params[i].ValueType = SQL_C_SBIGINT;
-      params[i].ParameterType   = SQL_BIGINT;
-      params[i].ParameterValuePtr = number;
-      params[i].StrLen_or_IndPtr = 0;
-      
-      DEBUG_PRINTF("ODBC::GetParametersFromArray - IsInt32(): params[%i] c_type=%i type=%i buffer_length=%i size=%i length=%i value=%lld\n",
-                    i, params[i].ValueType, params[i].ParameterType,
-                    params[i].BufferLength, params[i].ColumnSize, params[i].StrLen_or_IndPtr,
-                    *number);
-    }
-    else if (value->IsNumber()) {
-      double *number   = new double(value->NumberValue());
-      
-      params[i].ValueType         = SQL_C_DOUBLE;
-      params[i].ParameterType     = SQL_DECIMAL;
-      params[i].ParameterValuePtr = number;
-      params[i].BufferLength      = sizeof(double);
-      params[i].StrLen_or_IndPtr  = params[i].BufferLength;
-      params[i].DecimalDigits     = 7;
-      params[i].ColumnSize        = sizeof(double);
-
-      DEBUG_PRINTF("ODBC::GetParametersFromArray - IsNumber(): params[%i] c_type=%i type=%i buffer_length=%i size=%i length=%i value=%f\n",
-                    i, params[i].ValueType, params[i].ParameterType,
-                    params[i].BufferLength, params[i].ColumnSize, params[i].StrLen_or_IndPtr,
-		                *number);
-    }
-    else if (value->IsBoolean()) {
-      bool *boolean = new bool(value->BooleanValue());
-      params[i].ValueType         = SQL_C_BIT;
-      params[i].ParameterType     = SQL_BIT;
-      params[i].ParameterValuePtr = boolean;
-      params[i].StrLen_or_IndPtr  = 0;
-      
-      DEBUG_PRINTF("ODBC::GetParametersFromArray - IsBoolean(): params[%i] c_type=%i type=%i buffer_length=%i size=%i length=%i\n",
-                   i, params[i].ValueType, params[i].ParameterType,
-                   params[i].BufferLength, params[i].ColumnSize, params[i].StrLen_or_IndPtr);
+NAN_METHOD(ODBC::SettlePromise) {
+  NanScope();
+  
+  Local<Promise::Resolver> resolver = Local<Promise::Resolver>::Cast(args.Data());
+  Local<Context> context = NanGetCurrentContext();
+  
+  if (args.Length() > 0 && !args[0]->IsNull() && !args[0]->IsUndefined()) {
+    resolver->Reject(context, args[0]).FromMaybe(false);
+  }
+  else {
+    Local<Value> value = NanUndefined();
+    
+    if (args.Length() > 1) {
+      value = args[1];
     }
-  } 
+    
+    resolver->Resolve(context, value).FromMaybe(false);
+  }
   
-  return params;
+  NanReturnUndefined();
 }
+#endif
 
 /*
  * CallbackSQLError
@@ -979,6 +3748,11 @@ NAN_METHOD(ODBC::LoadODBCLibrary) {
 #endif
 
 extern "C" void init(v8::Handle<Object> exports) {
+  exports->Set(NanNew("setGlobalLock"),
+        NanNew<FunctionTemplate>(ODBC::SetGlobalLock)->GetFunction());
+  exports->Set(NanNew("setWorkerThreads"),
+        NanNew<FunctionTemplate>(ODBC::SetWorkerThreads)->GetFunction());
+  
 #ifdef dynodbc
   exports->Set(NanNew("loadODBCLibrary"),
         NanNew<FunctionTemplate>(ODBC::LoadODBCLibrary)->GetFunction());
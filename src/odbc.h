@@ -36,9 +36,25 @@
 using namespace v8;
 using namespace node;
 
+//BigInt values are only available from V8 6.7 (node 10.4)
+#if defined(V8_MAJOR_VERSION) && (V8_MAJOR_VERSION > 6 || (V8_MAJOR_VERSION == 6 && V8_MINOR_VERSION >= 7))
+#define NODE_ODBC_BIGINT
+#endif
+
+//async methods called without a callback return a native Promise, which
+//needs the context based Promise::Resolver API of V8 5.0. nan 1.8 doesn't
+//build against V8 5, so this stays off until the nan dependency moves on
+#if defined(V8_MAJOR_VERSION) && V8_MAJOR_VERSION >= 5
+#define NODE_ODBC_PROMISE
+#endif
+
 #define MAX_FIELD_SIZE 1024
 #define MAX_VALUE_SIZE 1048576
 
+//string values at least this many bytes long are handed to V8 as external
+//strings over the native buffer they were read into instead of being copied
+#define EXTERNAL_STRING_MIN_BYTES 65536
+
 #ifdef UNICODE
 #define ERROR_MESSAGE_BUFFER_BYTES 2048
 #define ERROR_MESSAGE_BUFFER_CHARS 1024
@@ -51,16 +67,113 @@ using namespace node;
 #define MODE_CALLBACK_FOR_EACH 2
 #define FETCH_ARRAY 3
 #define FETCH_OBJECT 4
+#define FETCH_COLUMNS 5
+#define DATE_OBJECT 1
+#define DATE_NUMBER 2
+#define DATE_STRING 3
 #define SQL_DESTROY 9999
 
+//pseudo SQL types ODBC::GetColumnType reports for columns fetched with
+//exactNumbers: BIGINT is read as SQL_C_SBIGINT, NUMERIC/DECIMAL as text
+#define SQL_EXACT_BIGINT 9998
+#define SQL_EXACT_DECIMAL 9997
+
+//number of rows fetched on the worker thread per fetchAll work request
+#define DEFAULT_CHUNK_SIZE 1000
+
+//longest character column (in characters) that will be bound with
+//SQLBindCol for block cursor fetches. Longer columns use SQLGetData.
+#define MAX_BOUND_COLUMN_CHARS 2048
+
+//SQLGetData scratch buffers are handed out in power of two size classes
+//from BUFFER_POOL_MIN_SIZE up to MAX_VALUE_SIZE and kept for reuse
+#define BUFFER_POOL_MIN_SIZE 4096
+#define BUFFER_POOL_CLASSES 9
+#define BUFFER_POOL_MAX_FREE 8
+
+//statement handles a connection keeps for reuse by query/querySync
+#define STATEMENT_POOL_SIZE 8
+
+//ODBC 3.8 connection reset used by ODBCConnection::Reset; older driver
+//manager headers don't define it
+#ifndef SQL_ATTR_RESET_CONNECTION
+#define SQL_ATTR_RESET_CONNECTION 116
+#endif
+
+#ifndef SQL_RESET_CONNECTION_YES
+#define SQL_RESET_CONNECTION_YES 1UL
+#endif
+
 
 typedef struct {
   unsigned char *name;
   unsigned int len;
   SQLLEN type;
+  //read by GetColumnOctetLength the first time it is needed
+  SQLLEN octetLength;
+  bool hasOctetLength;
   SQLUSMALLINT index;
+  //how timestamp values are returned: DATE_OBJECT, DATE_NUMBER or DATE_STRING
+  int dateMode;
+  //read BIGINT as a 64 bit integer and NUMERIC/DECIMAL as a decimal string
+  //instead of converting them to double
+  bool exactNumbers;
 } Column;
 
+//column descriptors of a result set. A prepared statement shares them by
+//reference count with the results it produces so that repeated executions
+//skip the describe phase. names (internalized strings) and rowTemplate, from
+//which every FETCH_OBJECT row is created so that all rows share one hidden
+//class, are built on the event loop thread the first time they are needed.
+typedef struct {
+  Column *columns;
+  short colCount;
+  int refCount;
+  Persistent<String> *names;
+  Persistent<ObjectTemplate> rowTemplate;
+} ColumnCache;
+
+//native copy of a single column value, filled by SQLGetData on the worker
+//thread and turned into a V8 value later on the event loop thread
+typedef struct {
+  SQLLEN len;
+  union {
+    int32_t intValue;
+    int64_t bigintValue;
+    double doubleValue;
+    bool bitValue;
+#ifndef _WIN32
+    SQL_TIMESTAMP_STRUCT timestampValue;
+#endif
+  };
+  unsigned char *data;
+} ColumnData;
+
+//growable per column storage used by FETCH_COLUMNS. values holds packed
+//int32/double/uint8 values, or the concatenated bytes of every string with
+//offsets marking where each one starts. A set bit in nulls marks a null row.
+typedef struct {
+  unsigned char *values;
+  size_t valuesLength;
+  size_t valuesCapacity;
+  int32_t *offsets;
+  unsigned char *nulls;
+  int count;
+  int capacity;
+} ColumnBuffer;
+
+//column-wise row array bound with SQLBindCol for block cursor fetches. A
+//bufferLength of zero means that the column is not bound. canUnbind tells
+//whether the column can be unbound and read with SQLGetData instead when a
+//value does not fit.
+typedef struct {
+  SQLSMALLINT cType;
+  SQLLEN bufferLength;
+  unsigned char *buffer;
+  SQLLEN *indicators;
+  bool canUnbind;
+} BoundColumn;
+
 typedef struct {
   SQLSMALLINT  ValueType;
   SQLSMALLINT  ParameterType;
@@ -71,18 +184,137 @@ typedef struct {
   SQLLEN       StrLen_or_IndPtr;
 } Parameter;
 
+//SQL type of a parameter marker as reported by SQLDescribeParam, or given
+//explicitly with a { type, precision, scale, value } parameter
+typedef struct {
+  SQLSMALLINT  DataType;
+  SQLULEN      ParameterSize;
+  SQLSMALLINT  DecimalDigits;
+} ParameterDescription;
+
+//column-wise array of parameter values used to execute a statement for
+//many rows at once with SQL_ATTR_PARAMSET_SIZE. ParameterValuePtr holds
+//one BufferLength sized element per row.
+typedef struct {
+  SQLSMALLINT  ValueType;
+  SQLSMALLINT  ParameterType;
+  SQLLEN       ColumnSize;
+  SQLSMALLINT  DecimalDigits;
+  void        *ParameterValuePtr;
+  SQLLEN       BufferLength;
+  SQLLEN      *StrLen_or_IndPtr;
+} ParameterArray;
+
+typedef struct {
+  uint16_t *buffers[BUFFER_POOL_CLASSES][BUFFER_POOL_MAX_FREE];
+  int freeCount[BUFFER_POOL_CLASSES];
+  double bytesInUse;
+  double bytesPooled;
+  int buffersInUse;
+  int allocations;
+} BufferPool;
+
+//free list of statement handles owned by a connection. Results made by
+//ODBCConnection::Query hold a reference so that they can hand their handle
+//back when they are closed; once the connection closes the pool only frees.
+typedef struct {
+  uv_mutex_t mutex;
+  HDBC hDBC;
+  HSTMT handles[STATEMENT_POOL_SIZE];
+  int count;
+  int refCount;
+  bool closed;
+  double hits;
+  double misses;
+} StatementPool;
+
+//a unit of work submitted to the module's own worker threads
+typedef struct WorkItem {
+  uv_work_t *req;
+  uv_work_cb work;
+  uv_after_work_cb after;
+  struct WorkItem *next;
+} WorkItem;
+
+//worker threads that run ODBC work instead of the libuv threadpool once
+//setWorkerThreads() has been called. pending items wait for a thread, done
+//items wait for the event loop; both lists are guarded by g_workerMutex.
+//threadCount and outstanding are only touched on the event loop thread.
+typedef struct {
+  WorkItem *pendingHead;
+  WorkItem *pendingTail;
+  WorkItem *doneHead;
+  WorkItem *doneTail;
+  int threadCount;
+  int outstanding;
+} WorkerPool;
+
 class ODBC : public node::ObjectWrap {
   public:
     static Persistent<Function> constructor;
+    //serializes environment and connection handle allocation. Connecting
+    //and statement handle management only take it through GlobalLock()
+    //when g_globalLock has been turned on for drivers that aren't thread safe.
+    //g_globalLock is read by worker threads without the mutex and only
+    //written while holding it.
     static uv_mutex_t g_odbcMutex;
+    static volatile bool g_globalLock;
     static uv_async_t g_async;
+    static uv_mutex_t g_bufferPoolMutex;
+    static BufferPool g_bufferPool;
+    static uv_mutex_t g_workerMutex;
+    static uv_cond_t g_workerCond;
+    static uv_async_t g_workerAsync;
+    static WorkerPool g_workerPool;
     
     static void Init(v8::Handle<Object> exports);
+    static bool GlobalLock();
+    static void GlobalUnlock(bool locked);
+    static NAN_METHOD(SetGlobalLock);
+    static int QueueWork(uv_work_t* req, uv_work_cb work, uv_after_work_cb after);
+    static void WorkerThread(void* arg);
+    static NAUV_WORK_CB(WorkerDone);
+    static NAN_METHOD(SetWorkerThreads);
     static Column* GetColumns(SQLHSTMT hStmt, short* colCount);
     static void FreeColumns(Column* columns, short* colCount);
+    static ColumnCache* CreateColumnCache(Column* columns, short colCount);
+    static void ReleaseColumnCache(ColumnCache* cache);
+    static Persistent<String>* GetColumnNames(ColumnCache* cache);
+    static SQLLEN GetColumnOctetLength(SQLHSTMT hStmt, Column* column);
+    static int GetBufferLength(SQLHSTMT hStmt, Column* columns, short* colCount);
+    static uint16_t* AcquireBuffer(int minLength, int* bufferLength);
+    static void ReleaseBuffer(uint16_t* buffer, int bufferLength);
+    static StatementPool* CreateStatementPool(HDBC hDBC);
+    static void RetainStatementPool(StatementPool* pool);
+    static void ReleaseStatementPool(StatementPool* pool);
+    static void CloseStatementPool(StatementPool* pool);
+    static SQLRETURN AllocStatement(StatementPool* pool, HSTMT* hSTMT);
+    static void FreeStatement(StatementPool* pool, HSTMT hSTMT);
+    static Local<Object> GetStatementPoolStats(StatementPool* pool);
     static Handle<Value> GetColumnValue(SQLHSTMT hStmt, Column column, uint16_t* buffer, int bufferLength);
+    static Handle<Value> GetColumnValue(Column column, ColumnData* data);
+    static bool IsBinaryColumn(Column column);
+    static int GetColumnType(Column column);
+    static void FreeColumnValue(char* data, void* hint);
+    static double GetTimestampEpoch(SQL_TIMESTAMP_STRUCT* timestamp);
+    static void FormatTimestampEpoch(double epoch, char* buffer);
+    static bool GetTimestampFromEpoch(double epoch, SQL_TIMESTAMP_STRUCT* timestamp);
+    static SQLRETURN GetColumnData(SQLHSTMT hStmt, Column column, ColumnData* data, uint16_t* buffer, int bufferLength);
+    static void FreeColumnData(ColumnData* data, int count);
+    static SQLRETURN GetRecordData (SQLHSTMT hStmt, Column* columns, short* colCount, ColumnData* row, uint16_t* buffer, int bufferLength);
+    static BoundColumn* BindColumns (HDBC hDBC, SQLHSTMT hStmt, Column* columns, short* colCount, SQLULEN rowArraySize, SQLULEN* rowsFetched, SQLUSMALLINT* rowStatus);
+    static void UnbindColumns (SQLHSTMT hStmt, BoundColumn* boundColumns, short* colCount);
+    static SQLRETURN GetBoundRecordData (SQLHSTMT hStmt, Column* columns, short* colCount, BoundColumn* boundColumns, SQLULEN rowIndex, ColumnData* row, uint16_t* buffer, int bufferLength);
     static Local<Object> GetRecordTuple (SQLHSTMT hStmt, Column* columns, short* colCount, uint16_t* buffer, int bufferLength);
+    static Local<Object> GetRecordTuple (SQLHSTMT hStmt, ColumnCache* cache, uint16_t* buffer, int bufferLength);
+    static Local<Object> GetRecordTuple (ColumnCache* cache, ColumnData* row);
     static Handle<Value> GetRecordArray (SQLHSTMT hStmt, Column* columns, short* colCount, uint16_t* buffer, int bufferLength);
+    static Handle<Value> GetRecordArray (Column* columns, short* colCount, ColumnData* row);
+    static ColumnBuffer* CreateColumnBuffers(short colCount);
+    static void AppendColumnData(ColumnBuffer* buffers, Column* columns, short* colCount, ColumnData* row);
+    static Local<Object> GetColumnBuffersObject(ColumnBuffer* buffers, ColumnCache* cache);
+    static void FreeColumnBuffers(ColumnBuffer* buffers, short colCount);
+    static bool NewPromiseCallback(Local<Function>* cb, Local<Value>* promise);
     static Handle<Value> CallbackSQLError(SQLSMALLINT handleType, SQLHANDLE handle, NanCallback* cb);
     static Handle<Value> CallbackSQLError (SQLSMALLINT handleType, SQLHANDLE handle, char* message, NanCallback* cb);
     static Local<Object> GetSQLError (SQLSMALLINT handleType, SQLHANDLE handle);
@@ -91,7 +323,22 @@ class ODBC : public node::ObjectWrap {
 #ifdef dynodbc
     static NAN_METHOD(LoadODBCLibrary);
 #endif
-    static Parameter* GetParametersFromArray (Local<Array> values, int* paramCount);
+#ifdef NODE_ODBC_PROMISE
+    static NAN_METHOD(SettlePromise);
+#endif
+    static Parameter* GetParametersFromArray (Local<Array> values, int* paramCount,
+                                              ParameterDescription* descriptions = NULL,
+                                              int descriptionCount = 0);
+    static void GetParameterFromValue (Local<Value> value, Parameter* param, int index,
+                                       ParameterDescription* description = NULL);
+    static bool SetParameterValue (Local<Value> value, Parameter* param);
+    static void FreeParameter (Parameter* param);
+    static ParameterArray* GetParameterArraysFromRows (Local<Array> rows, int* paramCount, int* rowCount);
+    static void FreeParameterArrays (ParameterArray* params, int paramCount);
+    static SQLRETURN ExecuteParameterArrays (SQLHSTMT hStmt, ParameterArray* params, int paramCount, int rowCount, SQLUSMALLINT* rowStatus, SQLLEN* affectedRows);
+    static SQLRETURN ExecuteParameterRows (SQLHSTMT hStmt, ParameterArray* params, int paramCount, int rowCount, SQLUSMALLINT* rowStatus, SQLLEN* affectedRows);
+    static void UnbindParameterArrays (SQLHSTMT hStmt);
+    static Local<Object> GetParameterArrayStatus (SQLUSMALLINT* rowStatus, int rowCount, SQLLEN affectedRows);
     
     void Free();
     
@@ -111,6 +358,7 @@ class ODBC : public node::ObjectWrap {
     
     //sync methods
     static NAN_METHOD(CreateConnectionSync);
+    static NAN_METHOD(GetBufferStats);
     
     ODBC *self(void) { return this; }
 
@@ -220,6 +468,19 @@ struct query_request {
     return NanThrowTypeError("Argument " #I " must be a function");     \
   Local<Function> VAR = Local<Function>::Cast(args[I]);
 
+//Callback Argument or, when it is missing, a Promise that VAR settles. PROMISE
+//is undefined when a callback was given and is what the method returns.
+#define REQ_FUN_OR_PROMISE_ARG(I, VAR, PROMISE)                         \
+  Local<Function> VAR;                                                  \
+  Local<Value> PROMISE = NanUndefined();                                \
+  if (args.Length() > (I) && args[I]->IsFunction()) {                   \
+    VAR = Local<Function>::Cast(args[I]);                               \
+  }                                                                     \
+  else if ((args.Length() > (I) && !args[I]->IsUndefined())             \
+           || !ODBC::NewPromiseCallback(&VAR, &PROMISE)) {              \
+    return NanThrowTypeError("Argument " #I " must be a function");     \
+  }
+
 #define REQ_BOOL_ARG(I, VAR)                                            \
   if (args.Length() <= (I) || !args[I]->IsBoolean())                    \
     return NanThrowTypeError("Argument " #I " must be a boolean");      \
@@ -230,6 +491,11 @@ struct query_request {
     return NanThrowTypeError("Argument " #I " invalid");                \
   Local<External> VAR = Local<External>::Cast(args[I]);
 
+#define REQ_INT_ARG(I, VAR)                                             \
+  if (args.Length() <= (I) || !args[I]->IsInt32())                      \
+    return NanThrowTypeError("Argument " #I " must be an integer");     \
+  int VAR = args[I]->Int32Value();
+
 #define OPT_INT_ARG(I, VAR, DEFAULT)                                    \
   int VAR;                                                              \
   if (args.Length() <= (I)) {                                           \
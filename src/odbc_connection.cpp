@@ -34,6 +34,7 @@ Persistent<Function> ODBCConnection::constructor;
 Persistent<String> ODBCConnection::OPTION_SQL;
 Persistent<String> ODBCConnection::OPTION_PARAMS;
 Persistent<String> ODBCConnection::OPTION_NORESULTS;
+Persistent<String> ODBCConnection::OPTION_TIMEOUT;
 
 void ODBCConnection::Init(v8::Handle<Object> exports) {
   DEBUG_PRINTF("ODBCConnection::Init\n");
@@ -42,6 +43,7 @@ void ODBCConnection::Init(v8::Handle<Object> exports) {
   NanAssignPersistent(OPTION_SQL, NanNew<String>("sql"));
   NanAssignPersistent(OPTION_PARAMS, NanNew<String>("params"));
   NanAssignPersistent(OPTION_NORESULTS, NanNew<String>("noResults"));
+  NanAssignPersistent(OPTION_TIMEOUT, NanNew<String>("timeout"));
 
   Local<FunctionTemplate> constructor_template = NanNew<FunctionTemplate>(New);
 
@@ -73,6 +75,11 @@ void ODBCConnection::Init(v8::Handle<Object> exports) {
   NODE_SET_PROTOTYPE_METHOD(constructor_template, "endTransaction", EndTransaction);
   NODE_SET_PROTOTYPE_METHOD(constructor_template, "endTransactionSync", EndTransactionSync);
   
+  NODE_SET_PROTOTYPE_METHOD(constructor_template, "reset", Reset);
+  NODE_SET_PROTOTYPE_METHOD(constructor_template, "resetSync", ResetSync);
+  NODE_SET_PROTOTYPE_METHOD(constructor_template, "getStatementStats", GetStatementStats);
+  NODE_SET_PROTOTYPE_METHOD(constructor_template, "cancel", Cancel);
+  
   NODE_SET_PROTOTYPE_METHOD(constructor_template, "columns", Columns);
   NODE_SET_PROTOTYPE_METHOD(constructor_template, "tables", Tables);
   
@@ -84,20 +91,43 @@ void ODBCConnection::Init(v8::Handle<Object> exports) {
 ODBCConnection::~ODBCConnection() {
   DEBUG_PRINTF("ODBCConnection::~ODBCConnection\n");
   this->Free();
+  
+  uv_mutex_destroy(&m_activeMutex);
 }
 
 void ODBCConnection::Free() {
   DEBUG_PRINTF("ODBCConnection::Free\n");
+  if (m_statementPool) {
+    //pooled statements have to go before the connection does
+    ODBC::CloseStatementPool(m_statementPool);
+    ODBC::ReleaseStatementPool(m_statementPool);
+    
+    m_statementPool = NULL;
+  }
+  
   if (m_hDBC) {
     uv_mutex_lock(&ODBC::g_odbcMutex);
     
-    if (m_hDBC) {
-      SQLDisconnect(m_hDBC);
-      SQLFreeHandle(SQL_HANDLE_DBC, m_hDBC);
-      m_hDBC = NULL;
-    }
+    //take the handle so that a second Free() finds nothing to do
+    HDBC hDBC = m_hDBC;
+    m_hDBC = NULL;
     
     uv_mutex_unlock(&ODBC::g_odbcMutex);
+    
+    if (hDBC) {
+      bool locked = ODBC::GlobalLock();
+      
+      SQLDisconnect(hDBC);
+      
+      ODBC::GlobalUnlock(locked);
+      
+      //freeing the connection handle touches the environment
+      uv_mutex_lock(&ODBC::g_odbcMutex);
+      
+      SQLFreeHandle(SQL_HANDLE_DBC, hDBC);
+      
+      uv_mutex_unlock(&ODBC::g_odbcMutex);
+    }
   }
 }
 
@@ -119,6 +149,10 @@ NAN_METHOD(ODBCConnection::New) {
   
   conn->Wrap(args.Holder());
   
+  conn->m_statementPool = ODBC::CreateStatementPool(hDBC);
+  
+  uv_mutex_init(&conn->m_activeMutex);
+  
   //set default connectTimeout to 0 seconds
   conn->connectTimeout = 0;
   //set default loginTimeout to 5 seconds
@@ -182,7 +216,7 @@ NAN_METHOD(ODBCConnection::Open) {
   NanScope();
 
   REQ_STRO_ARG(0, connection);
-  REQ_FUN_ARG(1, cb);
+  REQ_FUN_OR_PROMISE_ARG(1, cb, promise);
 
   //get reference to the connection object
   ODBCConnection* conn = ObjectWrap::Unwrap<ODBCConnection>(args.Holder());
@@ -211,13 +245,16 @@ NAN_METHOD(ODBCConnection::Open) {
   work_req->data = data;
   
   //queue the work
-  uv_queue_work(uv_default_loop(), 
-    work_req, 
+  ODBC::QueueWork(work_req, 
     UV_Open, 
     (uv_after_work_cb)UV_AfterOpen);
 
   conn->Ref();
 
+  if (!promise->IsUndefined()) {
+    NanReturnValue(promise);
+  }
+  
   NanReturnValue(args.Holder());
 }
 
@@ -229,10 +266,9 @@ void ODBCConnection::UV_Open(uv_work_t* req) {
 
   DEBUG_PRINTF("ODBCConnection::UV_Open : connectTimeout=%i, loginTimeout = %i\n", *&(self->connectTimeout), *&(self->loginTimeout));
   
-  uv_mutex_lock(&ODBC::g_odbcMutex); 
+  bool locked = ODBC::GlobalLock();
   
   if (self->connectTimeout > 0) {
-    //NOTE: SQLSetConnectAttr requires the thread to be locked
     SQLSetConnectAttr(
       self->m_hDBC,                              //ConnectionHandle
       SQL_ATTR_CONNECTION_TIMEOUT,               //Attribute
@@ -241,7 +277,6 @@ void ODBCConnection::UV_Open(uv_work_t* req) {
   }
   
   if (self->loginTimeout > 0) {
-    //NOTE: SQLSetConnectAttr requires the thread to be locked
     SQLSetConnectAttr(
       self->m_hDBC,                            //ConnectionHandle
       SQL_ATTR_LOGIN_TIMEOUT,                  //Attribute
@@ -250,7 +285,8 @@ void ODBCConnection::UV_Open(uv_work_t* req) {
   }
   
   //Attempt to connect
-  //NOTE: SQLDriverConnect requires the thread to be locked
+  //NOTE: this only holds the global lock when global locking is on, so a
+  //slow login doesn't hold up every other connection
   int ret = SQLDriverConnect(
     self->m_hDBC,                   //ConnectionHandle
     NULL,                           //WindowHandle
@@ -282,7 +318,7 @@ void ODBCConnection::UV_Open(uv_work_t* req) {
     ret = SQLFreeHandle( SQL_HANDLE_STMT, hStmt);
   }
 
-  uv_mutex_unlock(&ODBC::g_odbcMutex);
+  ODBC::GlobalUnlock(locked);
   
   data->result = ret;
 }
@@ -361,10 +397,9 @@ NAN_METHOD(ODBCConnection::OpenSync) {
   connection->WriteUtf8(connectionString);
 #endif
   
-  uv_mutex_lock(&ODBC::g_odbcMutex);
+  bool locked = ODBC::GlobalLock();
   
   if (conn->connectTimeout > 0) {
-    //NOTE: SQLSetConnectAttr requires the thread to be locked
     SQLSetConnectAttr(
       conn->m_hDBC,                              //ConnectionHandle
       SQL_ATTR_CONNECTION_TIMEOUT,               //Attribute
@@ -373,7 +408,6 @@ NAN_METHOD(ODBCConnection::OpenSync) {
   }
 
   if (conn->loginTimeout > 0) {
-    //NOTE: SQLSetConnectAttr requires the thread to be locked
     SQLSetConnectAttr(
       conn->m_hDBC,                            //ConnectionHandle
       SQL_ATTR_LOGIN_TIMEOUT,                  //Attribute
@@ -382,7 +416,8 @@ NAN_METHOD(ODBCConnection::OpenSync) {
   }
   
   //Attempt to connect
-  //NOTE: SQLDriverConnect requires the thread to be locked
+  //NOTE: this only holds the global lock when global locking is on, so a
+  //slow login doesn't hold up every other connection
   ret = SQLDriverConnect(
     conn->m_hDBC,                   //ConnectionHandle
     NULL,                           //WindowHandle
@@ -428,7 +463,7 @@ NAN_METHOD(ODBCConnection::OpenSync) {
     #endif*/
   }
 
-  uv_mutex_unlock(&ODBC::g_odbcMutex);
+  ODBC::GlobalUnlock(locked);
 
   free(connectionString);
   
@@ -449,7 +484,7 @@ NAN_METHOD(ODBCConnection::Close) {
   DEBUG_PRINTF("ODBCConnection::Close\n");
   NanScope();
 
-  REQ_FUN_ARG(0, cb);
+  REQ_FUN_OR_PROMISE_ARG(0, cb, promise);
 
   ODBCConnection* conn = ObjectWrap::Unwrap<ODBCConnection>(args.Holder());
   
@@ -463,15 +498,14 @@ NAN_METHOD(ODBCConnection::Close) {
 
   work_req->data = data;
   
-  uv_queue_work(
-    uv_default_loop(),
+  ODBC::QueueWork(
     work_req,
     UV_Close,
     (uv_after_work_cb)UV_AfterClose);
 
   conn->Ref();
 
-  NanReturnValue(NanUndefined());
+  NanReturnValue(promise);
 }
 
 void ODBCConnection::UV_Close(uv_work_t* req) {
@@ -567,14 +601,14 @@ NAN_METHOD(ODBCConnection::CreateStatementSync) {
    
   HSTMT hSTMT;
 
-  uv_mutex_lock(&ODBC::g_odbcMutex);
+  bool locked = ODBC::GlobalLock();
   
   SQLAllocHandle(
     SQL_HANDLE_STMT, 
     conn->m_hDBC, 
     &hSTMT);
   
-  uv_mutex_unlock(&ODBC::g_odbcMutex);
+  ODBC::GlobalUnlock(locked);
   
   Local<Value> params[3];
   params[0] = NanNew<External>(conn->m_hENV);
@@ -595,7 +629,7 @@ NAN_METHOD(ODBCConnection::CreateStatement) {
   DEBUG_PRINTF("ODBCConnection::CreateStatement\n");
   NanScope();
 
-  REQ_FUN_ARG(0, cb);
+  REQ_FUN_OR_PROMISE_ARG(0, cb, promise);
 
   ODBCConnection* conn = ObjectWrap::Unwrap<ODBCConnection>(args.Holder());
     
@@ -611,15 +645,14 @@ NAN_METHOD(ODBCConnection::CreateStatement) {
 
   work_req->data = data;
   
-  uv_queue_work(
-    uv_default_loop(), 
+  ODBC::QueueWork(
     work_req, 
     UV_CreateStatement, 
     (uv_after_work_cb)UV_AfterCreateStatement);
 
   conn->Ref();
 
-  NanReturnValue(NanUndefined());
+  NanReturnValue(promise);
 }
 
 void ODBCConnection::UV_CreateStatement(uv_work_t* req) {
@@ -634,14 +667,14 @@ void ODBCConnection::UV_CreateStatement(uv_work_t* req) {
     data->hSTMT
   );
   
-  uv_mutex_lock(&ODBC::g_odbcMutex);
+  bool locked = ODBC::GlobalLock();
   
   //allocate a new statment handle
   SQLAllocHandle( SQL_HANDLE_STMT, 
                   data->conn->m_hDBC, 
                   &data->hSTMT);
 
-  uv_mutex_unlock(&ODBC::g_odbcMutex);
+  ODBC::GlobalUnlock(locked);
   
   DEBUG_PRINTF("ODBCConnection::UV_CreateStatement m_hDBC=%X m_hDBC=%X m_hSTMT=%X\n",
     data->conn->m_hENV,
@@ -697,6 +730,7 @@ NAN_METHOD(ODBCConnection::Query) {
   NanScope();
   
   Local<Function> cb;
+  Local<Value> promise = NanUndefined();
   
   Local<String> sql;
   
@@ -706,8 +740,20 @@ NAN_METHOD(ODBCConnection::Query) {
   
   query_work_data* data = (query_work_data *) calloc(1, sizeof(query_work_data));
 
+  //the callback is always the last argument. Without one the query settles
+  //the Promise that is returned instead.
+  int argc = args.Length();
+  
+  if (argc > 0 && args[argc - 1]->IsFunction()) {
+    cb = Local<Function>::Cast(args[argc - 1]);
+    argc--;
+  }
+  else if (!ODBC::NewPromiseCallback(&cb, &promise)) {
+    return NanThrowTypeError("ODBCConnection::Query(): The last argument must be a Function.");
+  }
+
   //Check arguments for different variations of calling this function
-  if (args.Length() == 3) {
+  if (argc == 2) {
     //handle Query("sql string", [params], function cb () {});
     
     if ( !args[0]->IsString() ) {
@@ -716,27 +762,16 @@ NAN_METHOD(ODBCConnection::Query) {
     else if ( !args[1]->IsArray() ) {
       return NanThrowTypeError("Argument 1 must be an Array.");
     }
-    else if ( !args[2]->IsFunction() ) {
-      return NanThrowTypeError("Argument 2 must be a Function.");
-    }
 
     sql = args[0]->ToString();
     
     data->params = ODBC::GetParametersFromArray(
       Local<Array>::Cast(args[1]),
       &data->paramCount);
-    
-    cb = Local<Function>::Cast(args[2]);
   }
-  else if (args.Length() == 2 ) {
+  else if (argc == 1) {
     //handle either Query("sql", cb) or Query({ settings }, cb)
     
-    if (!args[1]->IsFunction()) {
-      return NanThrowTypeError("ODBCConnection::Query(): Argument 1 must be a Function.");
-    }
-    
-    cb = Local<Function>::Cast(args[1]);
-    
     if (args[0]->IsString()) {
       //handle Query("sql", function cb () {})
       
@@ -777,13 +812,18 @@ NAN_METHOD(ODBCConnection::Query) {
       else {
         data->noResultObject = false;
       }
+      
+      Local<String> optionTimeoutKey = NanNew(OPTION_TIMEOUT);
+      if (obj->Has(optionTimeoutKey) && obj->Get(optionTimeoutKey)->IsInt32()) {
+        data->timeout = obj->Get(optionTimeoutKey)->ToInt32()->Value();
+      }
     }
     else {
       return NanThrowTypeError("ODBCConnection::Query(): Argument 0 must be a String or an Object.");
     }
   }
   else {
-    return NanThrowTypeError("ODBCConnection::Query(): Requires either 2 or 3 Arguments. ");
+    return NanThrowTypeError("ODBCConnection::Query(): Requires either 1 or 2 Arguments and an optional callback. ");
   }
   //Done checking arguments
 
@@ -806,15 +846,14 @@ NAN_METHOD(ODBCConnection::Query) {
   data->conn = conn;
   work_req->data = data;
   
-  uv_queue_work(
-    uv_default_loop(),
+  ODBC::QueueWork(
     work_req, 
     UV_Query, 
     (uv_after_work_cb)UV_AfterQuery);
 
   conn->Ref();
 
-  NanReturnValue(NanUndefined());
+  NanReturnValue(promise);
 }
 
 void ODBCConnection::UV_Query(uv_work_t* req) {
@@ -825,14 +864,29 @@ void ODBCConnection::UV_Query(uv_work_t* req) {
   Parameter prm;
   SQLRETURN ret;
   
-  uv_mutex_lock(&ODBC::g_odbcMutex);
-
-  //allocate a new statment handle
-  SQLAllocHandle( SQL_HANDLE_STMT, 
-                  data->conn->m_hDBC, 
-                  &data->hSTMT );
-
-  uv_mutex_unlock(&ODBC::g_odbcMutex);
+  //the pool is gone once the connection has been closed
+  if (!data->conn->m_statementPool) {
+    data->hSTMT = SQL_NULL_HSTMT;
+    data->result = SQL_ERROR;
+    return;
+  }
+  
+  //reuse a statement handle from an earlier query if there is one
+  ret = ODBC::AllocStatement(data->conn->m_statementPool, &data->hSTMT);
+  
+  if (!SQL_SUCCEEDED(ret)) {
+    data->hSTMT = SQL_NULL_HSTMT;
+    data->result = ret;
+    return;
+  }
+  
+  if (data->timeout > 0) {
+    SQLSetStmtAttr(
+      data->hSTMT,
+      SQL_ATTR_QUERY_TIMEOUT,
+      (SQLPOINTER) (size_t) data->timeout,
+      SQL_IS_UINTEGER);
+  }
 
   // SQLExecDirect will use bound parameters, but without the overhead of SQLPrepare
   // for a single execution.
@@ -864,12 +918,21 @@ void ODBCConnection::UV_Query(uv_work_t* req) {
     }
   }
 
+  //let Cancel() find the statement while it is executing
+  uv_mutex_lock(&data->conn->m_activeMutex);
+  data->conn->m_hActiveSTMT = data->hSTMT;
+  uv_mutex_unlock(&data->conn->m_activeMutex);
+
   // execute the query directly
   ret = SQLExecDirect(
     data->hSTMT,
     (SQLTCHAR *)data->sql,
     data->sqlLen);
 
+  uv_mutex_lock(&data->conn->m_activeMutex);
+  data->conn->m_hActiveSTMT = NULL;
+  uv_mutex_unlock(&data->conn->m_activeMutex);
+
   // this will be checked later in UV_AfterQuery
   data->result = ret;
 }
@@ -885,16 +948,25 @@ void ODBCConnection::UV_AfterQuery(uv_work_t* req, int status) {
 
   DEBUG_PRINTF("ODBCConnection::UV_AfterQuery : data->result=%i, data->noResultObject=%i\n", data->result, data->noResultObject);
 
-  if (data->result != SQL_ERROR && data->noResultObject) {
+  if (data->hSTMT == SQL_NULL_HSTMT) {
+    //there was no statement handle to run the query on
+    Local<Value> args[1];
+    
+    if (data->conn->m_hDBC) {
+      args[0] = ODBC::GetSQLError(SQL_HANDLE_DBC, data->conn->m_hDBC, (char *) "[node-odbc] Error in ODBCConnection::UV_Query");
+    }
+    else {
+      args[0] = NanError("Connection not open.");
+    }
+    
+    data->cb->Call(1, args);
+  }
+  else if (data->result != SQL_ERROR && data->noResultObject) {
     //We have been requested to not create a result object
     //this means we should release the handle now and call back
     //with NanTrue()
     
-    uv_mutex_lock(&ODBC::g_odbcMutex);
-    
-    SQLFreeHandle(SQL_HANDLE_STMT, data->hSTMT);
-   
-    uv_mutex_unlock(&ODBC::g_odbcMutex);
+    ODBC::FreeStatement(data->conn->m_statementPool, data->hSTMT);
     
     Local<Value> args[2];
     args[0] = NanNew<Value>(NanNull());
@@ -903,15 +975,17 @@ void ODBCConnection::UV_AfterQuery(uv_work_t* req, int status) {
     data->cb->Call(2, args);
   }
   else {
-    Local<Value> args[4];
+    Local<Value> args[6];
     bool* canFreeHandle = new bool(true);
     
     args[0] = NanNew<External>(data->conn->m_hENV);
     args[1] = NanNew<External>(data->conn->m_hDBC);
     args[2] = NanNew<External>(data->hSTMT);
     args[3] = NanNew<External>(canFreeHandle);
+    args[4] = NanUndefined();
+    args[5] = NanNew<External>(data->conn->m_statementPool);
     
-    Local<Object> js_result = NanNew<Function>(ODBCResult::constructor)->NewInstance(4, args);
+    Local<Object> js_result = NanNew<Function>(ODBCResult::constructor)->NewInstance(6, args);
 
     // Check now to see if there was an error (as there may be further result sets)
     if (data->result == SQL_ERROR) {
@@ -940,6 +1014,8 @@ void ODBCConnection::UV_AfterQuery(uv_work_t* req, int status) {
         switch (prm.ValueType) {
           case SQL_C_WCHAR:   free(prm.ParameterValuePtr);             break; 
           case SQL_C_CHAR:    free(prm.ParameterValuePtr);             break; 
+          case SQL_C_BINARY:  free(prm.ParameterValuePtr);             break;
+          case SQL_C_TYPE_TIMESTAMP: free(prm.ParameterValuePtr);      break;
           case SQL_C_LONG:    delete (int64_t *)prm.ParameterValuePtr; break;
           case SQL_C_DOUBLE:  delete (double  *)prm.ParameterValuePtr; break;
           case SQL_C_BIT:     delete (bool    *)prm.ParameterValuePtr; break;
@@ -977,11 +1053,17 @@ NAN_METHOD(ODBCConnection::QuerySync) {
 
   ODBCConnection* conn = ObjectWrap::Unwrap<ODBCConnection>(args.Holder());
   
+  //the pool is gone once the connection has been closed
+  if (!conn->m_statementPool) {
+    return NanThrowError("Connection not open.");
+  }
+  
   Parameter* params = new Parameter[0];
   Parameter prm;
   SQLRETURN ret;
-  HSTMT hSTMT;
+  HSTMT hSTMT = SQL_NULL_HSTMT;
   int paramCount = 0;
+  int timeout = 0;
   bool noResultObject = false;
   
   //Check arguments for different variations of calling this function
@@ -1057,6 +1139,11 @@ NAN_METHOD(ODBCConnection::QuerySync) {
       if (obj->Has(optionNoResultsKey) && obj->Get(optionNoResultsKey)->IsBoolean()) {
         noResultObject = obj->Get(optionNoResultsKey)->ToBoolean()->Value();
       }
+      
+      Local<String> optionTimeoutKey = NanNew(OPTION_TIMEOUT);
+      if (obj->Has(optionTimeoutKey) && obj->Get(optionTimeoutKey)->IsInt32()) {
+        timeout = obj->Get(optionTimeoutKey)->ToInt32()->Value();
+      }
     }
     else {
       return NanThrowTypeError("ODBCConnection::QuerySync(): Argument 0 must be a String or an Object.");
@@ -1067,17 +1154,19 @@ NAN_METHOD(ODBCConnection::QuerySync) {
   }
   //Done checking arguments
 
-  uv_mutex_lock(&ODBC::g_odbcMutex);
-
-  //allocate a new statment handle
-  ret = SQLAllocHandle( SQL_HANDLE_STMT, 
-                  conn->m_hDBC, 
-                  &hSTMT );
-
-  uv_mutex_unlock(&ODBC::g_odbcMutex);
+  //reuse a statement handle from an earlier query if there is one
+  ret = ODBC::AllocStatement(conn->m_statementPool, &hSTMT);
 
   DEBUG_PRINTF("ODBCConnection::QuerySync - hSTMT=%p\n", hSTMT);
   
+  if (SQL_SUCCEEDED(ret) && timeout > 0) {
+    SQLSetStmtAttr(
+      hSTMT,
+      SQL_ATTR_QUERY_TIMEOUT,
+      (SQLPOINTER) (size_t) timeout,
+      SQL_IS_UINTEGER);
+  }
+  
   if (SQL_SUCCEEDED(ret)) {
     if (paramCount) {
       for (int i = 0; i < paramCount; i++) {
@@ -1116,6 +1205,8 @@ NAN_METHOD(ODBCConnection::QuerySync) {
         switch (prm.ValueType) {
           case SQL_C_WCHAR:   free(prm.ParameterValuePtr);             break;
           case SQL_C_CHAR:    free(prm.ParameterValuePtr);             break; 
+          case SQL_C_BINARY:  free(prm.ParameterValuePtr);             break;
+          case SQL_C_TYPE_TIMESTAMP: free(prm.ParameterValuePtr);      break;
           case SQL_C_LONG:    delete (int64_t *)prm.ParameterValuePtr; break;
           case SQL_C_DOUBLE:  delete (double  *)prm.ParameterValuePtr; break;
           case SQL_C_BIT:     delete (bool    *)prm.ParameterValuePtr; break;
@@ -1136,29 +1227,32 @@ NAN_METHOD(ODBCConnection::QuerySync) {
       (char *) "[node-odbc] Error in ODBCConnection::QuerySync"
     ));
     
+    //the diagnostics have been read so the handle can go back now
+    if (hSTMT != SQL_NULL_HSTMT) {
+      ODBC::FreeStatement(conn->m_statementPool, hSTMT);
+    }
+    
     NanReturnUndefined();
   }
   else if (noResultObject) {
     //if there is not result object requested then
-    //we must destroy the STMT ourselves.
-    uv_mutex_lock(&ODBC::g_odbcMutex);
-    
-    SQLFreeHandle(SQL_HANDLE_STMT, hSTMT);
-   
-    uv_mutex_unlock(&ODBC::g_odbcMutex);
+    //we must give back the STMT ourselves.
+    ODBC::FreeStatement(conn->m_statementPool, hSTMT);
     
     NanReturnValue(NanTrue());
   }
   else {
-    Local<Value> result[4];
+    Local<Value> result[6];
     bool* canFreeHandle = new bool(true);
     
     result[0] = NanNew<External>(conn->m_hENV);
     result[1] = NanNew<External>(conn->m_hDBC);
     result[2] = NanNew<External>(hSTMT);
     result[3] = NanNew<External>(canFreeHandle);
+    result[4] = NanUndefined();
+    result[5] = NanNew<External>(conn->m_statementPool);
     
-    Local<Object> js_result = NanNew<Function>(ODBCResult::constructor)->NewInstance(4, result);
+    Local<Object> js_result = NanNew<Function>(ODBCResult::constructor)->NewInstance(6, result);
 
     NanReturnValue(js_result);
   }
@@ -1175,7 +1269,7 @@ NAN_METHOD(ODBCConnection::Tables) {
   REQ_STRO_OR_NULL_ARG(1, schema);
   REQ_STRO_OR_NULL_ARG(2, table);
   REQ_STRO_OR_NULL_ARG(3, type);
-  Local<Function> cb = Local<Function>::Cast(args[4]);
+  REQ_FUN_OR_PROMISE_ARG(4, cb, promise);
 
   ODBCConnection* conn = ObjectWrap::Unwrap<ODBCConnection>(args.Holder());
   
@@ -1241,25 +1335,24 @@ NAN_METHOD(ODBCConnection::Tables) {
   data->conn = conn;
   work_req->data = data;
   
-  uv_queue_work(
-    uv_default_loop(), 
+  ODBC::QueueWork(
     work_req, 
     UV_Tables, 
     (uv_after_work_cb) UV_AfterQuery);
 
   conn->Ref();
 
-  NanReturnValue(NanUndefined());
+  NanReturnValue(promise);
 }
 
 void ODBCConnection::UV_Tables(uv_work_t* req) {
   query_work_data* data = (query_work_data *)(req->data);
   
-  uv_mutex_lock(&ODBC::g_odbcMutex);
+  bool locked = ODBC::GlobalLock();
   
   SQLAllocHandle(SQL_HANDLE_STMT, data->conn->m_hDBC, &data->hSTMT );
   
-  uv_mutex_unlock(&ODBC::g_odbcMutex);
+  ODBC::GlobalUnlock(locked);
   
   SQLRETURN ret = SQLTables( 
     data->hSTMT, 
@@ -1287,7 +1380,7 @@ NAN_METHOD(ODBCConnection::Columns) {
   REQ_STRO_OR_NULL_ARG(2, table);
   REQ_STRO_OR_NULL_ARG(3, column);
   
-  Local<Function> cb = Local<Function>::Cast(args[4]);
+  REQ_FUN_OR_PROMISE_ARG(4, cb, promise);
   
   ODBCConnection* conn = ObjectWrap::Unwrap<ODBCConnection>(args.Holder());
   
@@ -1352,25 +1445,24 @@ NAN_METHOD(ODBCConnection::Columns) {
   data->conn = conn;
   work_req->data = data;
   
-  uv_queue_work(
-    uv_default_loop(),
+  ODBC::QueueWork(
     work_req, 
     UV_Columns, 
     (uv_after_work_cb)UV_AfterQuery);
   
   conn->Ref();
 
-  NanReturnValue(NanUndefined());
+  NanReturnValue(promise);
 }
 
 void ODBCConnection::UV_Columns(uv_work_t* req) {
   query_work_data* data = (query_work_data *)(req->data);
   
-  uv_mutex_lock(&ODBC::g_odbcMutex);
+  bool locked = ODBC::GlobalLock();
   
   SQLAllocHandle(SQL_HANDLE_STMT, data->conn->m_hDBC, &data->hSTMT );
   
-  uv_mutex_unlock(&ODBC::g_odbcMutex);
+  ODBC::GlobalUnlock(locked);
   
   SQLRETURN ret = SQLColumns( 
     data->hSTMT, 
@@ -1424,7 +1516,7 @@ NAN_METHOD(ODBCConnection::BeginTransaction) {
   DEBUG_PRINTF("ODBCConnection::BeginTransaction\n");
   NanScope();
 
-  REQ_FUN_ARG(0, cb);
+  REQ_FUN_OR_PROMISE_ARG(0, cb, promise);
 
   ODBCConnection* conn = ObjectWrap::Unwrap<ODBCConnection>(args.Holder());
   
@@ -1442,13 +1534,12 @@ NAN_METHOD(ODBCConnection::BeginTransaction) {
   data->conn = conn;
   work_req->data = data;
   
-  uv_queue_work(
-    uv_default_loop(),
+  ODBC::QueueWork(
     work_req, 
     UV_BeginTransaction, 
     (uv_after_work_cb)UV_AfterBeginTransaction);
 
-  NanReturnUndefined();
+  NanReturnValue(promise);
 }
 
 /*
@@ -1580,7 +1671,7 @@ NAN_METHOD(ODBCConnection::EndTransaction) {
   NanScope();
 
   REQ_BOOL_ARG(0, rollback);
-  REQ_FUN_ARG(1, cb);
+  REQ_FUN_OR_PROMISE_ARG(1, cb, promise);
 
   ODBCConnection* conn = ObjectWrap::Unwrap<ODBCConnection>(args.Holder());
   
@@ -1602,13 +1693,12 @@ NAN_METHOD(ODBCConnection::EndTransaction) {
   data->conn = conn;
   work_req->data = data;
   
-  uv_queue_work(
-    uv_default_loop(),
+  ODBC::QueueWork(
     work_req, 
     UV_EndTransaction, 
     (uv_after_work_cb)UV_AfterEndTransaction);
 
-  NanReturnValue(NanUndefined());
+  NanReturnValue(promise);
 }
 
 /*
@@ -1686,3 +1776,175 @@ void ODBCConnection::UV_AfterEndTransaction(uv_work_t* req, int status) {
   free(data);
   free(req);
 }
+
+/*
+ * ResetSync
+ * 
+ * Ask the driver to reset the session state (temp tables, SET options,
+ * open transactions) the next time the connection is used. This is much
+ * cheaper than disconnecting and connecting again. Throws if the driver
+ * doesn't support SQL_ATTR_RESET_CONNECTION.
+ */
+
+NAN_METHOD(ODBCConnection::ResetSync) {
+  DEBUG_PRINTF("ODBCConnection::ResetSync\n");
+  NanScope();
+
+  ODBCConnection* conn = ObjectWrap::Unwrap<ODBCConnection>(args.Holder());
+  
+  SQLRETURN ret = SQLSetConnectAttr(
+    conn->m_hDBC,
+    SQL_ATTR_RESET_CONNECTION,
+    (SQLPOINTER) SQL_RESET_CONNECTION_YES,
+    SQL_IS_UINTEGER);
+  
+  if (!SQL_SUCCEEDED(ret)) {
+    Local<Object> objError = ODBC::GetSQLError(SQL_HANDLE_DBC, conn->m_hDBC);
+    
+    NanThrowError(objError);
+    
+    NanReturnValue(NanFalse());
+  }
+  
+  NanReturnValue(NanTrue());
+}
+
+/*
+ * Reset
+ * 
+ */
+
+NAN_METHOD(ODBCConnection::Reset) {
+  DEBUG_PRINTF("ODBCConnection::Reset\n");
+  NanScope();
+
+  REQ_FUN_OR_PROMISE_ARG(0, cb, promise);
+
+  ODBCConnection* conn = ObjectWrap::Unwrap<ODBCConnection>(args.Holder());
+  
+  uv_work_t* work_req = (uv_work_t *) (calloc(1, sizeof(uv_work_t)));
+  
+  query_work_data* data = 
+    (query_work_data *) calloc(1, sizeof(query_work_data));
+  
+  if (!data) {
+    NanLowMemoryNotification();
+    return NanThrowError("Could not allocate enough memory");
+  }
+
+  data->cb = new NanCallback(cb);
+  data->conn = conn;
+  work_req->data = data;
+  
+  ODBC::QueueWork(
+    work_req, 
+    UV_Reset, 
+    (uv_after_work_cb)UV_AfterReset);
+
+  conn->Ref();
+
+  NanReturnValue(promise);
+}
+
+/*
+ * UV_Reset
+ * 
+ */
+
+void ODBCConnection::UV_Reset(uv_work_t* req) {
+  DEBUG_PRINTF("ODBCConnection::UV_Reset\n");
+  
+  query_work_data* data = (query_work_data *)(req->data);
+  
+  data->result = SQLSetConnectAttr(
+    data->conn->self()->m_hDBC,
+    SQL_ATTR_RESET_CONNECTION,
+    (SQLPOINTER) SQL_RESET_CONNECTION_YES,
+    SQL_IS_UINTEGER);
+}
+
+/*
+ * UV_AfterReset
+ * 
+ */
+
+void ODBCConnection::UV_AfterReset(uv_work_t* req, int status) {
+  DEBUG_PRINTF("ODBCConnection::UV_AfterReset\n");
+  NanScope();
+  
+  query_work_data* data = (query_work_data *)(req->data);
+  
+  Local<Value> argv[1];
+  
+  bool err = false;
+
+  if (!SQL_SUCCEEDED(data->result)) {
+    err = true;
+
+    Local<Object> objError = ODBC::GetSQLError(SQL_HANDLE_DBC, data->conn->self()->m_hDBC);
+    
+    argv[0] = objError;
+  }
+
+  TryCatch try_catch;
+
+  data->cb->Call(err ? 1 : 0, argv);
+
+  if (try_catch.HasCaught()) {
+    FatalException(try_catch);
+  }
+
+  data->conn->Unref();
+
+  delete data->cb;
+  
+  free(data);
+  free(req);
+}
+
+/*
+ * GetStatementStats
+ * 
+ * How often Query/QuerySync found a statement handle to reuse.
+ */
+
+NAN_METHOD(ODBCConnection::GetStatementStats) {
+  DEBUG_PRINTF("ODBCConnection::GetStatementStats\n");
+  NanScope();
+
+  ODBCConnection* conn = ObjectWrap::Unwrap<ODBCConnection>(args.Holder());
+  
+  if (!conn->m_statementPool) {
+    return NanThrowError("Connection is closed.");
+  }
+  
+  NanReturnValue(ODBC::GetStatementPoolStats(conn->m_statementPool));
+}
+
+/*
+ * Cancel
+ * 
+ * Cancel the statement that query() is executing on a worker thread, if
+ * any. The query then calls back with an HY008 error. Returns whether
+ * there was a statement to cancel.
+ */
+
+NAN_METHOD(ODBCConnection::Cancel) {
+  DEBUG_PRINTF("ODBCConnection::Cancel\n");
+  NanScope();
+
+  ODBCConnection* conn = ObjectWrap::Unwrap<ODBCConnection>(args.Holder());
+  
+  bool canceled = false;
+  
+  //hold the lock so that the statement can't be freed underneath us
+  uv_mutex_lock(&conn->m_activeMutex);
+  
+  if (conn->m_hActiveSTMT) {
+    canceled = SQL_SUCCEEDED(SQLCancel(conn->m_hActiveSTMT));
+  }
+  
+  uv_mutex_unlock(&conn->m_activeMutex);
+  
+  NanReturnValue(canceled ? NanTrue() : NanFalse());
+}
@@ -25,6 +25,7 @@ class ODBCConnection : public node::ObjectWrap {
    static Persistent<String> OPTION_SQL;
    static Persistent<String> OPTION_PARAMS;
    static Persistent<String> OPTION_NORESULTS;
+   static Persistent<String> OPTION_TIMEOUT;
    static Persistent<Function> constructor;
    
    static void Init(v8::Handle<Object> exports);
@@ -37,7 +38,9 @@ class ODBCConnection : public node::ObjectWrap {
     explicit ODBCConnection(HENV hENV, HDBC hDBC): 
       ObjectWrap(),
       m_hENV(hENV),
-      m_hDBC(hDBC) {};
+      m_hDBC(hDBC),
+      m_statementPool(NULL),
+      m_hActiveSTMT(NULL) {};
      
     ~ODBCConnection();
 
@@ -60,6 +63,10 @@ class ODBCConnection : public node::ObjectWrap {
     static void UV_EndTransaction(uv_work_t* work_req);
     static void UV_AfterEndTransaction(uv_work_t* work_req, int status);
     
+    static NAN_METHOD(Reset);
+    static void UV_Reset(uv_work_t* work_req);
+    static void UV_AfterReset(uv_work_t* work_req, int status);
+    
     
     static NAN_METHOD(Open);
     static void UV_Open(uv_work_t* work_req);
@@ -90,6 +97,9 @@ class ODBCConnection : public node::ObjectWrap {
     static NAN_METHOD(QuerySync);
     static NAN_METHOD(BeginTransactionSync);
     static NAN_METHOD(EndTransactionSync);
+    static NAN_METHOD(ResetSync);
+    static NAN_METHOD(GetStatementStats);
+    static NAN_METHOD(Cancel);
     
     struct Fetch_Request {
       NanCallback* callback;
@@ -102,6 +112,11 @@ class ODBCConnection : public node::ObjectWrap {
   protected:
     HENV m_hENV;
     HDBC m_hDBC;
+    StatementPool *m_statementPool;
+    
+    //statement being executed by UV_Query, for Cancel
+    HSTMT m_hActiveSTMT;
+    uv_mutex_t m_activeMutex;
     SQLUSMALLINT canHaveMoreResults;
     bool connected;
     int statements;
@@ -125,6 +140,7 @@ struct query_work_data {
   int paramCount;
   int completionType;
   bool noResultObject;
+  int timeout;
   
   void *sql;
   void *catalog;
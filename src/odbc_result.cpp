@@ -31,6 +31,11 @@ using namespace node;
 
 Persistent<Function> ODBCResult::constructor;
 Persistent<String> ODBCResult::OPTION_FETCH_MODE;
+Persistent<String> ODBCResult::OPTION_CHUNK_SIZE;
+Persistent<String> ODBCResult::OPTION_ROW_ARRAY_SIZE;
+Persistent<String> ODBCResult::OPTION_DATE_MODE;
+Persistent<String> ODBCResult::OPTION_EXACT_NUMBERS;
+Persistent<String> ODBCResult::OPTION_STREAM_COLUMNS;
 
 void ODBCResult::Init(v8::Handle<Object> exports) {
   DEBUG_PRINTF("ODBCResult::Init\n");
@@ -48,16 +53,29 @@ void ODBCResult::Init(v8::Handle<Object> exports) {
   // Prototype Methods  
   NODE_SET_PROTOTYPE_METHOD(constructor_template, "fetchAll", FetchAll);
   NODE_SET_PROTOTYPE_METHOD(constructor_template, "fetch", Fetch);
+  NODE_SET_PROTOTYPE_METHOD(constructor_template, "fetchBatch", FetchBatch);
+  NODE_SET_PROTOTYPE_METHOD(constructor_template, "cancel", Cancel);
+  NODE_SET_PROTOTYPE_METHOD(constructor_template, "getData", GetData);
 
   NODE_SET_PROTOTYPE_METHOD(constructor_template, "moreResultsSync", MoreResultsSync);
   NODE_SET_PROTOTYPE_METHOD(constructor_template, "closeSync", CloseSync);
   NODE_SET_PROTOTYPE_METHOD(constructor_template, "fetchSync", FetchSync);
   NODE_SET_PROTOTYPE_METHOD(constructor_template, "fetchAllSync", FetchAllSync);
   NODE_SET_PROTOTYPE_METHOD(constructor_template, "getColumnNamesSync", GetColumnNamesSync);
+  NODE_SET_PROTOTYPE_METHOD(constructor_template, "getDataSync", GetDataSync);
 
   // Properties
   NanAssignPersistent(OPTION_FETCH_MODE, NanNew("fetchMode"));
   instance_template->SetAccessor(NanNew("fetchMode"), FetchModeGetter, FetchModeSetter);
+  NanAssignPersistent(OPTION_CHUNK_SIZE, NanNew("chunkSize"));
+  instance_template->SetAccessor(NanNew("chunkSize"), ChunkSizeGetter, ChunkSizeSetter);
+  NanAssignPersistent(OPTION_ROW_ARRAY_SIZE, NanNew("rowArraySize"));
+  instance_template->SetAccessor(NanNew("rowArraySize"), RowArraySizeGetter, RowArraySizeSetter);
+  NanAssignPersistent(OPTION_DATE_MODE, NanNew("dateMode"));
+  instance_template->SetAccessor(NanNew("dateMode"), DateModeGetter, DateModeSetter);
+  NanAssignPersistent(OPTION_EXACT_NUMBERS, NanNew("exactNumbers"));
+  instance_template->SetAccessor(NanNew("exactNumbers"), ExactNumbersGetter, ExactNumbersSetter);
+  NanAssignPersistent(OPTION_STREAM_COLUMNS, NanNew("streamColumns"));
   
   // Attach the Database Constructor to the target object
   NanAssignPersistent(constructor, constructor_template->GetFunction());
@@ -73,19 +91,197 @@ ODBCResult::~ODBCResult() {
 void ODBCResult::Free() {
   DEBUG_PRINTF("ODBCResult::Free m_hSTMT=%X m_canFreeHandle=%X\n", m_hSTMT, m_canFreeHandle);
   
-  if (m_hSTMT && m_canFreeHandle) {
-    uv_mutex_lock(&ODBC::g_odbcMutex);
+  if (m_hSTMT && m_canFreeHandle && m_statementPool) {
+    //hand the statement back to the connection that made it
+    ODBC::FreeStatement(m_statementPool, m_hSTMT);
+    
+    m_hSTMT = NULL;
+  }
+  else if (m_hSTMT && m_canFreeHandle) {
+    bool locked = ODBC::GlobalLock();
     
     SQLFreeHandle( SQL_HANDLE_STMT, m_hSTMT);
     
     m_hSTMT = NULL;
   
-    uv_mutex_unlock(&ODBC::g_odbcMutex);
+    ODBC::GlobalUnlock(locked);
+  }
+  
+  if (m_statementPool != NULL) {
+    ODBC::ReleaseStatementPool(m_statementPool);
+    
+    m_statementPool = NULL;
+  }
+  
+  if (m_columnCache != NULL) {
+    FreeColumns();
+  }
+  
+  ReleaseBuffer();
+}
+
+/*
+ * FreeColumns
+ *
+ * Drop this result's reference to the columns of the current result set.
+ */
+
+void ODBCResult::FreeColumns() {
+  if (m_columnCache != NULL) {
+    ODBC::ReleaseColumnCache(m_columnCache);
+    
+    m_columnCache = NULL;
+    columns = NULL;
+    colCount = 0;
+  }
+  else {
+    ODBC::FreeColumns(columns, &colCount);
+  }
+}
+
+/*
+ * GetColumns
+ *
+ * Describe the columns of the current result set and size the buffer for
+ * them. Safe to call from the thread pool.
+ */
+
+void ODBCResult::GetColumns() {
+  columns = ODBC::GetColumns(m_hSTMT, &colCount);
+  
+  if (colCount > 0) {
+    m_columnCache = ODBC::CreateColumnCache(columns, colCount);
+  }
+  
+  AcquireBuffer();
+}
+
+/*
+ * ApplyDateMode
+ *
+ * Set how the timestamp columns of the current result set are converted.
+ * Must be called from the event loop thread before building rows.
+ */
+
+void ODBCResult::ApplyDateMode(int dateMode) {
+  for (int i = 0; i < colCount; i++) {
+    columns[i].dateMode = dateMode;
+  }
+}
+
+/*
+ * GetDateModeOption
+ *
+ * The dateMode of a fetch options object, or dateMode if it has none.
+ */
+
+int ODBCResult::GetDateModeOption(Local<Object> options, int dateMode) {
+  Local<String> dateModeKey = NanNew<String>(OPTION_DATE_MODE);
+  
+  if (options->Has(dateModeKey) && options->Get(dateModeKey)->IsInt32()) {
+    int value = options->Get(dateModeKey)->ToInt32()->Value();
+    
+    if (value == DATE_OBJECT || value == DATE_NUMBER || value == DATE_STRING) {
+      return value;
+    }
+  }
+  
+  return dateMode;
+}
+
+/*
+ * ApplyExactNumbers
+ *
+ * Set whether BIGINT and NUMERIC/DECIMAL columns of the current result set
+ * are read exactly. This changes how values are retrieved, not just how they
+ * are converted, so it has to happen before any column data is read.
+ */
+
+void ODBCResult::ApplyExactNumbers(bool exactNumbers) {
+  for (int i = 0; i < colCount; i++) {
+    columns[i].exactNumbers = exactNumbers;
+  }
+}
+
+/*
+ * GetExactNumbersOption
+ *
+ * The exactNumbers of a fetch options object, or exactNumbers if it has none.
+ */
+
+bool ODBCResult::GetExactNumbersOption(Local<Object> options, bool exactNumbers) {
+  Local<String> exactNumbersKey = NanNew<String>(OPTION_EXACT_NUMBERS);
+  
+  if (options->Has(exactNumbersKey) && options->Get(exactNumbersKey)->IsBoolean()) {
+    return options->Get(exactNumbersKey)->BooleanValue();
+  }
+  
+  return exactNumbers;
+}
+
+/*
+ * GetColumnBuffersObject
+ *
+ * The FETCH_COLUMNS result for the current result set. buffers may be NULL
+ * if no rows were fetched.
+ */
+
+Local<Object> ODBCResult::GetColumnBuffersObject(ColumnBuffer* buffers) {
+  NanEscapableScope();
+  
+  if (m_columnCache == NULL) {
+    return NanEscapeScope(NanNew<Object>());
+  }
+  
+  if (buffers != NULL) {
+    return NanEscapeScope(ODBC::GetColumnBuffersObject(buffers, m_columnCache));
+  }
+  
+  //still hand back an (empty) array for every column
+  ColumnBuffer* empty = ODBC::CreateColumnBuffers(colCount);
+  
+  Local<Object> result = ODBC::GetColumnBuffersObject(empty, m_columnCache);
+  
+  ODBC::FreeColumnBuffers(empty, colCount);
+  
+  return NanEscapeScope(result);
+}
+
+/*
+ * AcquireBuffer
+ *
+ * Make sure the SQLGetData buffer is big enough for the columns of the
+ * current result set. Safe to call from the thread pool.
+ */
+
+void ODBCResult::AcquireBuffer() {
+  if (colCount == 0) {
+    return;
+  }
+  
+  int length = ODBC::GetBufferLength(m_hSTMT, columns, &colCount);
+  
+  if (buffer != NULL) {
+    if (bufferLength >= length) {
+      return;
+    }
+    
+    ReleaseBuffer();
   }
   
-  if (bufferLength > 0) {
+  buffer = ODBC::AcquireBuffer(length, &bufferLength);
+}
+
+/*
+ * ReleaseBuffer
+ */
+
+void ODBCResult::ReleaseBuffer() {
+  if (buffer != NULL) {
+    ODBC::ReleaseBuffer(buffer, bufferLength);
+    
+    buffer = NULL;
     bufferLength = 0;
-    free(buffer);
   }
 }
 
@@ -116,19 +312,54 @@ NAN_METHOD(ODBCResult::New) {
   //free the pointer to canFreeHandle
   delete canFreeHandle;
 
-  //specify the buffer length
-  objODBCResult->bufferLength = MAX_VALUE_SIZE - 1;
-  
-  //initialze a buffer for this object
-  objODBCResult->buffer = (uint16_t *) malloc(objODBCResult->bufferLength + 1);
-  //TODO: make sure the malloc succeeded
+  //the buffer is taken from the pool once the columns are known
+  objODBCResult->buffer = NULL;
+  objODBCResult->bufferLength = 0;
 
   //set the initial colCount to 0
   objODBCResult->colCount = 0;
+  objODBCResult->m_columnCache = NULL;
+  
+  //nothing to cancel yet
+  objODBCResult->m_activeWork = 0;
+  objODBCResult->m_canceled = false;
+  
+  //a prepared statement hands over the columns it has already described
+  if (args.Length() > 4 && args[4]->IsExternal()) {
+    ColumnCache* cache = static_cast<ColumnCache *>(Local<External>::Cast(args[4])->Value());
+    
+    cache->refCount++;
+    
+    objODBCResult->m_columnCache = cache;
+    objODBCResult->columns = cache->columns;
+    objODBCResult->colCount = cache->colCount;
+    
+    objODBCResult->AcquireBuffer();
+  }
+  
+  //results of ODBCConnection::Query give their statement back to the
+  //connection's pool when they are closed
+  if (args.Length() > 5 && args[5]->IsExternal()) {
+    objODBCResult->m_statementPool = static_cast<StatementPool *>(Local<External>::Cast(args[5])->Value());
+    
+    ODBC::RetainStatementPool(objODBCResult->m_statementPool);
+  }
 
   //default fetchMode to FETCH_OBJECT
   objODBCResult->m_fetchMode = FETCH_OBJECT;
   
+  //default number of rows fetchAll retrieves per trip to the thread pool
+  objODBCResult->m_chunkSize = DEFAULT_CHUNK_SIZE;
+  
+  //default to fetching a single row per SQLFetch call
+  objODBCResult->m_rowArraySize = 1;
+  
+  //default to returning timestamps as Date objects
+  objODBCResult->m_dateMode = DATE_OBJECT;
+  
+  //default to reading BIGINT and NUMERIC/DECIMAL values as doubles
+  objODBCResult->m_exactNumbers = false;
+  
   objODBCResult->Wrap(args.Holder());
   
   NanReturnValue(args.Holder());
@@ -152,6 +383,82 @@ NAN_SETTER(ODBCResult::FetchModeSetter) {
   }
 }
 
+NAN_GETTER(ODBCResult::ChunkSizeGetter) {
+  NanScope();
+
+  ODBCResult *obj = ObjectWrap::Unwrap<ODBCResult>(args.Holder());
+
+  NanReturnValue(NanNew(obj->m_chunkSize));
+}
+
+NAN_SETTER(ODBCResult::ChunkSizeSetter) {
+  NanScope();
+
+  ODBCResult *obj = ObjectWrap::Unwrap<ODBCResult>(args.Holder());
+  
+  if (value->IsInt32() && value->Int32Value() > 0) {
+    obj->m_chunkSize = value->Int32Value();
+  }
+}
+
+NAN_GETTER(ODBCResult::RowArraySizeGetter) {
+  NanScope();
+
+  ODBCResult *obj = ObjectWrap::Unwrap<ODBCResult>(args.Holder());
+
+  NanReturnValue(NanNew(obj->m_rowArraySize));
+}
+
+NAN_SETTER(ODBCResult::RowArraySizeSetter) {
+  NanScope();
+
+  ODBCResult *obj = ObjectWrap::Unwrap<ODBCResult>(args.Holder());
+  
+  if (value->IsInt32() && value->Int32Value() > 0) {
+    obj->m_rowArraySize = value->Int32Value();
+  }
+}
+
+NAN_GETTER(ODBCResult::DateModeGetter) {
+  NanScope();
+
+  ODBCResult *obj = ObjectWrap::Unwrap<ODBCResult>(args.Holder());
+
+  NanReturnValue(NanNew(obj->m_dateMode));
+}
+
+NAN_SETTER(ODBCResult::DateModeSetter) {
+  NanScope();
+
+  ODBCResult *obj = ObjectWrap::Unwrap<ODBCResult>(args.Holder());
+  
+  if (value->IsInt32()) {
+    int dateMode = value->Int32Value();
+    
+    if (dateMode == DATE_OBJECT || dateMode == DATE_NUMBER || dateMode == DATE_STRING) {
+      obj->m_dateMode = dateMode;
+    }
+  }
+}
+
+NAN_GETTER(ODBCResult::ExactNumbersGetter) {
+  NanScope();
+
+  ODBCResult *obj = ObjectWrap::Unwrap<ODBCResult>(args.Holder());
+
+  NanReturnValue(NanNew(obj->m_exactNumbers));
+}
+
+NAN_SETTER(ODBCResult::ExactNumbersSetter) {
+  NanScope();
+
+  ODBCResult *obj = ObjectWrap::Unwrap<ODBCResult>(args.Holder());
+  
+  if (value->IsBoolean()) {
+    obj->m_exactNumbers = value->BooleanValue();
+  }
+}
+
 /*
  * Fetch
  */
@@ -167,25 +474,52 @@ NAN_METHOD(ODBCResult::Fetch) {
   fetch_work_data* data = (fetch_work_data *) calloc(1, sizeof(fetch_work_data));
   
   Local<Function> cb;
+  Local<Value> promise = NanUndefined();
    
   //set the fetch mode to the default of this instance
   data->fetchMode = objODBCResult->m_fetchMode;
+  data->dateMode = objODBCResult->m_dateMode;
+  data->exactNumbers = objODBCResult->m_exactNumbers;
+  data->streamFrom = -1;
   
-  if (args.Length() == 1 && args[0]->IsFunction()) {
-    cb = Local<Function>::Cast(args[0]);
+  //without a callback the row settles the Promise that is returned instead
+  int argc = args.Length();
+  
+  if (argc > 0 && args[argc - 1]->IsFunction()) {
+    cb = Local<Function>::Cast(args[argc - 1]);
+    argc--;
   }
-  else if (args.Length() == 2 && args[0]->IsObject() && args[1]->IsFunction()) {
-    cb = Local<Function>::Cast(args[1]);  
-    
+  else if (!ODBC::NewPromiseCallback(&cb, &promise)) {
+    return NanThrowTypeError("ODBCResult::Fetch(): 1 or 2 arguments are required. The last argument must be a callback function.");
+  }
+  
+  if (argc == 1 && args[0]->IsObject()) {
     Local<Object> obj = args[0]->ToObject();
     
     Local<String> fetchModeKey = NanNew<String>(OPTION_FETCH_MODE);
     if (obj->Has(fetchModeKey) && obj->Get(fetchModeKey)->IsInt32()) {
       data->fetchMode = obj->Get(fetchModeKey)->ToInt32()->Value();
     }
+    
+    data->dateMode = GetDateModeOption(obj, data->dateMode);
+    data->exactNumbers = GetExactNumbersOption(obj, data->exactNumbers);
+    
+    //the first of the columns that will be read with getData
+    Local<String> streamColumnsKey = NanNew<String>(OPTION_STREAM_COLUMNS);
+    if (obj->Has(streamColumnsKey) && obj->Get(streamColumnsKey)->IsArray()) {
+      Local<Array> streamColumns = Local<Array>::Cast(obj->Get(streamColumnsKey));
+      
+      for (uint32_t i = 0; i < streamColumns->Length(); i++) {
+        int column = streamColumns->Get(i)->Int32Value();
+        
+        if (column >= 0 && (data->streamFrom < 0 || column < data->streamFrom)) {
+          data->streamFrom = column;
+        }
+      }
+    }
   }
-  else {
-    return NanThrowTypeError("ODBCResult::Fetch(): 1 or 2 arguments are required. The last argument must be a callback function.");
+  else if (argc != 0) {
+    return NanThrowTypeError("ODBCResult::Fetch(): Argument 0 must be an Object.");
   }
   
   data->cb = new NanCallback(cb);
@@ -193,15 +527,15 @@ NAN_METHOD(ODBCResult::Fetch) {
   data->objResult = objODBCResult;
   work_req->data = data;
   
-  uv_queue_work(
-    uv_default_loop(), 
+  ODBC::QueueWork(
     work_req, 
     UV_Fetch, 
     (uv_after_work_cb)UV_AfterFetch);
 
   objODBCResult->Ref();
+  objODBCResult->m_activeWork++;
 
-  NanReturnValue(NanUndefined());
+  NanReturnValue(promise);
 }
 
 void ODBCResult::UV_Fetch(uv_work_t* work_req) {
@@ -209,7 +543,52 @@ void ODBCResult::UV_Fetch(uv_work_t* work_req) {
   
   fetch_work_data* data = (fetch_work_data *)(work_req->data);
   
-  data->result = SQLFetch(data->objResult->m_hSTMT);
+  ODBCResult* self = data->objResult->self();
+  
+  data->rowCount = 0;
+  
+  data->result = SQLFetch(self->m_hSTMT);
+  
+  if (self->colCount == 0) {
+    self->GetColumns();
+  }
+  
+  self->ApplyExactNumbers(data->exactNumbers);
+  
+  //retrieve all of the column data here, on the thread pool, so that a slow
+  //driver or a large value never blocks the event loop
+  if (self->colCount > 0 && SQL_SUCCEEDED(data->result)) {
+    data->rowData = (ColumnData *) calloc(self->colCount, sizeof(ColumnData));
+    
+    //columns that are going to be streamed are left for GetData, they are
+    //null in the row itself
+    short readCount = self->colCount;
+    
+    if (data->streamFrom >= 0 && data->streamFrom < readCount) {
+      readCount = data->streamFrom;
+    }
+    
+    for (int i = readCount; i < self->colCount; i++) {
+      data->rowData[i].len = SQL_NULL_DATA;
+    }
+    
+    SQLRETURN ret = ODBC::GetRecordData(
+      self->m_hSTMT,
+      self->columns,
+      &readCount,
+      data->rowData,
+      self->buffer,
+      self->bufferLength);
+    
+    if (SQL_SUCCEEDED(ret)) {
+      data->rowCount = 1;
+    }
+    else {
+      ODBC::FreeColumnData(data->rowData, self->colCount);
+      
+      data->result = SQL_ERROR;
+    }
+  }
 }
 
 void ODBCResult::UV_AfterFetch(uv_work_t* work_req, int status) {
@@ -218,6 +597,10 @@ void ODBCResult::UV_AfterFetch(uv_work_t* work_req, int status) {
   
   fetch_work_data* data = (fetch_work_data *)(work_req->data);
   
+  ODBCResult* self = data->objResult->self();
+  
+  self->EndWork();
+  
   SQLRETURN ret = data->result;
   //TODO: we should probably define this on the work data so we
   //don't have to keep creating it?
@@ -225,14 +608,8 @@ void ODBCResult::UV_AfterFetch(uv_work_t* work_req, int status) {
   bool moreWork = true;
   bool error = false;
   
-  if (data->objResult->colCount == 0) {
-    data->objResult->columns = ODBC::GetColumns(
-      data->objResult->m_hSTMT, 
-      &data->objResult->colCount);
-  }
-  
   //check to see if the result has no columns
-  if (data->objResult->colCount == 0) {
+  if (self->colCount == 0) {
     //this means
     moreWork = false;
   }
@@ -243,7 +620,7 @@ void ODBCResult::UV_AfterFetch(uv_work_t* work_req, int status) {
     
     objError = ODBC::GetSQLError(
       SQL_HANDLE_STMT, 
-      data->objResult->m_hSTMT,
+      self->m_hSTMT,
       (char *) "Error in ODBCResult::UV_AfterFetch");
   }
   //check to see if we are at the end of the recordset
@@ -254,23 +631,22 @@ void ODBCResult::UV_AfterFetch(uv_work_t* work_req, int status) {
   if (moreWork) {
     Handle<Value> args[2];
 
+    self->ApplyDateMode(data->dateMode);
+    
     args[0] = NanNull();
     if (data->fetchMode == FETCH_ARRAY) {
       args[1] = ODBC::GetRecordArray(
-        data->objResult->m_hSTMT,
-        data->objResult->columns,
-        &data->objResult->colCount,
-        data->objResult->buffer,
-        data->objResult->bufferLength);
+        self->columns,
+        &self->colCount,
+        data->rowData);
     }
     else {
       args[1] = ODBC::GetRecordTuple(
-        data->objResult->m_hSTMT,
-        data->objResult->columns,
-        &data->objResult->colCount,
-        data->objResult->buffer,
-        data->objResult->bufferLength);
+        self->m_columnCache,
+        data->rowData);
     }
+    
+    ODBC::FreeColumnData(data->rowData, self->colCount);
 
     TryCatch try_catch;
 
@@ -282,7 +658,7 @@ void ODBCResult::UV_AfterFetch(uv_work_t* work_req, int status) {
     }
   }
   else {
-    ODBC::FreeColumns(data->objResult->columns, &data->objResult->colCount);
+    self->FreeColumns();
     
     Handle<Value> args[2];
     
@@ -295,23 +671,240 @@ void ODBCResult::UV_AfterFetch(uv_work_t* work_req, int status) {
     }
     
     args[1] = NanNull();
-
-    TryCatch try_catch;
-
-    data->cb->Call(2, args);
-    delete data->cb;
-
-    if (try_catch.HasCaught()) {
-      FatalException(try_catch);
-    }
+
+    TryCatch try_catch;
+
+    data->cb->Call(2, args);
+    delete data->cb;
+
+    if (try_catch.HasCaught()) {
+      FatalException(try_catch);
+    }
+  }
+  
+  self->Unref();
+  
+  free(data->rowData);
+  free(data);
+  free(work_req);
+  
+  return;
+}
+
+/*
+ * GetDataChunk
+ *
+ * Read up to `length` more bytes of `column` (0 based) of the current row
+ * with a single SQLGetData call. `buffer` is set to a malloc'd buffer holding
+ * `bytes` bytes of the value, or NULL once the value is exhausted or null.
+ * `more` tells whether the driver has more of the value. Text is returned in
+ * the driver's encoding: UTF-16 with UNICODE, UTF-8 otherwise. Safe to call
+ * from the thread pool.
+ */
+
+SQLRETURN ODBCResult::GetDataChunk(int column, SQLLEN length, unsigned char** buffer,
+                                   SQLLEN* bytes, bool* more) {
+  bool binary = ODBC::IsBinaryColumn(columns[column]);
+  SQLSMALLINT cType = binary ? SQL_C_BINARY : SQL_C_TCHAR;
+  SQLLEN terminator = binary ? 0 : sizeof(SQLTCHAR);
+  SQLLEN chunkMax = (length / sizeof(SQLTCHAR)) * sizeof(SQLTCHAR);
+  SQLLEN len = 0;
+  
+  if (chunkMax < (SQLLEN) sizeof(SQLTCHAR)) {
+    chunkMax = sizeof(SQLTCHAR);
+  }
+  
+  *buffer = NULL;
+  *bytes = 0;
+  *more = false;
+  
+  unsigned char* chunk = (unsigned char *) malloc(chunkMax + terminator);
+  
+  SQLRETURN ret = SQLGetData(
+    m_hSTMT,
+    columns[column].index,
+    cType,
+    chunk,
+    chunkMax + terminator,
+    &len);
+  
+  DEBUG_PRINTF("ODBCResult::GetDataChunk: column=%i len=%i ret=%i\n", column, len, ret);
+  
+  if (ret == SQL_NO_DATA || !SQL_SUCCEEDED(ret) || len == SQL_NULL_DATA) {
+    free(chunk);
+    
+    return (ret == SQL_NO_DATA) ? SQL_SUCCESS : ret;
+  }
+  
+  *buffer = chunk;
+  *bytes = (len == SQL_NO_TOTAL || len > chunkMax) ? chunkMax : len;
+  
+  //SQL_SUCCESS_WITH_INFO with a truncated value means there is more to read
+  *more = (ret == SQL_SUCCESS_WITH_INFO && *bytes > 0
+           && (len == SQL_NO_TOTAL || len > chunkMax));
+  
+  return SQL_SUCCESS;
+}
+
+/*
+ * GetDataChunkValue
+ *
+ * Wrap a chunk read by GetDataChunk in a Buffer that takes over its memory.
+ */
+
+Handle<Value> ODBCResult::GetDataChunkValue(unsigned char* buffer, SQLLEN bytes) {
+  NanEscapableScope();
+  
+  if (buffer == NULL) {
+    return NanEscapeScope(NanNull());
+  }
+  
+  return NanEscapeScope(NanNewBufferHandle((char *) buffer, (uint32_t) bytes,
+                                           ODBC::FreeColumnValue, NULL));
+}
+
+/*
+ * GetData
+ *
+ * getData(column, length, cb) reads the next chunk of a column left unread
+ * by fetch({ streamColumns : [...] }) and calls back with (err, chunk, more).
+ * chunk is null when there is nothing left to read.
+ */
+
+NAN_METHOD(ODBCResult::GetData) {
+  DEBUG_PRINTF("ODBCResult::GetData\n");
+  NanScope();
+  
+  ODBCResult* self = ObjectWrap::Unwrap<ODBCResult>(args.Holder());
+  
+  REQ_INT_ARG(0, column);
+  REQ_INT_ARG(1, length);
+  REQ_FUN_ARG(2, cb);
+  
+  if (column < 0 || column >= self->colCount) {
+    return NanThrowRangeError("ODBCResult::GetData(): column index out of range");
+  }
+  
+  if (length <= 0) {
+    return NanThrowRangeError("ODBCResult::GetData(): length must be greater than 0");
+  }
+  
+  uv_work_t* work_req = (uv_work_t *) (calloc(1, sizeof(uv_work_t)));
+  
+  getdata_work_data* data = (getdata_work_data *) calloc(1, sizeof(getdata_work_data));
+  
+  data->cb = new NanCallback(cb);
+  data->objResult = self;
+  data->column = column;
+  data->length = length;
+  
+  work_req->data = data;
+  
+  ODBC::QueueWork(
+    work_req, 
+    UV_GetData, 
+    (uv_after_work_cb)UV_AfterGetData);
+
+  self->Ref();
+  self->m_activeWork++;
+
+  NanReturnValue(NanUndefined());
+}
+
+void ODBCResult::UV_GetData(uv_work_t* work_req) {
+  DEBUG_PRINTF("ODBCResult::UV_GetData\n");
+  
+  getdata_work_data* data = (getdata_work_data *)(work_req->data);
+  
+  data->result = data->objResult->GetDataChunk(
+    data->column,
+    data->length,
+    &data->buffer,
+    &data->bytes,
+    &data->more);
+}
+
+void ODBCResult::UV_AfterGetData(uv_work_t* work_req, int status) {
+  DEBUG_PRINTF("ODBCResult::UV_AfterGetData\n");
+  NanScope();
+  
+  getdata_work_data* data = (getdata_work_data *)(work_req->data);
+  
+  ODBCResult* self = data->objResult->self();
+  
+  self->EndWork();
+  
+  Handle<Value> args[3];
+  
+  if (!SQL_SUCCEEDED(data->result)) {
+    args[0] = ODBC::GetSQLError(
+      SQL_HANDLE_STMT,
+      self->m_hSTMT,
+      (char *) "[node-odbc] Error in ODBCResult::GetData");
+    args[1] = NanNull();
+  }
+  else {
+    args[0] = NanNull();
+    args[1] = GetDataChunkValue(data->buffer, data->bytes);
+  }
+  
+  args[2] = NanNew<Boolean>(data->more);
+  
+  TryCatch try_catch;
+  
+  data->cb->Call(3, args);
+  delete data->cb;
+  
+  if (try_catch.HasCaught()) {
+    FatalException(try_catch);
   }
   
-  data->objResult->Unref();
+  self->Unref();
   
   free(data);
   free(work_req);
+}
+
+/*
+ * GetDataSync
+ *
+ * getDataSync(column, length) returns the next chunk of a column as a Buffer,
+ * or null when there is nothing left to read.
+ */
+
+NAN_METHOD(ODBCResult::GetDataSync) {
+  DEBUG_PRINTF("ODBCResult::GetDataSync\n");
+  NanScope();
   
-  return;
+  ODBCResult* self = ObjectWrap::Unwrap<ODBCResult>(args.Holder());
+  
+  REQ_INT_ARG(0, column);
+  REQ_INT_ARG(1, length);
+  
+  if (column < 0 || column >= self->colCount) {
+    return NanThrowRangeError("ODBCResult::GetDataSync(): column index out of range");
+  }
+  
+  if (length <= 0) {
+    return NanThrowRangeError("ODBCResult::GetDataSync(): length must be greater than 0");
+  }
+  
+  unsigned char* buffer = NULL;
+  SQLLEN bytes = 0;
+  bool more = false;
+  
+  SQLRETURN ret = self->GetDataChunk(column, length, &buffer, &bytes, &more);
+  
+  if (!SQL_SUCCEEDED(ret)) {
+    NanThrowError(ODBC::GetSQLError(
+      SQL_HANDLE_STMT,
+      self->m_hSTMT,
+      (char *) "[node-odbc] Error in ODBCResult::GetDataSync"));
+    
+    NanReturnUndefined();
+  }
+  
+  NanReturnValue(GetDataChunkValue(buffer, bytes));
 }
 
 /*
@@ -328,6 +921,8 @@ NAN_METHOD(ODBCResult::FetchSync) {
   bool moreWork = true;
   bool error = false;
   int fetchMode = objResult->m_fetchMode;
+  int dateMode = objResult->m_dateMode;
+  bool exactNumbers = objResult->m_exactNumbers;
   
   if (args.Length() == 1 && args[0]->IsObject()) {
     Local<Object> obj = args[0]->ToObject();
@@ -336,14 +931,15 @@ NAN_METHOD(ODBCResult::FetchSync) {
     if (obj->Has(fetchModeKey) && obj->Get(fetchModeKey)->IsInt32()) {
       fetchMode = obj->Get(fetchModeKey)->ToInt32()->Value();
     }
+    
+    dateMode = GetDateModeOption(obj, dateMode);
+    exactNumbers = GetExactNumbersOption(obj, exactNumbers);
   }
   
   SQLRETURN ret = SQLFetch(objResult->m_hSTMT);
 
   if (objResult->colCount == 0) {
-    objResult->columns = ODBC::GetColumns(
-      objResult->m_hSTMT, 
-      &objResult->colCount);
+    objResult->GetColumns();
   }
   
   //check to see if the result has no columns
@@ -368,6 +964,9 @@ NAN_METHOD(ODBCResult::FetchSync) {
   if (moreWork) {
     Handle<Value> data;
     
+    objResult->ApplyDateMode(dateMode);
+    objResult->ApplyExactNumbers(exactNumbers);
+    
     if (fetchMode == FETCH_ARRAY) {
       data = ODBC::GetRecordArray(
         objResult->m_hSTMT,
@@ -379,8 +978,7 @@ NAN_METHOD(ODBCResult::FetchSync) {
     else {
       data = ODBC::GetRecordTuple(
         objResult->m_hSTMT,
-        objResult->columns,
-        &objResult->colCount,
+        objResult->m_columnCache,
         objResult->buffer,
         objResult->bufferLength);
     }
@@ -388,7 +986,7 @@ NAN_METHOD(ODBCResult::FetchSync) {
     NanReturnValue(data);
   }
   else {
-    ODBC::FreeColumns(objResult->columns, &objResult->colCount);
+    objResult->FreeColumns();
 
     //if there was an error, pass that as arg[0] otherwise Null
     if (error) {
@@ -412,49 +1010,129 @@ NAN_METHOD(ODBCResult::FetchAll) {
   
   ODBCResult* objODBCResult = ObjectWrap::Unwrap<ODBCResult>(args.Holder());
   
-  uv_work_t* work_req = (uv_work_t *) (calloc(1, sizeof(uv_work_t)));
+  Local<Function> cb;
+  Local<Value> promise = NanUndefined();
   
-  fetch_work_data* data = (fetch_work_data *) calloc(1, sizeof(fetch_work_data));
+  //without a callback the rows settle the Promise that is returned instead
+  int argc = args.Length();
   
-  Local<Function> cb;
+  if (argc > 0 && args[argc - 1]->IsFunction()) {
+    cb = Local<Function>::Cast(args[argc - 1]);
+    argc--;
+  }
+  else if (!ODBC::NewPromiseCallback(&cb, &promise)) {
+    return NanThrowTypeError("ODBCResult::FetchAll(): 1 or 2 arguments are required. The last argument must be a callback function.");
+  }
   
-  data->fetchMode = objODBCResult->m_fetchMode;
+  if (argc == 0) {
+    objODBCResult->QueueFetchAll(cb, Local<Object>(), false);
+  }
+  else if (argc == 1 && args[0]->IsObject()) {
+    objODBCResult->QueueFetchAll(cb, args[0]->ToObject(), false);
+  }
+  else {
+    return NanThrowTypeError("ODBCResult::FetchAll(): Argument 0 must be an Object.");
+  }
+
+  NanReturnValue(promise);
+}
+
+/*
+ * FetchBatch
+ *
+ * Like FetchAll but calls back after a single chunk of rows with
+ * (err, rows, moreRows) so that the caller decides when to fetch the next
+ * chunk.
+ */
+
+NAN_METHOD(ODBCResult::FetchBatch) {
+  DEBUG_PRINTF("ODBCResult::FetchBatch\n");
+  NanScope();
+  
+  ODBCResult* objODBCResult = ObjectWrap::Unwrap<ODBCResult>(args.Holder());
   
   if (args.Length() == 1 && args[0]->IsFunction()) {
-    cb = Local<Function>::Cast(args[0]);
+    objODBCResult->QueueFetchAll(
+      Local<Function>::Cast(args[0]), 
+      Local<Object>(), 
+      true);
   }
   else if (args.Length() == 2 && args[0]->IsObject() && args[1]->IsFunction()) {
-    cb = Local<Function>::Cast(args[1]);  
-    
-    Local<Object> obj = args[0]->ToObject();
-    
+    objODBCResult->QueueFetchAll(
+      Local<Function>::Cast(args[1]), 
+      args[0]->ToObject(), 
+      true);
+  }
+  else {
+    return NanThrowTypeError("ODBCResult::FetchBatch(): 1 or 2 arguments are required. The last argument must be a callback function.");
+  }
+
+  NanReturnValue(NanUndefined());
+}
+
+/*
+ * QueueFetchAll
+ *
+ * Set up the work data for FetchAll/FetchBatch from the result's defaults
+ * and the options object (which may be empty) and queue the first chunk.
+ */
+
+void ODBCResult::QueueFetchAll(Local<Function> cb, Local<Object> obj, bool batch) {
+  uv_work_t* work_req = (uv_work_t *) (calloc(1, sizeof(uv_work_t)));
+  
+  fetch_work_data* data = (fetch_work_data *) calloc(1, sizeof(fetch_work_data));
+  
+  data->fetchMode = m_fetchMode;
+  data->chunkSize = m_chunkSize;
+  data->rowArraySize = m_rowArraySize;
+  data->dateMode = m_dateMode;
+  data->exactNumbers = m_exactNumbers;
+  data->batch = batch;
+  
+  if (!obj.IsEmpty()) {
     Local<String> fetchModeKey = NanNew<String>(OPTION_FETCH_MODE);
     if (obj->Has(fetchModeKey) && obj->Get(fetchModeKey)->IsInt32()) {
       data->fetchMode = obj->Get(fetchModeKey)->ToInt32()->Value();
     }
-  }
-  else {
-    NanThrowTypeError("ODBCResult::FetchAll(): 1 or 2 arguments are required. The last argument must be a callback function.");
+    
+    Local<String> chunkSizeKey = NanNew<String>(OPTION_CHUNK_SIZE);
+    if (obj->Has(chunkSizeKey) && obj->Get(chunkSizeKey)->IsInt32() 
+        && obj->Get(chunkSizeKey)->ToInt32()->Value() > 0) {
+      data->chunkSize = obj->Get(chunkSizeKey)->ToInt32()->Value();
+    }
+    
+    Local<String> rowArraySizeKey = NanNew<String>(OPTION_ROW_ARRAY_SIZE);
+    if (obj->Has(rowArraySizeKey) && obj->Get(rowArraySizeKey)->IsInt32() 
+        && obj->Get(rowArraySizeKey)->ToInt32()->Value() > 0) {
+      data->rowArraySize = obj->Get(rowArraySizeKey)->ToInt32()->Value();
+    }
+    
+    data->dateMode = GetDateModeOption(obj, data->dateMode);
+    data->exactNumbers = GetExactNumbersOption(obj, data->exactNumbers);
   }
   
   NanAssignPersistent(data->rows, NanNew<Array>());
   data->errorCount = 0;
   data->count = 0;
+  data->rowCount = 0;
+  data->rowData = NULL;
+  data->rowsFetched = 0;
+  data->rowStatus = NULL;
+  data->boundColumns = NULL;
+  data->columnBuffers = NULL;
   NanAssignPersistent(data->objError, NanNew<Object>());
   
   data->cb = new NanCallback(cb);
-  data->objResult = objODBCResult;
+  data->objResult = this;
   
   work_req->data = data;
   
-  uv_queue_work(uv_default_loop(),
-    work_req, 
+  ODBC::QueueWork(work_req, 
     UV_FetchAll, 
     (uv_after_work_cb)UV_AfterFetchAll);
 
   data->objResult->Ref();
-
-  NanReturnValue(NanUndefined());
+  m_activeWork++;
 }
 
 void ODBCResult::UV_FetchAll(uv_work_t* work_req) {
@@ -462,8 +1140,152 @@ void ODBCResult::UV_FetchAll(uv_work_t* work_req) {
   
   fetch_work_data* data = (fetch_work_data *)(work_req->data);
   
-  data->result = SQLFetch(data->objResult->m_hSTMT);
- }
+  ODBCResult* self = data->objResult->self();
+  
+  data->rowCount = 0;
+  
+  if (self->colCount == 0) {
+    self->GetColumns();
+  }
+  
+  //check to see if the result set has columns
+  if (self->colCount == 0) {
+    //this most likely means that the query was something like
+    //'insert into ....'
+    data->result = SQL_NO_DATA;
+    
+    return;
+  }
+  
+  self->ApplyExactNumbers(data->exactNumbers);
+  
+  //try to set up a block cursor the first time through. If the driver
+  //can't do it we quietly fall back to fetching one row at a time.
+  if (data->rowArraySize > 1 && data->boundColumns == NULL) {
+    data->rowStatus = (SQLUSMALLINT *) calloc(
+      data->rowArraySize, 
+      sizeof(SQLUSMALLINT));
+    
+    data->boundColumns = ODBC::BindColumns(
+      self->m_hDBC,
+      self->m_hSTMT,
+      self->columns,
+      &self->colCount,
+      data->rowArraySize,
+      &data->rowsFetched,
+      data->rowStatus);
+    
+    if (data->boundColumns == NULL) {
+      free(data->rowStatus);
+      data->rowStatus = NULL;
+      data->rowArraySize = 1;
+    }
+    else if (data->chunkSize < data->rowArraySize) {
+      //a whole rowset has to fit in a chunk
+      data->chunkSize = data->rowArraySize;
+    }
+  }
+  
+  //a large chunkSize may not fit in memory; fall back to smaller chunks,
+  //keeping room for a whole rowset
+  while (data->rowData == NULL) {
+    data->rowData = (ColumnData *) calloc(
+      (size_t) data->chunkSize * self->colCount, 
+      sizeof(ColumnData));
+    
+    if (data->rowData != NULL || data->chunkSize <= data->rowArraySize) {
+      break;
+    }
+    
+    data->chunkSize = (data->chunkSize / 2 > data->rowArraySize)
+      ? data->chunkSize / 2
+      : data->rowArraySize;
+  }
+  
+  if (data->rowData == NULL) {
+    data->result = SQL_ERROR;
+    data->outOfMemory = true;
+    
+    return;
+  }
+  
+  if (data->boundColumns != NULL) {
+    //fetch whole rowsets while they fit in what is left of this chunk
+    while (data->rowCount + data->rowArraySize <= data->chunkSize) {
+      data->result = SQLFetch(self->m_hSTMT);
+      
+      if (data->result == SQL_ERROR || data->result == SQL_NO_DATA) {
+        break;
+      }
+      
+      for (SQLULEN i = 0; i < data->rowsFetched; i++) {
+        if (data->rowStatus[i] == SQL_ROW_NOROW) {
+          continue;
+        }
+        
+        ColumnData* row = &data->rowData[data->rowCount * self->colCount];
+        
+        SQLRETURN ret = SQL_ERROR;
+        
+        if (data->rowStatus[i] != SQL_ROW_ERROR) {
+          ret = ODBC::GetBoundRecordData(
+            self->m_hSTMT,
+            self->columns,
+            &self->colCount,
+            data->boundColumns,
+            i,
+            row,
+            self->buffer,
+            self->bufferLength);
+        }
+        
+        if (!SQL_SUCCEEDED(ret)) {
+          //don't hand back a partial row
+          ODBC::FreeColumnData(row, self->colCount);
+          
+          data->result = SQL_ERROR;
+          
+          return;
+        }
+        
+        data->rowCount++;
+      }
+    }
+    
+    return;
+  }
+  
+  //fetch up to chunkSize rows into native memory so that the event loop
+  //thread only has to be woken up once per chunk instead of once per row
+  while (data->rowCount < data->chunkSize) {
+    data->result = SQLFetch(self->m_hSTMT);
+    
+    if (data->result == SQL_ERROR || data->result == SQL_NO_DATA) {
+      break;
+    }
+    
+    ColumnData* row = &data->rowData[data->rowCount * self->colCount];
+    
+    SQLRETURN ret = ODBC::GetRecordData(
+      self->m_hSTMT,
+      self->columns,
+      &self->colCount,
+      row,
+      self->buffer,
+      self->bufferLength);
+    
+    if (!SQL_SUCCEEDED(ret)) {
+      //don't hand back a partial row
+      ODBC::FreeColumnData(row, self->colCount);
+      
+      data->result = SQL_ERROR;
+      
+      break;
+    }
+    
+    data->rowCount++;
+  }
+}
 
 void ODBCResult::UV_AfterFetchAll(uv_work_t* work_req, int status) {
   DEBUG_PRINTF("ODBCResult::UV_AfterFetchAll\n");
@@ -475,8 +1297,40 @@ void ODBCResult::UV_AfterFetchAll(uv_work_t* work_req, int status) {
   
   bool doMoreWork = true;
   
-  if (self->colCount == 0) {
-    self->columns = ODBC::GetColumns(self->m_hSTMT, &self->colCount);
+  //convert the rows fetched by the worker thread to javascript values
+  if (data->rowCount > 0) {
+    Local<Array> rows = NanNew(data->rows);
+    
+    self->ApplyDateMode(data->dateMode);
+    
+    for (int i = 0; i < data->rowCount; i++) {
+      ColumnData* row = &data->rowData[i * self->colCount];
+      
+      if (data->fetchMode == FETCH_COLUMNS) {
+        if (data->columnBuffers == NULL) {
+          data->columnBuffers = ODBC::CreateColumnBuffers(self->colCount);
+        }
+        
+        ODBC::AppendColumnData(data->columnBuffers, self->columns, &self->colCount, row);
+      }
+      else if (data->fetchMode == FETCH_ARRAY) {
+        rows->Set(
+          NanNew(data->count), 
+          ODBC::GetRecordArray(self->columns, &self->colCount, row)
+        );
+      }
+      else {
+        rows->Set(
+          NanNew(data->count), 
+          ODBC::GetRecordTuple(self->m_columnCache, row)
+        );
+      }
+      
+      ODBC::FreeColumnData(row, self->colCount);
+      data->count++;
+    }
+    
+    data->rowCount = 0;
   }
   
   //check to see if the result set has columns
@@ -489,11 +1343,16 @@ void ODBCResult::UV_AfterFetchAll(uv_work_t* work_req, int status) {
   else if (data->result == SQL_ERROR)  {
     data->errorCount++;
     
-    NanAssignPersistent(data->objError, ODBC::GetSQLError(
-      SQL_HANDLE_STMT, 
-      self->m_hSTMT,
-      (char *) "[node-odbc] Error in ODBCResult::UV_AfterFetchAll"
-    ));
+    if (data->outOfMemory) {
+      NanAssignPersistent(data->objError, NewFetchError("Memory allocation error", "HY001"));
+    }
+    else {
+      NanAssignPersistent(data->objError, ODBC::GetSQLError(
+        SQL_HANDLE_STMT, 
+        self->m_hSTMT,
+        (char *) "[node-odbc] Error in ODBCResult::UV_AfterFetchAll"
+      ));
+    }
     
     doMoreWork = false;
   }
@@ -501,45 +1360,32 @@ void ODBCResult::UV_AfterFetchAll(uv_work_t* work_req, int status) {
   else if (data->result == SQL_NO_DATA) {
     doMoreWork = false;
   }
-  else {
-    Local<Array> rows = NanNew(data->rows);
-    if (data->fetchMode == FETCH_ARRAY) {
-      rows->Set(
-        NanNew(data->count), 
-        ODBC::GetRecordArray(
-          self->m_hSTMT,
-          self->columns,
-          &self->colCount,
-          self->buffer,
-          self->bufferLength)
-      );
-    }
-    else {
-      rows->Set(
-        NanNew(data->count), 
-        ODBC::GetRecordTuple(
-          self->m_hSTMT,
-          self->columns,
-          &self->colCount,
-          self->buffer,
-          self->bufferLength)
-      );
-    }
-    data->count++;
+  //Cancel was called between two chunks, when there was no SQLFetch for
+  //SQLCancel to interrupt
+  else if (self->m_canceled) {
+    data->errorCount++;
+    
+    NanAssignPersistent(data->objError, NewFetchError("Operation canceled", "HY008"));
+    
+    doMoreWork = false;
   }
   
-  if (doMoreWork) {
-    //Go back to the thread pool and fetch more data!
-    uv_queue_work(
-      uv_default_loop(),
+  if (doMoreWork && !data->batch) {
+    //Go back to the thread pool and fetch the next chunk
+    ODBC::QueueWork(
       work_req, 
       UV_FetchAll, 
       (uv_after_work_cb)UV_AfterFetchAll);
   }
   else {
-    ODBC::FreeColumns(self->columns, &self->colCount);
+    //a batch that filled its chunk stops here with the result set still
+    //open; the next FetchBatch binds the columns again if it needs to
+    if (data->boundColumns != NULL) {
+      ODBC::UnbindColumns(self->m_hSTMT, data->boundColumns, &self->colCount);
+      free(data->rowStatus);
+    }
     
-    Handle<Value> args[2];
+    Handle<Value> args[3];
     
     if (data->errorCount > 0) {
       args[0] = NanNew(data->objError);
@@ -548,11 +1394,30 @@ void ODBCResult::UV_AfterFetchAll(uv_work_t* work_req, int status) {
       args[0] = NanNull();
     }
     
-    args[1] = NanNew(data->rows);
+    //tells FetchBatch callers whether there are more rows to fetch
+    args[2] = NanNew<Boolean>(doMoreWork);
+    
+    if (data->fetchMode == FETCH_COLUMNS) {
+      //the column names are needed, so this has to happen before FreeColumns
+      args[1] = self->GetColumnBuffersObject(data->columnBuffers);
+      
+      if (data->columnBuffers != NULL) {
+        ODBC::FreeColumnBuffers(data->columnBuffers, self->colCount);
+      }
+    }
+    else {
+      args[1] = NanNew(data->rows);
+    }
+    
+    if (!doMoreWork) {
+      self->FreeColumns();
+    }
+    
+    self->EndWork();
 
     TryCatch try_catch;
 
-    data->cb->Call(2, args);
+    data->cb->Call(data->batch ? 3 : 2, args);
     delete data->cb;
     NanDisposePersistent(data->rows);
     NanDisposePersistent(data->objError);
@@ -561,6 +1426,7 @@ void ODBCResult::UV_AfterFetchAll(uv_work_t* work_req, int status) {
       FatalException(try_catch);
     }
 
+    free(data->rowData);
     free(data);
     free(work_req);
 
@@ -568,6 +1434,27 @@ void ODBCResult::UV_AfterFetchAll(uv_work_t* work_req, int status) {
   }
 }
 
+/*
+ * NewFetchError
+ *
+ * An error object shaped like the ones GetSQLError builds, for fetchAll
+ * failures that did not come from the driver.
+ */
+
+Local<Object> ODBCResult::NewFetchError(const char* message, const char* state) {
+  NanEscapableScope();
+  
+  Local<Object> objError = NanNew<Object>();
+  
+  objError->SetPrototype(Exception::Error(NanNew(message)));
+  objError->Set(NanNew("error"), NanNew("[node-odbc] Error in ODBCResult::UV_AfterFetchAll"));
+  objError->Set(NanNew("message"), NanNew(message));
+  objError->Set(NanNew("state"), NanNew(state));
+  objError->Set(NanNew("errors"), NanNew<Array>());
+  
+  return NanEscapeScope(objError);
+}
+
 /*
  * FetchAllSync
  */
@@ -584,6 +1471,8 @@ NAN_METHOD(ODBCResult::FetchAllSync) {
   int count = 0;
   int errorCount = 0;
   int fetchMode = self->m_fetchMode;
+  int dateMode = self->m_dateMode;
+  bool exactNumbers = self->m_exactNumbers;
 
   if (args.Length() == 1 && args[0]->IsObject()) {
     Local<Object> obj = args[0]->ToObject();
@@ -592,13 +1481,27 @@ NAN_METHOD(ODBCResult::FetchAllSync) {
     if (obj->Has(fetchModeKey) && obj->Get(fetchModeKey)->IsInt32()) {
       fetchMode = obj->Get(fetchModeKey)->ToInt32()->Value();
     }
+    
+    dateMode = GetDateModeOption(obj, dateMode);
+    exactNumbers = GetExactNumbersOption(obj, exactNumbers);
   }
   
   if (self->colCount == 0) {
-    self->columns = ODBC::GetColumns(self->m_hSTMT, &self->colCount);
+    self->GetColumns();
   }
   
+  self->ApplyDateMode(dateMode);
+  self->ApplyExactNumbers(exactNumbers);
+  
   Local<Array> rows = NanNew<Array>();
+  Local<Object> columnsObject;
+  ColumnBuffer* columnBuffers = NULL;
+  ColumnData* row = NULL;
+  
+  if (fetchMode == FETCH_COLUMNS && self->colCount > 0) {
+    columnBuffers = ODBC::CreateColumnBuffers(self->colCount);
+    row = (ColumnData *) calloc(self->colCount, sizeof(ColumnData));
+  }
   
   //Only loop through the recordset if there are columns
   if (self->colCount > 0) {
@@ -622,12 +1525,36 @@ NAN_METHOD(ODBCResult::FetchAllSync) {
       
       //check to see if we are at the end of the recordset
       if (ret == SQL_NO_DATA) {
-        ODBC::FreeColumns(self->columns, &self->colCount);
-        
         break;
       }
 
-      if (fetchMode == FETCH_ARRAY) {
+      if (fetchMode == FETCH_COLUMNS) {
+        ret = ODBC::GetRecordData(
+          self->m_hSTMT,
+          self->columns,
+          &self->colCount,
+          row,
+          self->buffer,
+          self->bufferLength);
+        
+        if (!SQL_SUCCEEDED(ret)) {
+          ODBC::FreeColumnData(row, self->colCount);
+          
+          errorCount++;
+          
+          objError = ODBC::GetSQLError(
+            SQL_HANDLE_STMT, 
+            self->m_hSTMT,
+            (char *) "[node-odbc] Error in ODBCResult::FetchAllSync"
+          );
+          
+          break;
+        }
+        
+        ODBC::AppendColumnData(columnBuffers, self->columns, &self->colCount, row);
+        ODBC::FreeColumnData(row, self->colCount);
+      }
+      else if (fetchMode == FETCH_ARRAY) {
         rows->Set(
           NanNew(count), 
           ODBC::GetRecordArray(
@@ -643,8 +1570,7 @@ NAN_METHOD(ODBCResult::FetchAllSync) {
           NanNew(count), 
           ODBC::GetRecordTuple(
             self->m_hSTMT,
-            self->columns,
-            &self->colCount,
+            self->m_columnCache,
             self->buffer,
             self->bufferLength)
         );
@@ -652,8 +1578,19 @@ NAN_METHOD(ODBCResult::FetchAllSync) {
       count++;
     }
   }
-  else {
-    ODBC::FreeColumns(self->columns, &self->colCount);
+  
+  if (fetchMode == FETCH_COLUMNS) {
+    columnsObject = self->GetColumnBuffersObject(columnBuffers);
+    
+    if (columnBuffers != NULL) {
+      ODBC::FreeColumnBuffers(columnBuffers, self->colCount);
+      free(row);
+    }
+  }
+  
+  //the error case keeps the columns, as it always has
+  if (errorCount == 0) {
+    self->FreeColumns();
   }
   
   //throw the error object if there were errors
@@ -661,6 +1598,10 @@ NAN_METHOD(ODBCResult::FetchAllSync) {
     NanThrowError(objError);
   }
   
+  if (fetchMode == FETCH_COLUMNS) {
+    NanReturnValue(columnsObject);
+  }
+  
   NanReturnValue(rows);
 }
 
@@ -685,18 +1626,21 @@ NAN_METHOD(ODBCResult::CloseSync) {
   }
   else if (closeOption == SQL_DESTROY && !result->m_canFreeHandle) {
     //We technically can't free the handle so, we'll SQL_CLOSE
-    uv_mutex_lock(&ODBC::g_odbcMutex);
+    bool locked = ODBC::GlobalLock();
     
     SQLFreeStmt(result->m_hSTMT, SQL_CLOSE);
   
-    uv_mutex_unlock(&ODBC::g_odbcMutex);
+    ODBC::GlobalUnlock(locked);
+    
+    //nothing more will be fetched; give the buffer back to the pool
+    result->ReleaseBuffer();
   }
   else {
-    uv_mutex_lock(&ODBC::g_odbcMutex);
+    bool locked = ODBC::GlobalLock();
     
     SQLFreeStmt(result->m_hSTMT, closeOption);
   
-    uv_mutex_unlock(&ODBC::g_odbcMutex);
+    ODBC::GlobalUnlock(locked);
   }
   
   NanReturnValue(NanTrue());
@@ -730,7 +1674,7 @@ NAN_METHOD(ODBCResult::GetColumnNamesSync) {
   Local<Array> cols = NanNew<Array>();
   
   if (self->colCount == 0) {
-    self->columns = ODBC::GetColumns(self->m_hSTMT, &self->colCount);
+    self->GetColumns();
   }
   
   for (int i = 0; i < self->colCount; i++) {
@@ -740,3 +1684,42 @@ NAN_METHOD(ODBCResult::GetColumnNamesSync) {
     
   NanReturnValue(cols);
 }
+
+/*
+ * Cancel
+ * 
+ * Stop a fetch that is running on a worker thread. The fetch then fails
+ * with HY008; fetchAll stops at the end of the current chunk if the driver
+ * did not interrupt it. Returns whether there was a fetch to cancel.
+ */
+
+NAN_METHOD(ODBCResult::Cancel) {
+  DEBUG_PRINTF("ODBCResult::Cancel\n");
+  NanScope();
+  
+  ODBCResult* self = ObjectWrap::Unwrap<ODBCResult>(args.Holder());
+  
+  //SQLCancel succeeds on an idle statement without doing anything
+  if (!self->m_hSTMT || self->m_activeWork == 0) {
+    NanReturnValue(NanFalse());
+  }
+  
+  self->m_canceled = true;
+  
+  SQLCancel(self->m_hSTMT);
+  
+  NanReturnValue(NanTrue());
+}
+
+/*
+ * EndWork
+ *
+ * Called on the event loop thread when a queued fetch is about to call back.
+ * A Cancel only applies to the fetches that were running when it was called.
+ */
+
+void ODBCResult::EndWork() {
+  if (--m_activeWork == 0) {
+    m_canceled = false;
+  }
+}
@@ -22,6 +22,11 @@
 class ODBCResult : public node::ObjectWrap {
   public:
    static Persistent<String> OPTION_FETCH_MODE;
+   static Persistent<String> OPTION_CHUNK_SIZE;
+   static Persistent<String> OPTION_ROW_ARRAY_SIZE;
+   static Persistent<String> OPTION_DATE_MODE;
+   static Persistent<String> OPTION_EXACT_NUMBERS;
+   static Persistent<String> OPTION_STREAM_COLUMNS;
    static Persistent<Function> constructor;
    static void Init(v8::Handle<Object> exports);
    
@@ -35,7 +40,8 @@ class ODBCResult : public node::ObjectWrap {
       m_hENV(hENV),
       m_hDBC(hDBC),
       m_hSTMT(hSTMT),
-      m_canFreeHandle(canFreeHandle) {};
+      m_canFreeHandle(canFreeHandle),
+      m_statementPool(NULL) {};
      
     ~ODBCResult();
 
@@ -51,16 +57,32 @@ class ODBCResult : public node::ObjectWrap {
     static void UV_FetchAll(uv_work_t* work_req);
     static void UV_AfterFetchAll(uv_work_t* work_req, int status);
     
+    static NAN_METHOD(FetchBatch);
+    
+    static NAN_METHOD(GetData);
+    static void UV_GetData(uv_work_t* work_req);
+    static void UV_AfterGetData(uv_work_t* work_req, int status);
+    
     //sync methods
     static NAN_METHOD(CloseSync);
     static NAN_METHOD(MoreResultsSync);
     static NAN_METHOD(FetchSync);
     static NAN_METHOD(FetchAllSync);
     static NAN_METHOD(GetColumnNamesSync);
+    static NAN_METHOD(GetDataSync);
+    static NAN_METHOD(Cancel);
     
     //property getter/setters
     static NAN_GETTER(FetchModeGetter);
     static NAN_SETTER(FetchModeSetter);
+    static NAN_GETTER(ChunkSizeGetter);
+    static NAN_SETTER(ChunkSizeSetter);
+    static NAN_GETTER(RowArraySizeGetter);
+    static NAN_SETTER(RowArraySizeSetter);
+    static NAN_GETTER(DateModeGetter);
+    static NAN_SETTER(DateModeSetter);
+    static NAN_GETTER(ExactNumbersGetter);
+    static NAN_SETTER(ExactNumbersSetter);
     
     struct fetch_work_data {
       NanCallback* cb;
@@ -68,25 +90,90 @@ class ODBCResult : public node::ObjectWrap {
       SQLRETURN result;
       
       int fetchMode;
+      int dateMode;
+      bool exactNumbers;
       int count;
       int errorCount;
+      
+      //rows fetched by the worker thread for the current chunk
+      int chunkSize;
+      int rowCount;
+      
+      //columns from this index on are left unread so that they can be
+      //streamed with GetData; -1 reads every column
+      int streamFrom;
+      
+      //call back after the first chunk instead of fetching everything
+      bool batch;
+      ColumnData *rowData;
+      
+      //the rows of even the smallest chunk could not be allocated
+      bool outOfMemory;
+      
+      //block cursor state; rowArraySize of 1 means SQLFetch returns one row
+      int rowArraySize;
+      SQLULEN rowsFetched;
+      SQLUSMALLINT *rowStatus;
+      BoundColumn *boundColumns;
+      
+      //FETCH_COLUMNS accumulates every chunk here
+      ColumnBuffer *columnBuffers;
+      
       Persistent<Array> rows;
       Persistent<Object> objError;
     };
     
+    struct getdata_work_data {
+      NanCallback* cb;
+      ODBCResult *objResult;
+      SQLRETURN result;
+      
+      int column;
+      SQLLEN length;
+      unsigned char *buffer;
+      SQLLEN bytes;
+      bool more;
+    };
+    
     ODBCResult *self(void) { return this; }
+    
+    void GetColumns();
+    void FreeColumns();
+    void ApplyDateMode(int dateMode);
+    static int GetDateModeOption(Local<Object> options, int dateMode);
+    void ApplyExactNumbers(bool exactNumbers);
+    static bool GetExactNumbersOption(Local<Object> options, bool exactNumbers);
+    void QueueFetchAll(Local<Function> cb, Local<Object> options, bool batch);
+    SQLRETURN GetDataChunk(int column, SQLLEN length, unsigned char** buffer, SQLLEN* bytes, bool* more);
+    static Handle<Value> GetDataChunkValue(unsigned char* buffer, SQLLEN bytes);
+    static Local<Object> NewFetchError(const char* message, const char* state);
+    Local<Object> GetColumnBuffersObject(ColumnBuffer* buffers);
+    void AcquireBuffer();
+    void ReleaseBuffer();
+    void EndWork();
 
   protected:
     HENV m_hENV;
     HDBC m_hDBC;
     HSTMT m_hSTMT;
     bool m_canFreeHandle;
+    StatementPool *m_statementPool;
     int m_fetchMode;
+    int m_chunkSize;
+    int m_rowArraySize;
+    int m_dateMode;
+    bool m_exactNumbers;
     
     uint16_t *buffer;
     int bufferLength;
     Column *columns;
     short colCount;
+    ColumnCache *m_columnCache;
+    
+    //fetches queued on the thread pool and whether Cancel was called while
+    //they run. Only touched on the event loop thread.
+    int m_activeWork;
+    bool m_canceled;
 };
 
 
@@ -61,6 +61,15 @@ void ODBCStatement::Init(v8::Handle<Object> exports) {
   NODE_SET_PROTOTYPE_METHOD(t, "bind", Bind);
   NODE_SET_PROTOTYPE_METHOD(t, "bindSync", BindSync);
   
+  NODE_SET_PROTOTYPE_METHOD(t, "executeBatch", ExecuteBatch);
+  NODE_SET_PROTOTYPE_METHOD(t, "executeBatchSync", ExecuteBatchSync);
+  
+  NODE_SET_PROTOTYPE_METHOD(t, "paramData", ParamData);
+  NODE_SET_PROTOTYPE_METHOD(t, "putData", PutData);
+  
+  NODE_SET_PROTOTYPE_METHOD(t, "setQueryTimeoutSync", SetQueryTimeoutSync);
+  NODE_SET_PROTOTYPE_METHOD(t, "cancel", Cancel);
+  
   NODE_SET_PROTOTYPE_METHOD(t, "closeSync", CloseSync);
 
   // Attach the Database Constructor to the target object
@@ -75,40 +84,312 @@ ODBCStatement::~ODBCStatement() {
 void ODBCStatement::Free() {
   DEBUG_PRINTF("ODBCStatement::Free\n");
   //if we previously had parameters, then be sure to free them
-  if (paramCount) {
-    int count = paramCount;
-    paramCount = 0;
-    
-    Parameter prm;
-    
-    //free parameter memory
-    for (int i = 0; i < count; i++) {
-      if (prm = params[i], prm.ParameterValuePtr != NULL) {
-        switch (prm.ValueType) {
-          case SQL_C_WCHAR:   free(prm.ParameterValuePtr);             break;
-          case SQL_C_CHAR:    free(prm.ParameterValuePtr);             break; 
-          case SQL_C_SBIGINT: delete (int64_t *)prm.ParameterValuePtr; break;
-          case SQL_C_DOUBLE:  delete (double  *)prm.ParameterValuePtr; break;
-          case SQL_C_BIT:     delete (bool    *)prm.ParameterValuePtr; break;
-        }
-      }
-    }
-
-    free(params);
-  }
+  FreeParameters();
+  
+  free(m_paramTypes);
+  m_paramTypes = NULL;
+  m_paramTypeCount = 0;
+  
+  ClearColumnCache();
   
   if (m_hSTMT) {
-    uv_mutex_lock(&ODBC::g_odbcMutex);
+    bool locked = ODBC::GlobalLock();
     
     SQLFreeHandle(SQL_HANDLE_STMT, m_hSTMT);
     m_hSTMT = NULL;
     
-    uv_mutex_unlock(&ODBC::g_odbcMutex);
+    ODBC::GlobalUnlock(locked);
+  }
+}
+
+/*
+ * ClearColumnCache
+ *
+ * Forget the described columns, e.g. because a different statement is
+ * about to be prepared. Results still using them keep their reference.
+ */
+
+void ODBCStatement::ClearColumnCache() {
+  if (m_columnCache != NULL) {
+    ODBC::ReleaseColumnCache(m_columnCache);
+    
+    m_columnCache = NULL;
+  }
+  
+  ReleaseStaleColumnCache();
+}
+
+/*
+ * ReleaseStaleColumnCache
+ *
+ * Release the cache that DescribeColumns replaced on the thread pool; that
+ * has to happen on the event loop thread because of the V8 names.
+ */
+
+void ODBCStatement::ReleaseStaleColumnCache() {
+  if (m_staleColumnCache != NULL) {
+    ODBC::ReleaseColumnCache(m_staleColumnCache);
+    
+    m_staleColumnCache = NULL;
+  }
+}
+
+/*
+ * IsColumnCacheCurrent
+ *
+ * Check the cached columns against the current result set. The column types
+ * of something like `select ? as x` follow the types of the bound
+ * parameters, so they can change between executions of the same statement.
+ * Comparing the column count and types is much cheaper than describing the
+ * columns again. Safe to call from the thread pool.
+ */
+
+bool ODBCStatement::IsColumnCacheCurrent() {
+  SQLSMALLINT colCount = 0;
+  
+  SQLRETURN ret = SQLNumResultCols(m_hSTMT, &colCount);
+  
+  if (!SQL_SUCCEEDED(ret) || colCount != m_columnCache->colCount) {
+    return false;
+  }
+  
+  for (int i = 0; i < colCount; i++) {
+    SQLLEN type = 0;
+    
+    ret = SQLColAttribute( m_hSTMT,
+                           m_columnCache->columns[i].index,
+                           SQL_DESC_TYPE,
+                           NULL,
+                           0,
+                           NULL,
+                           &type);
+    
+    if (!SQL_SUCCEEDED(ret) || type != m_columnCache->columns[i].type) {
+      return false;
+    }
+  }
+  
+  return true;
+}
+
+/*
+ * DescribeColumns
+ *
+ * Describe the result set columns after the first successful execute so
+ * that later executions of the same prepared statement can skip it. Safe to
+ * call from the thread pool.
+ */
+
+void ODBCStatement::DescribeColumns() {
+  if (m_columnCache != NULL) {
+    if (IsColumnCacheCurrent()) {
+      return;
+    }
+    
+    DEBUG_PRINTF("ODBCStatement::DescribeColumns - result columns changed\n");
+    
+    //every completed execute releases the stale cache on the event loop
+    //thread before the next one can start, so there is never one left here
+    m_staleColumnCache = m_columnCache;
+    m_columnCache = NULL;
+  }
+  
+  short colCount = 0;
+  Column* columns = ODBC::GetColumns(m_hSTMT, &colCount);
+  
+  if (colCount > 0) {
+    m_columnCache = ODBC::CreateColumnCache(columns, colCount);
+  }
+  else {
+    ODBC::FreeColumns(columns, &colCount);
+  }
+}
+
+/*
+ * NewResult
+ *
+ * Create the ODBCResult for the current result set of this statement,
+ * handing it the cached column descriptors if there are any.
+ */
+
+Local<Object> ODBCStatement::NewResult() {
+  NanEscapableScope();
+  
+  Local<Value> args[5];
+  bool* canFreeHandle = new bool(false);
+  int argc = 4;
+  
+  args[0] = NanNew<External>(m_hENV);
+  args[1] = NanNew<External>(m_hDBC);
+  args[2] = NanNew<External>(m_hSTMT);
+  args[3] = NanNew<External>(canFreeHandle);
+  
+  if (m_columnCache != NULL) {
+    args[4] = NanNew<External>(m_columnCache);
+    argc = 5;
+  }
+  
+  return NanEscapeScope(NanNew(ODBCResult::constructor)->NewInstance(argc, args));
+}
+
+/*
+ * DescribeParameters
+ *
+ * Ask the driver for the SQL types of the parameter markers of a newly
+ * prepared statement. Drivers that can't describe them leave the types to
+ * be guessed from the values. Safe to call from the thread pool.
+ */
+
+void ODBCStatement::DescribeParameters() {
+  ClearParameterTypes();
+  
+  SQLSMALLINT count = 0;
+  SQLSMALLINT nullable;
+  
+  if (!SQL_SUCCEEDED(SQLNumParams(m_hSTMT, &count)) || count <= 0) {
+    return;
+  }
+  
+  ParameterDescription* types = 
+    (ParameterDescription *) calloc(count, sizeof(ParameterDescription));
+  
+  for (int i = 0; i < count; i++) {
+    SQLRETURN ret = SQLDescribeParam(
+      m_hSTMT,
+      i + 1,
+      &types[i].DataType,
+      &types[i].ParameterSize,
+      &types[i].DecimalDigits,
+      &nullable);
+    
+    if (!SQL_SUCCEEDED(ret)) {
+      DEBUG_PRINTF("ODBCStatement::DescribeParameters - param[%i] can't be described\n", i);
+      
+      free(types);
+      return;
+    }
+  }
+  
+  m_paramTypes = types;
+  m_paramTypeCount = count;
+}
+
+/*
+ * ClearParameterTypes
+ *
+ * Forget the parameter types of the previous statement. Parameters bound
+ * with them are rebuilt by the next bind.
+ */
+
+void ODBCStatement::ClearParameterTypes() {
+  free(m_paramTypes);
+  
+  m_paramTypes = NULL;
+  m_paramTypeCount = 0;
+  
+  for (int i = 0; i < paramCount; i++) {
+    m_paramBound[i] = false;
+  }
+}
+
+/*
+ * SetParameters
+ *
+ * Take the values of the next execution. If the statement is already bound
+ * with the same number of parameters, each value is written over the
+ * previous one in place and only parameters whose type changed or whose
+ * value outgrew its buffer are rebuilt. Otherwise all of the parameters are
+ * rebuilt. Call BindParameters afterwards.
+ */
+
+void ODBCStatement::SetParameters(Local<Array> values) {
+  int count = values->Length();
+  
+  if (count != paramCount || params == NULL) {
+    FreeParameters();
+    
+    params = ODBC::GetParametersFromArray(
+      values,
+      &paramCount,
+      m_paramTypes,
+      m_paramTypeCount);
+    m_paramBound = (bool *) calloc(paramCount > 0 ? paramCount : 1, sizeof(bool));
+    
+    return;
+  }
+  
+  for (int i = 0; i < count; i++) {
+    Local<Value> value = values->Get(i);
+    
+    if (!m_paramBound[i] || !ODBC::SetParameterValue(value, &params[i])) {
+      ODBC::FreeParameter(&params[i]);
+      ODBC::GetParameterFromValue(
+        value,
+        &params[i],
+        i,
+        (i < m_paramTypeCount) ? &m_paramTypes[i] : NULL);
+      
+      m_paramBound[i] = false;
+    }
+  }
+}
+
+/*
+ * BindParameters
+ *
+ * SQLBindParameter the parameters that are not bound yet. Safe to call from
+ * the thread pool.
+ */
+
+SQLRETURN ODBCStatement::BindParameters() {
+  SQLRETURN ret = SQL_SUCCESS;
+  
+  for (int i = 0; i < paramCount; i++) {
+    if (m_paramBound[i]) {
+      continue;
+    }
+    
+    Parameter* prm = &params[i];
+    
+    ret = SQLBindParameter(
+      m_hSTMT,            //StatementHandle
+      i + 1,              //ParameterNumber
+      SQL_PARAM_INPUT,    //InputOutputType
+      prm->ValueType,
+      prm->ParameterType,
+      prm->ColumnSize,
+      prm->DecimalDigits,
+      prm->ParameterValuePtr,
+      prm->BufferLength,
+      &prm->StrLen_or_IndPtr);
+
+    if (ret == SQL_ERROR) {
+      break;
+    }
     
-    if (bufferLength > 0) {
-      free(buffer);
+    m_paramBound[i] = true;
+  }
+  
+  return ret;
+}
+
+/*
+ * FreeParameters
+ */
+
+void ODBCStatement::FreeParameters() {
+  if (paramCount) {
+    for (int i = 0; i < paramCount; i++) {
+      ODBC::FreeParameter(&params[i]);
     }
   }
+  
+  free(params);
+  free(m_paramBound);
+  
+  params = NULL;
+  m_paramBound = NULL;
+  paramCount = 0;
 }
 
 NAN_METHOD(ODBCStatement::New) {
@@ -126,18 +407,20 @@ NAN_METHOD(ODBCStatement::New) {
   //create a new OBCResult object
   ODBCStatement* stmt = new ODBCStatement(hENV, hDBC, hSTMT);
   
-  //specify the buffer length
-  stmt->bufferLength = MAX_VALUE_SIZE - 1;
+  //columns are described on the first execute
+  stmt->m_columnCache = NULL;
+  stmt->m_staleColumnCache = NULL;
   
-  //initialze a buffer for this object
-  stmt->buffer = (uint16_t *) malloc(stmt->bufferLength + 1);
-  //TODO: make sure the malloc succeeded
-
-  //set the initial colCount to 0
-  stmt->colCount = 0;
+  //nothing to cancel yet
+  stmt->m_activeWork = 0;
+  stmt->m_needData = false;
   
   //initialize the paramCount
   stmt->paramCount = 0;
+  stmt->params = NULL;
+  stmt->m_paramBound = NULL;
+  stmt->m_paramTypes = NULL;
+  stmt->m_paramTypeCount = 0;
   
   stmt->Wrap(args.Holder());
   
@@ -153,7 +436,7 @@ NAN_METHOD(ODBCStatement::Execute) {
   
   NanScope();
 
-  REQ_FUN_ARG(0, cb);
+  REQ_FUN_OR_PROMISE_ARG(0, cb, promise);
 
   ODBCStatement* stmt = ObjectWrap::Unwrap<ODBCStatement>(args.Holder());
   
@@ -167,15 +450,15 @@ NAN_METHOD(ODBCStatement::Execute) {
   data->stmt = stmt;
   work_req->data = data;
   
-  uv_queue_work(
-    uv_default_loop(),
+  ODBC::QueueWork(
     work_req,
     UV_Execute,
     (uv_after_work_cb)UV_AfterExecute);
 
   stmt->Ref();
+  stmt->m_activeWork++;
 
-  NanReturnValue(NanUndefined());
+  NanReturnValue(promise);
 }
 
 void ODBCStatement::UV_Execute(uv_work_t* req) {
@@ -187,6 +470,10 @@ void ODBCStatement::UV_Execute(uv_work_t* req) {
   
   ret = SQLExecute(data->stmt->m_hSTMT); 
 
+  if (SQL_SUCCEEDED(ret)) {
+    data->stmt->DescribeColumns();
+  }
+
   data->result = ret;
 }
 
@@ -199,6 +486,11 @@ void ODBCStatement::UV_AfterExecute(uv_work_t* req, int status) {
   
   //an easy reference to the statment object
   ODBCStatement* self = data->stmt->self();
+  
+  self->m_activeWork--;
+  self->m_needData = (data->result == SQL_NEED_DATA);
+  
+  self->ReleaseStaleColumnCache();
 
   //First thing, let's check if the execution of the query returned any errors 
   if(data->result == SQL_ERROR) {
@@ -207,16 +499,27 @@ void ODBCStatement::UV_AfterExecute(uv_work_t* req, int status) {
       self->m_hSTMT,
       data->cb);
   }
-  else {
-    Local<Value> args[4];
-    bool* canFreeHandle = new bool(false);
+  //data-at-execution parameters are waiting; the caller sends them with
+  //paramData and putData
+  else if (data->result == SQL_NEED_DATA) {
+    Local<Value> args[3];
 
-    args[0] = NanNew<External>(self->m_hENV);
-    args[1] = NanNew<External>(self->m_hDBC);
-    args[2] = NanNew<External>(self->m_hSTMT);
-    args[3] = NanNew<External>(canFreeHandle);
+    args[0] = NanNew<Value>(NanNull());
+    args[1] = NanNew<Value>(NanNull());
+    args[2] = NanNew<Value>(NanTrue());
+
+    TryCatch try_catch;
+
+    data->cb->Call(3, args);
+
+    if (try_catch.HasCaught()) {
+      FatalException(try_catch);
+    }
+  }
+  else {
+    Local<Value> args[2];
     
-    Local<Object> js_result = NanNew(ODBCResult::constructor)->NewInstance(4, args);
+    Local<Object> js_result = self->NewResult();
 
     args[0] = NanNew<Value>(NanNull());
     args[1] = NanNew(js_result);
@@ -251,7 +554,15 @@ NAN_METHOD(ODBCStatement::ExecuteSync) {
 
   SQLRETURN ret = SQLExecute(stmt->m_hSTMT); 
   
-  if(ret == SQL_ERROR) {
+  if (ret == SQL_NEED_DATA) {
+    //there is no way to feed data-at-execution parameters from here
+    SQLCancel(stmt->m_hSTMT);
+    
+    NanThrowError("[node-odbc] Streamed parameters require the asynchronous execute");
+    
+    NanReturnValue(NanNull());
+  }
+  else if(ret == SQL_ERROR) {
     NanThrowError(ODBC::GetSQLError(
       SQL_HANDLE_STMT,
       stmt->m_hSTMT,
@@ -261,17 +572,10 @@ NAN_METHOD(ODBCStatement::ExecuteSync) {
     NanReturnValue(NanNull());
   }
   else {
-    Local<Value> result[4];
-    bool* canFreeHandle = new bool(false);
-    
-    result[0] = NanNew<External>(stmt->m_hENV);
-    result[1] = NanNew<External>(stmt->m_hDBC);
-    result[2] = NanNew<External>(stmt->m_hSTMT);
-    result[3] = NanNew<External>(canFreeHandle);
+    stmt->DescribeColumns();
+    stmt->ReleaseStaleColumnCache();
     
-    Local<Object> js_result = NanNew(ODBCResult::constructor)->NewInstance(4, result);
-
-    NanReturnValue(js_result);
+    NanReturnValue(stmt->NewResult());
   }
 }
 
@@ -284,7 +588,7 @@ NAN_METHOD(ODBCStatement::ExecuteNonQuery) {
   
   NanScope();
 
-  REQ_FUN_ARG(0, cb);
+  REQ_FUN_OR_PROMISE_ARG(0, cb, promise);
 
   ODBCStatement* stmt = ObjectWrap::Unwrap<ODBCStatement>(args.Holder());
   
@@ -298,15 +602,15 @@ NAN_METHOD(ODBCStatement::ExecuteNonQuery) {
   data->stmt = stmt;
   work_req->data = data;
   
-  uv_queue_work(
-    uv_default_loop(),
+  ODBC::QueueWork(
     work_req,
     UV_ExecuteNonQuery,
     (uv_after_work_cb)UV_AfterExecuteNonQuery);
 
   stmt->Ref();
+  stmt->m_activeWork++;
   
-  NanReturnValue(NanUndefined());
+  NanReturnValue(promise);
 }
 
 void ODBCStatement::UV_ExecuteNonQuery(uv_work_t* req) {
@@ -330,6 +634,9 @@ void ODBCStatement::UV_AfterExecuteNonQuery(uv_work_t* req, int status) {
   
   //an easy reference to the statment object
   ODBCStatement* self = data->stmt->self();
+  
+  self->m_activeWork--;
+  self->m_needData = (data->result == SQL_NEED_DATA);
 
   //First thing, let's check if the execution of the query returned any errors 
   if(data->result == SQL_ERROR) {
@@ -338,6 +645,23 @@ void ODBCStatement::UV_AfterExecuteNonQuery(uv_work_t* req, int status) {
       self->m_hSTMT,
       data->cb);
   }
+  //data-at-execution parameters are waiting; the caller sends them with
+  //paramData and putData
+  else if (data->result == SQL_NEED_DATA) {
+    Local<Value> args[3];
+
+    args[0] = NanNew<Value>(NanNull());
+    args[1] = NanNew<Value>(NanNull());
+    args[2] = NanNew<Value>(NanTrue());
+
+    TryCatch try_catch;
+
+    data->cb->Call(3, args);
+
+    if (try_catch.HasCaught()) {
+      FatalException(try_catch);
+    }
+  }
   else {
     SQLLEN rowCount = 0;
     
@@ -347,9 +671,9 @@ void ODBCStatement::UV_AfterExecuteNonQuery(uv_work_t* req, int status) {
       rowCount = 0;
     }
     
-    uv_mutex_lock(&ODBC::g_odbcMutex);
+    bool locked = ODBC::GlobalLock();
     SQLFreeStmt(self->m_hSTMT, SQL_CLOSE);
-    uv_mutex_unlock(&ODBC::g_odbcMutex);
+    ODBC::GlobalUnlock(locked);
     
     Local<Value> args[2];
 
@@ -387,7 +711,15 @@ NAN_METHOD(ODBCStatement::ExecuteNonQuerySync) {
 
   SQLRETURN ret = SQLExecute(stmt->m_hSTMT); 
   
-  if(ret == SQL_ERROR) {
+  if (ret == SQL_NEED_DATA) {
+    //there is no way to feed data-at-execution parameters from here
+    SQLCancel(stmt->m_hSTMT);
+    
+    NanThrowError("[node-odbc] Streamed parameters require the asynchronous executeNonQuery");
+    
+    NanReturnValue(NanNull());
+  }
+  else if(ret == SQL_ERROR) {
     NanThrowError(ODBC::GetSQLError(
       SQL_HANDLE_STMT,
       stmt->m_hSTMT,
@@ -405,9 +737,9 @@ NAN_METHOD(ODBCStatement::ExecuteNonQuerySync) {
       rowCount = 0;
     }
     
-    uv_mutex_lock(&ODBC::g_odbcMutex);
+    bool locked = ODBC::GlobalLock();
     SQLFreeStmt(stmt->m_hSTMT, SQL_CLOSE);
-    uv_mutex_unlock(&ODBC::g_odbcMutex);
+    ODBC::GlobalUnlock(locked);
     
     NanReturnValue(NanNew<Number>(rowCount));
   }
@@ -424,10 +756,14 @@ NAN_METHOD(ODBCStatement::ExecuteDirect) {
   NanScope();
 
   REQ_STRO_ARG(0, sql);
-  REQ_FUN_ARG(1, cb);
+  REQ_FUN_OR_PROMISE_ARG(1, cb, promise);
 
   ODBCStatement* stmt = ObjectWrap::Unwrap<ODBCStatement>(args.Holder());
   
+  //this replaces whatever statement was prepared
+  stmt->ClearColumnCache();
+  stmt->ClearParameterTypes();
+  
   uv_work_t* work_req = (uv_work_t *) (calloc(1, sizeof(uv_work_t)));
   
   execute_direct_work_data* data = 
@@ -448,15 +784,15 @@ NAN_METHOD(ODBCStatement::ExecuteDirect) {
   data->stmt = stmt;
   work_req->data = data;
   
-  uv_queue_work(
-    uv_default_loop(),
+  ODBC::QueueWork(
     work_req, 
     UV_ExecuteDirect, 
     (uv_after_work_cb)UV_AfterExecuteDirect);
 
   stmt->Ref();
+  stmt->m_activeWork++;
 
-  NanReturnValue(NanUndefined());
+  NanReturnValue(promise);
 }
 
 void ODBCStatement::UV_ExecuteDirect(uv_work_t* req) {
@@ -483,6 +819,9 @@ void ODBCStatement::UV_AfterExecuteDirect(uv_work_t* req, int status) {
   
   //an easy reference to the statment object
   ODBCStatement* self = data->stmt->self();
+  
+  self->m_activeWork--;
+  self->m_needData = (data->result == SQL_NEED_DATA);
 
   //First thing, let's check if the execution of the query returned any errors 
   if(data->result == SQL_ERROR) {
@@ -540,6 +879,10 @@ NAN_METHOD(ODBCStatement::ExecuteDirectSync) {
 
   ODBCStatement* stmt = ObjectWrap::Unwrap<ODBCStatement>(args.Holder());
   
+  //this replaces whatever statement was prepared
+  stmt->ClearColumnCache();
+  stmt->ClearParameterTypes();
+  
   SQLRETURN ret = SQLExecDirect(
     stmt->m_hSTMT,
     (SQLTCHAR *) *sql, 
@@ -583,6 +926,9 @@ NAN_METHOD(ODBCStatement::PrepareSync) {
 
   ODBCStatement* stmt = ObjectWrap::Unwrap<ODBCStatement>(args.Holder());
 
+  //the new statement may have a different result set
+  stmt->ClearColumnCache();
+
   SQLRETURN ret;
 
   int sqlLen = sql->Length() + 1;
@@ -603,6 +949,8 @@ NAN_METHOD(ODBCStatement::PrepareSync) {
     sqlLen);
   
   if (SQL_SUCCEEDED(ret)) {
+    stmt->DescribeParameters();
+    
     NanReturnValue(NanTrue());
   }
   else {
@@ -627,10 +975,13 @@ NAN_METHOD(ODBCStatement::Prepare) {
   NanScope();
 
   REQ_STRO_ARG(0, sql);
-  REQ_FUN_ARG(1, cb);
+  REQ_FUN_OR_PROMISE_ARG(1, cb, promise);
 
   ODBCStatement* stmt = ObjectWrap::Unwrap<ODBCStatement>(args.Holder());
   
+  //the new statement may have a different result set
+  stmt->ClearColumnCache();
+  
   uv_work_t* work_req = (uv_work_t *) (calloc(1, sizeof(uv_work_t)));
   
   prepare_work_data* data = 
@@ -652,15 +1003,14 @@ NAN_METHOD(ODBCStatement::Prepare) {
   
   work_req->data = data;
   
-  uv_queue_work(
-    uv_default_loop(), 
+  ODBC::QueueWork(
     work_req, 
     UV_Prepare, 
     (uv_after_work_cb)UV_AfterPrepare);
 
   stmt->Ref();
 
-  NanReturnValue(NanUndefined());
+  NanReturnValue(promise);
 }
 
 void ODBCStatement::UV_Prepare(uv_work_t* req) {
@@ -680,6 +1030,10 @@ void ODBCStatement::UV_Prepare(uv_work_t* req) {
     data->stmt->m_hSTMT,
     (SQLTCHAR *) data->sql, 
     data->sqlLen);
+  
+  if (SQL_SUCCEEDED(ret)) {
+    data->stmt->DescribeParameters();
+  }
 
   data->result = ret;
 }
@@ -749,63 +1103,10 @@ NAN_METHOD(ODBCStatement::BindSync) {
     stmt->m_hSTMT
   );
   
-  //if we previously had parameters, then be sure to free them
-  //before allocating more
-  if (stmt->paramCount) {
-    int count = stmt->paramCount;
-    stmt->paramCount = 0;
-    
-    Parameter prm;
-    
-    //free parameter memory
-    for (int i = 0; i < count; i++) {
-      if (prm = stmt->params[i], prm.ParameterValuePtr != NULL) {
-        switch (prm.ValueType) {
-          case SQL_C_WCHAR:   free(prm.ParameterValuePtr);             break;
-          case SQL_C_CHAR:    free(prm.ParameterValuePtr);             break; 
-          case SQL_C_SBIGINT: delete (int64_t *)prm.ParameterValuePtr; break;
-          case SQL_C_DOUBLE:  delete (double  *)prm.ParameterValuePtr; break;
-          case SQL_C_BIT:     delete (bool    *)prm.ParameterValuePtr; break;
-        }
-      }
-    }
-
-    free(stmt->params);
-  }
-  
-  stmt->params = ODBC::GetParametersFromArray(
-    Local<Array>::Cast(args[0]), 
-    &stmt->paramCount);
-  
-  SQLRETURN ret = SQL_SUCCESS;
-  Parameter prm;
+  //values that fit the previous binding are written in place
+  stmt->SetParameters(Local<Array>::Cast(args[0]));
   
-  for (int i = 0; i < stmt->paramCount; i++) {
-    prm = stmt->params[i];
-    
-    /*DEBUG_PRINTF(
-      "ODBCStatement::BindSync - param[%i]: c_type=%i type=%i "
-      "buffer_length=%i size=%i length=%i &length=%X decimals=%i value=%s\n",
-      i, prm.ValueType, prm.ParameterType, prm.BufferLength, prm.ColumnSize, prm.length, 
-      &stmt->params[i].StrLen_or_IndPtr, prm.DecimalDigits, prm.ParameterValuePtr
-    );*/
-
-    ret = SQLBindParameter(
-      stmt->m_hSTMT,      //StatementHandle
-      i + 1,              //ParameterNumber
-      SQL_PARAM_INPUT,    //InputOutputType
-      prm.ValueType,
-      prm.ParameterType,
-      prm.ColumnSize,
-      prm.DecimalDigits,
-      prm.ParameterValuePtr,
-      prm.BufferLength,
-      &stmt->params[i].StrLen_or_IndPtr);
-
-    if (ret == SQL_ERROR) {
-      break;
-    }
-  }
+  SQLRETURN ret = stmt->BindParameters();
 
   if (SQL_SUCCEEDED(ret)) {
     NanReturnValue(NanTrue());
@@ -837,7 +1138,7 @@ NAN_METHOD(ODBCStatement::Bind) {
     return NanThrowError("Argument 1 must be an Array");
   }
   
-  REQ_FUN_ARG(1, cb);
+  REQ_FUN_OR_PROMISE_ARG(1, cb, promise);
 
   ODBCStatement* stmt = ObjectWrap::Unwrap<ODBCStatement>(args.Holder());
   
@@ -846,30 +1147,6 @@ NAN_METHOD(ODBCStatement::Bind) {
   bind_work_data* data = 
     (bind_work_data *) calloc(1, sizeof(bind_work_data));
 
-  //if we previously had parameters, then be sure to free them
-  //before allocating more
-  if (stmt->paramCount) {
-    int count = stmt->paramCount;
-    stmt->paramCount = 0;
-    
-    Parameter prm;
-    
-    //free parameter memory
-    for (int i = 0; i < count; i++) {
-      if (prm = stmt->params[i], prm.ParameterValuePtr != NULL) {
-        switch (prm.ValueType) {
-          case SQL_C_WCHAR:   free(prm.ParameterValuePtr);             break;
-          case SQL_C_CHAR:    free(prm.ParameterValuePtr);             break; 
-          case SQL_C_SBIGINT: delete (int64_t *)prm.ParameterValuePtr; break;
-          case SQL_C_DOUBLE:  delete (double  *)prm.ParameterValuePtr; break;
-          case SQL_C_BIT:     delete (bool    *)prm.ParameterValuePtr; break;
-        }
-      }
-    }
-
-    free(stmt->params);
-  }
-  
   data->stmt = stmt;
   
   DEBUG_PRINTF("ODBCStatement::Bind m_hDBC=%X m_hDBC=%X m_hSTMT=%X\n",
@@ -880,21 +1157,19 @@ NAN_METHOD(ODBCStatement::Bind) {
   
   data->cb = new NanCallback(cb);
   
-  data->stmt->params = ODBC::GetParametersFromArray(
-    Local<Array>::Cast(args[0]), 
-    &data->stmt->paramCount);
+  //values that fit the previous binding are written in place
+  data->stmt->SetParameters(Local<Array>::Cast(args[0]));
   
   work_req->data = data;
   
-  uv_queue_work(
-    uv_default_loop(), 
+  ODBC::QueueWork(
     work_req, 
     UV_Bind, 
     (uv_after_work_cb)UV_AfterBind);
 
   stmt->Ref();
 
-  NanReturnValue(NanUndefined());
+  NanReturnValue(promise);
 }
 
 void ODBCStatement::UV_Bind(uv_work_t* req) {
@@ -908,37 +1183,7 @@ void ODBCStatement::UV_Bind(uv_work_t* req) {
     data->stmt->m_hSTMT
   );
   
-  SQLRETURN ret = SQL_SUCCESS;
-  Parameter prm;
-  
-  for (int i = 0; i < data->stmt->paramCount; i++) {
-    prm = data->stmt->params[i];
-    
-    /*DEBUG_PRINTF(
-      "ODBCStatement::UV_Bind - param[%i]: c_type=%i type=%i "
-      "buffer_length=%i size=%i length=%i &length=%X decimals=%i value=%s\n",
-      i, prm.ValueType, prm.ParameterType, prm.BufferLength, prm.ColumnSize, prm.length, 
-      &data->stmt->params[i].StrLen_or_IndPtr, prm.DecimalDigits, prm.ParameterValuePtr
-    );*/
-
-    ret = SQLBindParameter(
-      data->stmt->m_hSTMT,        //StatementHandle
-      i + 1,                      //ParameterNumber
-      SQL_PARAM_INPUT,            //InputOutputType
-      prm.ValueType,
-      prm.ParameterType,
-      prm.ColumnSize,
-      prm.DecimalDigits,
-      prm.ParameterValuePtr,
-      prm.BufferLength,
-      &data->stmt->params[i].StrLen_or_IndPtr);
-
-    if (ret == SQL_ERROR) {
-      break;
-    }
-  }
-
-  data->result = ret;
+  data->result = data->stmt->BindParameters();
 }
 
 void ODBCStatement::UV_AfterBind(uv_work_t* req, int status) {
@@ -981,31 +1226,512 @@ void ODBCStatement::UV_AfterBind(uv_work_t* req, int status) {
 }
 
 /*
- * CloseSync
+ * ExecuteBatchSync
+ * 
  */
 
-NAN_METHOD(ODBCStatement::CloseSync) {
-  DEBUG_PRINTF("ODBCStatement::CloseSync\n");
+NAN_METHOD(ODBCStatement::ExecuteBatchSync) {
+  DEBUG_PRINTF("ODBCStatement::ExecuteBatchSync\n");
   
   NanScope();
 
-  OPT_INT_ARG(0, closeOption, SQL_DESTROY);
-  
+  if ( !args[0]->IsArray() ) {
+    return NanThrowTypeError("Argument 1 must be an Array");
+  }
+
   ODBCStatement* stmt = ObjectWrap::Unwrap<ODBCStatement>(args.Holder());
   
-  DEBUG_PRINTF("ODBCStatement::CloseSync closeOption=%i\n", 
-               closeOption);
+  int paramCount = 0;
+  int rowCount = 0;
   
-  if (closeOption == SQL_DESTROY) {
-    stmt->Free();
-  }
-  else {
-    uv_mutex_lock(&ODBC::g_odbcMutex);
-    
-    SQLFreeStmt(stmt->m_hSTMT, closeOption);
+  ParameterArray* params = ODBC::GetParameterArraysFromRows(
+    Local<Array>::Cast(args[0]),
+    &paramCount,
+    &rowCount);
   
-    uv_mutex_unlock(&ODBC::g_odbcMutex);
+  if (params == NULL) {
+    //GetParameterArraysFromRows has already thrown
+    NanReturnUndefined();
   }
-
-  NanReturnValue(NanTrue());
+  
+  SQLUSMALLINT* rowStatus = (SQLUSMALLINT *) calloc(rowCount, sizeof(SQLUSMALLINT));
+  SQLLEN affectedRows = 0;
+  
+  SQLRETURN ret = ODBC::ExecuteParameterArrays(
+    stmt->m_hSTMT,
+    params,
+    paramCount,
+    rowCount,
+    rowStatus,
+    &affectedRows);
+  
+  Local<Object> objResult = ODBC::GetParameterArrayStatus(rowStatus, rowCount, affectedRows);
+  Local<Object> objError;
+  
+  if (!SQL_SUCCEEDED(ret)) {
+    objError = ODBC::GetSQLError(
+      SQL_HANDLE_STMT,
+      stmt->m_hSTMT,
+      (char *) "[node-odbc] Error in ODBCStatement::ExecuteBatchSync"
+    );
+    
+    //let the caller tell which rows were rejected
+    objError->Set(NanNew("status"), objResult->Get(NanNew("status")));
+  }
+  
+  //diagnostics have been read; now the arrays can be released
+  ODBC::UnbindParameterArrays(stmt->m_hSTMT);
+  ODBC::FreeParameterArrays(params, paramCount);
+  
+  //SQL_RESET_PARAMS dropped anything bound with bind as well
+  stmt->FreeParameters();
+  free(rowStatus);
+  
+  if (!SQL_SUCCEEDED(ret)) {
+    NanThrowError(objError);
+    
+    NanReturnValue(NanNull());
+  }
+  
+  NanReturnValue(objResult);
+}
+
+/*
+ * ExecuteBatch
+ * 
+ */
+
+NAN_METHOD(ODBCStatement::ExecuteBatch) {
+  DEBUG_PRINTF("ODBCStatement::ExecuteBatch\n");
+  
+  NanScope();
+
+  if ( !args[0]->IsArray() ) {
+    return NanThrowTypeError("Argument 1 must be an Array");
+  }
+  
+  REQ_FUN_OR_PROMISE_ARG(1, cb, promise);
+
+  ODBCStatement* stmt = ObjectWrap::Unwrap<ODBCStatement>(args.Holder());
+  
+  int paramCount = 0;
+  int rowCount = 0;
+  
+  //build the parameter arrays here because we need V8 to read the rows
+  ParameterArray* params = ODBC::GetParameterArraysFromRows(
+    Local<Array>::Cast(args[0]),
+    &paramCount,
+    &rowCount);
+  
+  if (params == NULL) {
+    //GetParameterArraysFromRows has already thrown
+    NanReturnUndefined();
+  }
+  
+  uv_work_t* work_req = (uv_work_t *) (calloc(1, sizeof(uv_work_t)));
+  
+  execute_batch_work_data* data = 
+    (execute_batch_work_data *) calloc(1, sizeof(execute_batch_work_data));
+
+  data->cb = new NanCallback(cb);
+  data->stmt = stmt;
+  data->params = params;
+  data->paramCount = paramCount;
+  data->rowCount = rowCount;
+  data->rowStatus = (SQLUSMALLINT *) calloc(rowCount, sizeof(SQLUSMALLINT));
+  
+  work_req->data = data;
+  
+  ODBC::QueueWork(
+    work_req,
+    UV_ExecuteBatch,
+    (uv_after_work_cb)UV_AfterExecuteBatch);
+
+  stmt->Ref();
+  stmt->m_activeWork++;
+  
+  NanReturnValue(promise);
+}
+
+void ODBCStatement::UV_ExecuteBatch(uv_work_t* req) {
+  DEBUG_PRINTF("ODBCStatement::UV_ExecuteBatch\n");
+  
+  execute_batch_work_data* data = (execute_batch_work_data *)(req->data);
+
+  data->result = ODBC::ExecuteParameterArrays(
+    data->stmt->m_hSTMT,
+    data->params,
+    data->paramCount,
+    data->rowCount,
+    data->rowStatus,
+    &data->affectedRows);
+}
+
+void ODBCStatement::UV_AfterExecuteBatch(uv_work_t* req, int status) {
+  DEBUG_PRINTF("ODBCStatement::UV_AfterExecuteBatch\n");
+  
+  execute_batch_work_data* data = (execute_batch_work_data *)(req->data);
+  
+  NanScope();
+  
+  //an easy reference to the statment object
+  ODBCStatement* self = data->stmt->self();
+  
+  self->m_activeWork--;
+  self->m_needData = (data->result == SQL_NEED_DATA);
+
+  Local<Value> args[2];
+  
+  //the per row status is handed back even on error so that the caller
+  //can tell which rows were rejected
+  args[1] = ODBC::GetParameterArrayStatus(
+    data->rowStatus,
+    data->rowCount,
+    data->affectedRows);
+  
+  if (!SQL_SUCCEEDED(data->result)) {
+    args[0] = ODBC::GetSQLError(
+      SQL_HANDLE_STMT,
+      self->m_hSTMT,
+      (char *) "[node-odbc] Error in ODBCStatement::ExecuteBatch"
+    );
+  }
+  else {
+    args[0] = NanNew<Value>(NanNull());
+  }
+  
+  //diagnostics have been read; now the arrays can be released
+  ODBC::UnbindParameterArrays(self->m_hSTMT);
+  ODBC::FreeParameterArrays(data->params, data->paramCount);
+  
+  //SQL_RESET_PARAMS dropped anything bound with bind as well
+  self->FreeParameters();
+  free(data->rowStatus);
+
+  TryCatch try_catch;
+  
+  data->cb->Call(2, args);
+
+  if (try_catch.HasCaught()) {
+    FatalException(try_catch);
+  }
+
+  self->Unref();
+  delete data->cb;
+  
+  free(data);
+  free(req);
+}
+
+/*
+ * ParamData
+ * 
+ * Called after an execute reported that data-at-execution parameters are
+ * waiting. Calls back with the index of the next parameter to send with
+ * putData, or with -1, the result and the row count once the statement
+ * has run.
+ */
+
+NAN_METHOD(ODBCStatement::ParamData) {
+  DEBUG_PRINTF("ODBCStatement::ParamData\n");
+  
+  NanScope();
+
+  REQ_FUN_ARG(0, cb);
+
+  ODBCStatement* stmt = ObjectWrap::Unwrap<ODBCStatement>(args.Holder());
+  
+  uv_work_t* work_req = (uv_work_t *) (calloc(1, sizeof(uv_work_t)));
+  
+  param_data_work_data* data = 
+    (param_data_work_data *) calloc(1, sizeof(param_data_work_data));
+
+  data->cb = new NanCallback(cb);
+  
+  data->stmt = stmt;
+  data->param = -1;
+  work_req->data = data;
+  
+  ODBC::QueueWork(
+    work_req,
+    UV_ParamData,
+    (uv_after_work_cb)UV_AfterParamData);
+
+  stmt->Ref();
+  stmt->m_activeWork++;
+
+  NanReturnValue(NanUndefined());
+}
+
+void ODBCStatement::UV_ParamData(uv_work_t* req) {
+  DEBUG_PRINTF("ODBCStatement::UV_ParamData\n");
+  
+  param_data_work_data* data = (param_data_work_data *)(req->data);
+
+  SQLPOINTER token = NULL;
+  
+  SQLRETURN ret = SQLParamData(data->stmt->m_hSTMT, &token);
+  
+  if (ret == SQL_NEED_DATA) {
+    //the token is the ParameterValuePtr bound in GetParametersFromArray
+    data->param = *(int *) token;
+  }
+  else if (SQL_SUCCEEDED(ret)) {
+    data->stmt->DescribeColumns();
+    
+    if (!SQL_SUCCEEDED(SQLRowCount(data->stmt->m_hSTMT, &data->rowCount))) {
+      data->rowCount = 0;
+    }
+  }
+
+  data->result = ret;
+}
+
+void ODBCStatement::UV_AfterParamData(uv_work_t* req, int status) {
+  DEBUG_PRINTF("ODBCStatement::UV_AfterParamData\n");
+  
+  param_data_work_data* data = (param_data_work_data *)(req->data);
+  
+  NanScope();
+  
+  //an easy reference to the statment object
+  ODBCStatement* self = data->stmt->self();
+  
+  self->m_activeWork--;
+  self->m_needData = (data->result == SQL_NEED_DATA);
+  
+  self->ReleaseStaleColumnCache();
+
+  if (data->result == SQL_ERROR) {
+    ODBC::CallbackSQLError(
+      SQL_HANDLE_STMT,
+      self->m_hSTMT,
+      data->cb);
+  }
+  else {
+    Local<Value> args[4];
+    int argc = 2;
+
+    args[0] = NanNew<Value>(NanNull());
+    args[1] = NanNew<Number>(data->param);
+    
+    if (data->result != SQL_NEED_DATA) {
+      args[2] = self->NewResult();
+      args[3] = NanNew<Number>(data->rowCount);
+      argc = 4;
+    }
+
+    TryCatch try_catch;
+
+    data->cb->Call(argc, args);
+
+    if (try_catch.HasCaught()) {
+      FatalException(try_catch);
+    }
+  }
+
+  self->Unref();
+  delete data->cb;
+  
+  free(data);
+  free(req);
+}
+
+/*
+ * PutData
+ * 
+ * Send one chunk of the parameter last returned by paramData. The Buffer
+ * is kept alive until the worker thread is done with it; an empty Buffer
+ * sends an empty value.
+ */
+
+NAN_METHOD(ODBCStatement::PutData) {
+  DEBUG_PRINTF("ODBCStatement::PutData\n");
+  
+  NanScope();
+
+  REQ_ARGS(2);
+  REQ_FUN_ARG(1, cb);
+  
+  if (!Buffer::HasInstance(args[0])) {
+    return NanThrowTypeError("Argument 0 must be a Buffer");
+  }
+
+  ODBCStatement* stmt = ObjectWrap::Unwrap<ODBCStatement>(args.Holder());
+  
+  uv_work_t* work_req = (uv_work_t *) (calloc(1, sizeof(uv_work_t)));
+  
+  put_data_work_data* data = 
+    (put_data_work_data *) calloc(1, sizeof(put_data_work_data));
+
+  Local<Object> buffer = args[0]->ToObject();
+  
+  data->cb = new NanCallback(cb);
+  data->data = Buffer::Data(buffer);
+  data->length = Buffer::Length(buffer);
+  
+  NanAssignPersistent(data->buffer, buffer);
+  
+  data->stmt = stmt;
+  work_req->data = data;
+  
+  ODBC::QueueWork(
+    work_req,
+    UV_PutData,
+    (uv_after_work_cb)UV_AfterPutData);
+
+  stmt->Ref();
+  stmt->m_activeWork++;
+
+  NanReturnValue(NanUndefined());
+}
+
+void ODBCStatement::UV_PutData(uv_work_t* req) {
+  DEBUG_PRINTF("ODBCStatement::UV_PutData\n");
+  
+  put_data_work_data* data = (put_data_work_data *)(req->data);
+
+  data->result = SQLPutData(
+    data->stmt->m_hSTMT,
+    (SQLPOINTER) data->data,
+    (SQLLEN) data->length);
+}
+
+void ODBCStatement::UV_AfterPutData(uv_work_t* req, int status) {
+  DEBUG_PRINTF("ODBCStatement::UV_AfterPutData\n");
+  
+  put_data_work_data* data = (put_data_work_data *)(req->data);
+  
+  NanScope();
+  
+  //an easy reference to the statment object
+  ODBCStatement* self = data->stmt->self();
+  
+  self->m_activeWork--;
+  
+  NanDisposePersistent(data->buffer);
+
+  if (data->result == SQL_ERROR) {
+    ODBC::CallbackSQLError(
+      SQL_HANDLE_STMT,
+      self->m_hSTMT,
+      data->cb);
+  }
+  else {
+    Local<Value> args[1];
+
+    args[0] = NanNew<Value>(NanNull());
+
+    TryCatch try_catch;
+
+    data->cb->Call(1, args);
+
+    if (try_catch.HasCaught()) {
+      FatalException(try_catch);
+    }
+  }
+
+  self->Unref();
+  delete data->cb;
+  
+  free(data);
+  free(req);
+}
+
+/*
+ * CloseSync
+ */
+
+NAN_METHOD(ODBCStatement::CloseSync) {
+  DEBUG_PRINTF("ODBCStatement::CloseSync\n");
+  
+  NanScope();
+
+  OPT_INT_ARG(0, closeOption, SQL_DESTROY);
+  
+  ODBCStatement* stmt = ObjectWrap::Unwrap<ODBCStatement>(args.Holder());
+  
+  DEBUG_PRINTF("ODBCStatement::CloseSync closeOption=%i\n", 
+               closeOption);
+  
+  if (closeOption == SQL_DESTROY) {
+    stmt->Free();
+  }
+  else {
+    bool locked = ODBC::GlobalLock();
+    
+    SQLFreeStmt(stmt->m_hSTMT, closeOption);
+  
+    ODBC::GlobalUnlock(locked);
+    
+    //the driver no longer points at our parameter buffers
+    if (closeOption == SQL_RESET_PARAMS) {
+      stmt->FreeParameters();
+    }
+  }
+
+  NanReturnValue(NanTrue());
+}
+
+/*
+ * SetQueryTimeoutSync
+ * 
+ * Number of seconds later executions may run before the driver gives up
+ * with HYT00. 0 means no timeout.
+ */
+
+NAN_METHOD(ODBCStatement::SetQueryTimeoutSync) {
+  DEBUG_PRINTF("ODBCStatement::SetQueryTimeoutSync\n");
+  NanScope();
+
+  ODBCStatement* stmt = ObjectWrap::Unwrap<ODBCStatement>(args.Holder());
+  
+  OPT_INT_ARG(0, timeout, 0);
+  
+  SQLRETURN ret = SQLSetStmtAttr(
+    stmt->m_hSTMT,
+    SQL_ATTR_QUERY_TIMEOUT,
+    (SQLPOINTER) (size_t) timeout,
+    SQL_IS_UINTEGER);
+  
+  if (!SQL_SUCCEEDED(ret)) {
+    NanThrowError(ODBC::GetSQLError(
+      SQL_HANDLE_STMT,
+      stmt->m_hSTMT,
+      (char *) "[node-odbc] Error in ODBCStatement::SetQueryTimeoutSync"
+    ));
+    
+    NanReturnValue(NanFalse());
+  }
+  
+  NanReturnValue(NanTrue());
+}
+
+/*
+ * Cancel
+ * 
+ * Called on the event loop thread while the statement is executing on a
+ * worker thread, or waits for data-at-execution parameters; the execution
+ * then fails with HY008. Returns whether there was anything to cancel.
+ */
+
+NAN_METHOD(ODBCStatement::Cancel) {
+  DEBUG_PRINTF("ODBCStatement::Cancel\n");
+  NanScope();
+
+  ODBCStatement* stmt = ObjectWrap::Unwrap<ODBCStatement>(args.Holder());
+  
+  //SQLCancel succeeds on an idle statement without doing anything
+  if (!stmt->m_hSTMT || (stmt->m_activeWork == 0 && !stmt->m_needData)) {
+    NanReturnValue(NanFalse());
+  }
+  
+  SQLRETURN ret = SQLCancel(stmt->m_hSTMT);
+  
+  //a cancelled data-at-execution sequence is over
+  if (SQL_SUCCEEDED(ret) && stmt->m_activeWork == 0) {
+    stmt->m_needData = false;
+  }
+  
+  NanReturnValue(SQL_SUCCEEDED(ret) ? NanTrue() : NanFalse());
 }
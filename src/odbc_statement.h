@@ -61,6 +61,18 @@ class ODBCStatement : public node::ObjectWrap {
     static void UV_Bind(uv_work_t* work_req);
     static void UV_AfterBind(uv_work_t* work_req, int status);
     
+    static NAN_METHOD(ExecuteBatch);
+    static void UV_ExecuteBatch(uv_work_t* work_req);
+    static void UV_AfterExecuteBatch(uv_work_t* work_req, int status);
+    
+    static NAN_METHOD(ParamData);
+    static void UV_ParamData(uv_work_t* work_req);
+    static void UV_AfterParamData(uv_work_t* work_req, int status);
+    
+    static NAN_METHOD(PutData);
+    static void UV_PutData(uv_work_t* work_req);
+    static void UV_AfterPutData(uv_work_t* work_req, int status);
+    
     //sync methods
     static NAN_METHOD(CloseSync);
     static NAN_METHOD(ExecuteSync);
@@ -68,6 +80,9 @@ class ODBCStatement : public node::ObjectWrap {
     static NAN_METHOD(ExecuteNonQuerySync);
     static NAN_METHOD(PrepareSync);
     static NAN_METHOD(BindSync);
+    static NAN_METHOD(ExecuteBatchSync);
+    static NAN_METHOD(SetQueryTimeoutSync);
+    static NAN_METHOD(Cancel);
     
     struct Fetch_Request {
       NanCallback* callback;
@@ -76,6 +91,18 @@ class ODBCStatement : public node::ObjectWrap {
     };
     
     ODBCStatement *self(void) { return this; }
+    
+    void ClearColumnCache();
+    void ReleaseStaleColumnCache();
+    bool IsColumnCacheCurrent();
+    void DescribeColumns();
+    Local<Object> NewResult();
+    
+    void DescribeParameters();
+    void ClearParameterTypes();
+    void SetParameters(Local<Array> values);
+    SQLRETURN BindParameters();
+    void FreeParameters();
 
   protected:
     HENV m_hENV;
@@ -85,10 +112,24 @@ class ODBCStatement : public node::ObjectWrap {
     Parameter *params;
     int paramCount;
     
-    uint16_t *buffer;
-    int bufferLength;
-    Column *columns;
-    short colCount;
+    //false for parameters that still have to be passed to SQLBindParameter
+    bool *m_paramBound;
+    
+    //SQL types of the parameter markers of the prepared statement
+    ParameterDescription *m_paramTypes;
+    int m_paramTypeCount;
+    
+    ColumnCache *m_columnCache;
+    
+    //a cache DescribeColumns found out of date, released by
+    //ReleaseStaleColumnCache
+    ColumnCache *m_staleColumnCache;
+    
+    //executions queued on the thread pool and whether the last one is
+    //waiting for data-at-execution parameters, for Cancel. Only touched on
+    //the event loop thread.
+    int m_activeWork;
+    bool m_needData;
 };
 
 struct execute_direct_work_data {
@@ -119,4 +160,32 @@ struct bind_work_data {
   int result;
 };
 
+struct execute_batch_work_data {
+  NanCallback* cb;
+  ODBCStatement *stmt;
+  int result;
+  ParameterArray *params;
+  int paramCount;
+  int rowCount;
+  SQLUSMALLINT *rowStatus;
+  SQLLEN affectedRows;
+};
+
+struct param_data_work_data {
+  NanCallback* cb;
+  ODBCStatement *stmt;
+  int result;
+  int param;
+  SQLLEN rowCount;
+};
+
+struct put_data_work_data {
+  NanCallback* cb;
+  ODBCStatement *stmt;
+  int result;
+  Persistent<Object> buffer;
+  char *data;
+  size_t length;
+};
+
 #endif
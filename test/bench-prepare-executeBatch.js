@@ -0,0 +1,73 @@
+var common = require("./common")
+  , odbc = require("../")
+  , db = new odbc.Database()
+  , iterations = 100000
+  , batchSize = 1000
+  ;
+
+db.open(common.connectionString, function(err){ 
+  if (err) {
+    console.error(err);
+    process.exit(1);
+  }
+  
+  createTable();
+});
+
+function createTable() {
+  db.query("create table bench_insert (str varchar(50))", function (err) {
+    if (err) {
+      console.error(err);
+      return finish();
+    }
+    
+    return insertData();
+  });
+}
+
+function dropTable() {
+  db.query("drop table bench_insert", function (err) {
+    if (err) {
+      console.error(err);
+    }
+    
+    return finish();
+  });
+}
+
+function insertData() {
+  var count = 0
+    , rows = []
+    , stmt = db.prepareSync("insert into bench_insert (str) values (?)")
+    , time = new Date().getTime();
+  
+  for (var x = 0; x < batchSize; x++) {
+    rows.push(['testing']);
+  }
+  
+  issueBatch();
+  
+  function issueBatch() {
+    stmt.executeBatch(rows, function (err, result) {
+      if (err) {
+        console.error(err);
+        return finish();
+      }
+      
+      count += result.affectedRows;
+      
+      if (count >= iterations) {
+        var elapsed = new Date().getTime() - time;
+        
+        console.log("%d records inserted in %d seconds, %d/sec", count, elapsed/1000, Math.floor(count/(elapsed/1000)));
+        return dropTable();
+      }
+      
+      issueBatch();
+    });
+  }
+}
+
+function finish() {
+  db.close(function () {});
+}
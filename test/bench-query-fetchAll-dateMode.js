@@ -0,0 +1,80 @@
+var common = require("./common")
+, odbc = require("../")
+, db = new odbc.Database()
+, rowCount = 10000
+, modes = [
+    { name : "DATE_OBJECT", mode : odbc.DATE_OBJECT },
+    { name : "DATE_NUMBER", mode : odbc.DATE_NUMBER },
+    { name : "DATE_STRING", mode : odbc.DATE_STRING }
+  ];
+
+db.open(common.connectionString, function(err){ 
+  if (err) {
+    console.error(err);
+    process.exit(1);
+  }
+  
+  createTable();
+});
+
+function createTable() {
+  common.dropTables(db, function () {
+    common.createTables(db, function (err) {
+      if (err) {
+        console.error(err);
+        return finish();
+      }
+      
+      var start = new Date(2015, 0, 1).getTime();
+      
+      db.beginTransactionSync();
+      
+      for (var i = 0; i < rowCount; i++) {
+        var dt = new Date(start + i * 3600000);
+        
+        db.querySync("insert into " + common.tableName + " (COLINT, COLDATETIME, COLTEXT) VALUES (?, ?, ?)", 
+          [i, dt.toISOString().replace('T', ' ').replace('Z', ''), 'row number ' + i]);
+      }
+      
+      db.commitTransactionSync();
+      
+      issueQuery(0);
+    });
+  });
+}
+
+function issueQuery(ix) {
+  if (ix === modes.length) {
+    return finish();
+  }
+  
+  var time = new Date().getTime();
+  
+  db.queryResult("select COLDATETIME, COLDATETIME as DT2, COLDATETIME as DT3 from " + common.tableName, function (err, result) {
+    if (err) {
+      console.error(err);
+      return finish();
+    }
+    
+    result.fetchAll({ dateMode : modes[ix].mode }, function (err, data) {
+      var elapsed = new Date().getTime() - time;
+      
+      result.closeSync();
+      
+      if (err) {
+        console.error(err);
+        return finish();
+      }
+      
+      console.log("%s: %d rows fetched in %d seconds, %d/sec", modes[ix].name, data.length, elapsed/1000, Math.floor(data.length/(elapsed/1000)));
+      
+      issueQuery(ix + 1);
+    });
+  });
+}
+
+function finish() {
+  common.dropTables(db, function () {
+    db.close(function () {});
+  });
+}
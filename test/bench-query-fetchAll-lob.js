@@ -0,0 +1,72 @@
+var common = require("./common")
+, odbc = require("../")
+, db = new odbc.Database()
+, rowCount = 50
+, valueLength = 4 * 1024 * 1024
+, iterations = 5;
+
+db.open(common.connectionString, function(err){ 
+  if (err) {
+    console.error(err);
+    process.exit(1);
+  }
+  
+  createTable();
+});
+
+function createTable() {
+  common.dropTables(db, function () {
+    common.createTables(db, function (err) {
+      if (err) {
+        console.error(err);
+        return finish();
+      }
+      
+      var value = '';
+      
+      while (value.length < valueLength) {
+        value += '<row id="' + value.length + '"><name>value</name></row>';
+      }
+      
+      db.beginTransactionSync();
+      
+      for (var i = 0; i < rowCount; i++) {
+        db.querySync("insert into " + common.tableName + " (COLINT, COLTEXT) VALUES (?, ?)", [i, value]);
+      }
+      
+      db.commitTransactionSync();
+      
+      issueQuery(0, 0);
+    });
+  });
+}
+
+function issueQuery(ix, totalElapsed) {
+  if (ix === iterations) {
+    console.log("%d LOB rows of %d bytes fetched in an average of %d seconds", 
+      rowCount, valueLength, totalElapsed / iterations / 1000);
+    
+    return finish();
+  }
+  
+  var time = new Date().getTime();
+  
+  db.query("select COLTEXT from " + common.tableName, function (err, data) {
+    var elapsed = new Date().getTime() - time;
+    
+    if (err) {
+      console.error(err);
+      return finish();
+    }
+    
+    console.log("%d rows fetched in %d seconds", data.length, elapsed / 1000);
+    
+    issueQuery(ix + 1, totalElapsed + elapsed);
+  });
+}
+
+function finish() {
+  common.dropTables(db, function () {
+    db.close(function () {});
+  });
+}
@@ -0,0 +1,71 @@
+var common = require("./common")
+, odbc = require("../")
+, db = new odbc.Database()
+, rowCount = 10000
+, sizes = [1, 16, 256];
+
+db.open(common.connectionString, function(err){ 
+  if (err) {
+    console.error(err);
+    process.exit(1);
+  }
+  
+  createTable();
+});
+
+function createTable() {
+  common.dropTables(db, function () {
+    common.createTables(db, function (err) {
+      if (err) {
+        console.error(err);
+        return finish();
+      }
+      
+      db.beginTransactionSync();
+      
+      for (var i = 0; i < rowCount; i++) {
+        db.querySync("insert into " + common.tableName + " (COLINT, COLDATETIME, COLTEXT) VALUES (?, NULL, ?)", [i, 'row number ' + i]);
+      }
+      
+      db.commitTransactionSync();
+      
+      issueQuery(0);
+    });
+  });
+}
+
+function issueQuery(ix) {
+  if (ix === sizes.length) {
+    return finish();
+  }
+  
+  var time = new Date().getTime();
+  
+  db.queryResult("select * from " + common.tableName, function (err, result) {
+    if (err) {
+      console.error(err);
+      return finish();
+    }
+    
+    result.fetchAll({ rowArraySize : sizes[ix] }, function (err, data) {
+      var elapsed = new Date().getTime() - time;
+      
+      result.closeSync();
+      
+      if (err) {
+        console.error(err);
+        return finish();
+      }
+      
+      console.log("rowArraySize %d: %d rows fetched in %d seconds, %d/sec", sizes[ix], data.length, elapsed/1000, Math.floor(data.length/(elapsed/1000)));
+      
+      issueQuery(ix + 1);
+    });
+  });
+}
+
+function finish() {
+  common.dropTables(db, function () {
+    db.close(function () {});
+  });
+}
@@ -0,0 +1,56 @@
+var common = require("./common")
+, odbc = require("../")
+, db = new odbc.Database()
+, columnCount = 50
+, rowCount = 400;
+
+db.open(common.connectionString, function(err){ 
+  if (err) {
+    console.error(err);
+    process.exit(1);
+  }
+  
+  issueQuery();
+});
+
+function issueQuery() {
+  var columns = []
+    , selects = []
+    , time;
+  
+  for (var c = 0; c < columnCount; c++) {
+    columns.push(c + " as COL" + c);
+  }
+  
+  for (var r = 0; r < rowCount; r++) {
+    selects.push("select " + columns.join(", "));
+  }
+  
+  time = new Date().getTime();
+  
+  db.queryResult(selects.join(" union all "), function (err, result) {
+    if (err) {
+      console.error(err);
+      return finish();
+    }
+    
+    result.fetchAll(function (err, data) {
+      var elapsed = new Date().getTime() - time;
+      
+      result.closeSync();
+      
+      if (err) {
+        console.error(err);
+        return finish();
+      }
+      
+      console.log("%d rows of %d columns fetched in %d seconds, %d/sec", data.length, columnCount, elapsed/1000, Math.floor(data.length/(elapsed/1000)));
+      
+      return finish();
+    });
+  });
+}
+
+function finish() {
+  db.close(function () {});
+}
@@ -0,0 +1,43 @@
+var common = require("./common")
+  , odbc = require("../")
+  , db = new odbc.Database()
+  , assert = require("assert")
+  , tableName = "NODE_ODBC_BINARY_TEST"
+  ;
+
+db.openSync(common.connectionString);
+
+try { db.querySync("drop table " + tableName); } catch (e) {}
+
+db.querySync("create table " + tableName + " (ID INTEGER, DATA BLOB)");
+
+var small = new Buffer([0, 1, 2, 0xde, 0xad, 0xbe, 0xef, 0, 255]);
+var large = new Buffer(100000);
+
+for (var i = 0; i < large.length; i++) {
+  large[i] = i % 251;
+}
+
+db.querySync("insert into " + tableName + " (ID, DATA) values (?, ?)", [1, small]);
+db.querySync("insert into " + tableName + " (ID, DATA) values (?, ?)", [2, large]);
+db.querySync("insert into " + tableName + " (ID, DATA) values (?, ?)", [3, new Buffer(0)]);
+db.querySync("insert into " + tableName + " (ID, DATA) values (?, ?)", [4, null]);
+
+var data = db.querySync("select ID, DATA from " + tableName + " order by ID");
+
+assert.equal(data.length, 4);
+assert.ok(Buffer.isBuffer(data[0].DATA));
+assert.equal(data[0].DATA.toString("hex"), small.toString("hex"));
+assert.ok(Buffer.isBuffer(data[1].DATA));
+assert.equal(data[1].DATA.length, large.length);
+assert.equal(data[1].DATA.toString("hex"), large.toString("hex"));
+assert.equal(data[3].DATA, null);
+
+db.query("select DATA from " + tableName + " where ID = ?", [1], function (err, data) {
+  assert.equal(err, null);
+  assert.ok(Buffer.isBuffer(data[0].DATA));
+  assert.equal(data[0].DATA.toString("hex"), small.toString("hex"));
+  
+  db.querySync("drop table " + tableName);
+  db.closeSync();
+});
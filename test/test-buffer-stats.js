@@ -0,0 +1,35 @@
+var common = require("./common")
+  , odbc = require("../")
+  , db = new odbc.Database()
+  , assert = require("assert")
+  ;
+
+db.openSync(common.connectionString);
+
+assert.equal(db.connected, true);
+
+var before = db.odbc.getBufferStats();
+
+assert.equal(typeof before.bytesInUse, "number");
+assert.equal(typeof before.bytesPooled, "number");
+
+var result = db.queryResultSync("select 1 as COLINT, 'some test' as COLTEXT");
+var data = result.fetchAllSync();
+
+assert.deepEqual(data, [{ COLINT : 1, COLTEXT : 'some test' }]);
+
+//a small result set should not need anything close to the maximum buffer
+var during = db.odbc.getBufferStats();
+
+assert.equal(during.buffersInUse, before.buffersInUse + 1);
+assert.equal(during.bytesInUse - before.bytesInUse < 1048576, true);
+
+result.closeSync();
+
+//closing the result returns the buffer to the pool
+var after = db.odbc.getBufferStats();
+
+assert.equal(after.buffersInUse, before.buffersInUse);
+assert.equal(after.bytesInUse, before.bytesInUse);
+
+db.closeSync();
@@ -0,0 +1,63 @@
+var common = require("./common")
+  , odbc = require("../")
+  , db = new odbc.Database()
+  , assert = require("assert")
+  ;
+
+db.open(common.connectionString, function(err) {
+  assert.equal(err, null);
+  
+  var dt = new Date();
+  var sql = "SELECT cast('" + dt.toISOString().replace('Z','') + "' as datetime) as DT1";
+  
+  var asDate = db.queryResultSync(sql).fetchAllSync();
+  
+  assert.equal(asDate[0].DT1.constructor.name, "Date");
+  
+  var result = db.queryResultSync(sql);
+  result.dateMode = odbc.DATE_NUMBER;
+  assert.equal(result.dateMode, odbc.DATE_NUMBER);
+  
+  var asNumber = result.fetchAllSync();
+  result.closeSync();
+  
+  assert.equal(typeof asNumber[0].DT1, "number");
+  assert.equal(asNumber[0].DT1, asDate[0].DT1.getTime());
+  
+  result = db.queryResultSync(sql);
+  
+  var asString = result.fetchAllSync({ dateMode : odbc.DATE_STRING });
+  result.closeSync();
+  
+  assert.equal(typeof asString[0].DT1, "string");
+  assert.equal(asString[0].DT1, asDate[0].DT1.toISOString());
+  
+  //invalid modes are ignored
+  result = db.queryResultSync(sql);
+  result.dateMode = 42;
+  assert.equal(result.dateMode, odbc.DATE_OBJECT);
+  result.closeSync();
+  
+  db.queryResult(sql, function (err, result) {
+    assert.equal(err, null);
+    
+    result.fetchAll({ dateMode : odbc.DATE_NUMBER }, function (err, data) {
+      assert.equal(err, null);
+      assert.equal(data[0].DT1, asDate[0].DT1.getTime());
+      
+      result.closeSync();
+      
+      db.close(function () {
+        var db2 = new odbc.Database({ dateMode : odbc.DATE_STRING });
+        
+        db2.openSync(common.connectionString);
+        
+        var data = db2.querySync(sql);
+        
+        db2.closeSync();
+        
+        assert.equal(data[0].DT1, asDate[0].DT1.toISOString());
+      });
+    });
+  });
+});
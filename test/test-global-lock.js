@@ -0,0 +1,30 @@
+var common = require("./common")
+  , odbc = require("../")
+  , db = new odbc.Database()
+  , assert = require("assert")
+  ;
+
+assert.throws(function () {
+  odbc.setGlobalLock("yes");
+});
+
+//fall back to serializing everything, as for a driver that isn't thread safe
+odbc.setGlobalLock(true);
+
+db.openSync(common.connectionString);
+
+assert.equal(db.connected, true);
+
+db.query("select 1 as COLINT", function (err, data) {
+  assert.equal(err, null);
+  assert.deepEqual(data, [{ COLINT : 1 }]);
+  
+  odbc.setGlobalLock(false);
+  
+  db.query("select 2 as COLINT", function (err, data) {
+    assert.equal(err, null);
+    assert.deepEqual(data, [{ COLINT : 2 }]);
+    
+    db.closeSync();
+  });
+});
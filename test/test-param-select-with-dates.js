@@ -0,0 +1,53 @@
+var common = require("./common")
+  , odbc = require("../")
+  , db = new odbc.Database()
+  , assert = require("assert")
+  , tableName = "NODE_ODBC_DATE_PARAM_TEST"
+  ;
+
+db.openSync(common.connectionString);
+
+try { db.querySync("drop table " + tableName); } catch (e) {}
+
+db.querySync("create table " + tableName + " (ID INTEGER, DT DATETIME)");
+
+var dates = [
+  new Date(Date.UTC(2014, 0, 31, 23, 59, 58, 123)),
+  new Date(Date.UTC(1969, 11, 31, 12, 0, 0, 5)),
+  new Date(Date.UTC(2000, 1, 29, 0, 0, 0, 0))
+];
+
+//bound as SQL_C_TYPE_TIMESTAMP, one at a time and as a batch
+dates.forEach(function (dt, index) {
+  db.querySync("insert into " + tableName + " (ID, DT) values (?, ?)", [index, dt]);
+});
+
+db.querySync("insert into " + tableName + " (ID, DT) values (?, ?)", [3, new Date(NaN)]);
+
+var stmt = db.prepareSync("insert into " + tableName + " (ID, DT) values (?, ?)");
+
+stmt.executeBatchSync(dates.map(function (dt, index) {
+  return [10 + index, dt];
+}));
+
+stmt.closeSync();
+
+var data = db.querySync("select ID, DT from " + tableName + " order by ID");
+
+assert.equal(data.length, 7);
+
+dates.forEach(function (dt, index) {
+  assert.equal(data[index].DT.getTime(), dt.getTime());
+  assert.equal(data[4 + index].DT.getTime(), dt.getTime());
+});
+
+//invalid dates are null
+assert.equal(data[3].DT, null);
+
+db.query("select ID from " + tableName + " where DT = ?", [dates[0]], function (err, data) {
+  assert.equal(err, null);
+  assert.deepEqual(data, [{ ID : 0 }, { ID : 10 }]);
+
+  db.querySync("drop table " + tableName);
+  db.closeSync();
+});
@@ -0,0 +1,19 @@
+var common = require("./common")
+  , odbc = require("../")
+  , pool = new odbc.Pool({ maxPoolSize : 1, acquireTimeout : 100 })
+  , connectionString = common.connectionString
+  , assert = require("assert")
+  ;
+
+pool.open(connectionString, function (err, first) {
+  assert.equal(err, null);
+  
+  pool.open(connectionString, function (err, second) {
+    assert.notEqual(err, null);
+    assert.equal(second, undefined);
+    
+    pool.close(function () {
+      console.error("pool closed");
+    });
+  });
+});
@@ -0,0 +1,32 @@
+var common = require("./common")
+  , odbc = require("../")
+  , pool = new odbc.Pool({ maxPoolSize : 1, acquireTimeout : 5000 })
+  , connectionString = common.connectionString
+  , assert = require("assert")
+  , released = false
+  ;
+
+pool.open(connectionString, function (err, first) {
+  assert.equal(err, null);
+  
+  //the pool is full so this has to wait for the first connection
+  pool.open(connectionString, function (err, second) {
+    assert.equal(err, null);
+    assert.equal(released, true);
+    assert.equal(pool.size(connectionString), 1);
+    
+    second.query("select 1 as COLINT", function (err, data) {
+      assert.equal(err, null);
+      assert.deepEqual(data, [{ COLINT : 1 }]);
+      
+      pool.close(function () {
+        console.error("pool closed");
+      });
+    });
+  });
+  
+  setTimeout(function () {
+    released = true;
+    first.close(function () {});
+  }, 100);
+});
@@ -0,0 +1,89 @@
+var common = require("./common")
+  , odbc = require("../")
+  , db = new odbc.Database()
+  , assert = require("assert")
+  , Readable = require("stream").Readable
+  , tableName = "NODE_ODBC_STREAM_PARAM_TEST"
+  ;
+
+db.openSync(common.connectionString);
+
+try { db.querySync("drop table " + tableName); } catch (e) {}
+
+db.querySync("create table " + tableName + " (ID INTEGER, DATA BLOB, TXT TEXT)");
+
+var chunks = [];
+
+for (var i = 0; i < 20; i++) {
+  var chunk = new Buffer(10000);
+
+  for (var j = 0; j < chunk.length; j++) {
+    chunk[j] = (i + j) % 251;
+  }
+
+  chunks.push(chunk);
+}
+
+var expected = Buffer.concat(chunks);
+
+//non-ASCII text, split inside a multi-byte character
+var text = new Buffer("abcd\u00e9\u20acf")
+  , textChunks = [text.slice(0, 5), text.slice(5)];
+
+function source () {
+  var stream = new Readable(), index = 0;
+
+  stream._read = function () {
+    stream.push(index < chunks.length ? chunks[index++] : null);
+  };
+
+  return stream;
+}
+
+var stmt = db.prepareSync("insert into " + tableName + " (ID, DATA, TXT) values (?, ?, ?)");
+
+stmt.executeNonQuery([1, source(), odbc.streamParameter(textChunks, { text : true })], function (err, count) {
+  assert.equal(err, null);
+  assert.equal(count, 1);
+
+  stmt.executeNonQuery([2, chunks, null], function (err, count) {
+    assert.equal(err, null);
+
+    stmt.executeNonQuery([3, source(), odbc.streamParameter(empty(), { text : true })], function (err) {
+      assert.equal(err, null);
+
+      //the streams were consumed, so executing again without binding new
+      //ones must fail instead of waiting on them
+      stmt.executeNonQuery(function (err) {
+        assert.ok(err);
+
+        check();
+      });
+    });
+  });
+});
+
+function check () {
+  var data = db.querySync("select ID, DATA, TXT from " + tableName + " order by ID");
+
+  assert.equal(data.length, 3);
+  assert.equal(data[0].DATA.toString("hex"), expected.toString("hex"));
+  assert.equal(data[0].TXT, "abcd\u00e9\u20acf");
+  assert.equal(data[1].DATA.toString("hex"), expected.toString("hex"));
+  assert.equal(data[1].TXT, null);
+  assert.equal(data[2].TXT, "");
+
+  db.querySync("drop table " + tableName);
+  db.closeSync();
+}
+
+//a stream that ends without any data
+function empty () {
+  var stream = new Readable();
+
+  stream._read = function () {
+    stream.push(null);
+  };
+
+  return stream;
+}
@@ -0,0 +1,65 @@
+var common = require("./common")
+  , odbc = require("../")
+  , db = new odbc.Database()
+  , assert = require("assert")
+  ;
+
+/*
+ * Rebinding a prepared statement writes values that fit over the previous
+ * ones in place. Make sure that values which change type, grow or become
+ * null are still bound correctly.
+ */
+
+db.openSync(common.connectionString);
+
+var stmt = db.prepareSync("select ? as INT, ? as NUM, ? as STR, ? as BOOL, ? as BIN");
+
+var rows = [
+  [1, 1.5, "short", true, new Buffer([1, 2, 3])],
+  [2, 2.5, "tiny", false, new Buffer([4])],
+  [3, 3, "a much longer string than before", true, new Buffer([5, 6, 7, 8, 9])],
+  [null, null, null, null, null],
+  [4.5, 4, "after null", false, new Buffer([10])],
+  ["five", 5, 5, "x", null]
+];
+
+var expected = [
+  { INT : 1, NUM : 1.5, STR : "short", BOOL : true, BIN : "010203" },
+  { INT : 2, NUM : 2.5, STR : "tiny", BOOL : false, BIN : "04" },
+  { INT : 3, NUM : 3, STR : "a much longer string than before", BOOL : true, BIN : "0506070809" },
+  { INT : null, NUM : null, STR : null, BOOL : null, BIN : null },
+  { INT : 4.5, NUM : 4, STR : "after null", BOOL : false, BIN : "0a" },
+  { INT : "five", NUM : 5, STR : 5, BOOL : "x", BIN : null }
+];
+
+rows.forEach(function (row, index) {
+  stmt.bindSync(row);
+
+  var result = stmt.executeSync();
+  var data = result.fetchAllSync()[0];
+
+  result.closeSync();
+
+  if (Buffer.isBuffer(data.BIN)) {
+    data.BIN = data.BIN.toString("hex");
+  }
+
+  //sqlite hands booleans back as integers
+  if (typeof data.BOOL === "number") {
+    data.BOOL = !!data.BOOL;
+  }
+
+  assert.deepEqual(data, expected[index]);
+});
+
+//a different number of parameters rebuilds all of them
+stmt.prepareSync("select ? as A");
+stmt.bindSync(["only"]);
+
+var result = stmt.executeSync();
+
+assert.deepEqual(result.fetchAllSync(), [{ A : "only" }]);
+
+result.closeSync();
+stmt.closeSync();
+db.closeSync();
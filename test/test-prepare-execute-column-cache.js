@@ -0,0 +1,49 @@
+var common = require("./common")
+  , odbc = require("../")
+  , db = new odbc.Database()
+  , assert = require("assert")
+  ;
+
+db.openSync(common.connectionString);
+
+assert.equal(db.connected, true);
+
+var stmt = db.prepareSync("select ? as col1, 'constant' as col2");
+
+//the second execution reuses the columns described by the first one
+stmt.execute(["first"], function (err, result) {
+  assert.equal(err, null);
+  
+  result.fetchAll(function (err, data) {
+    assert.equal(err, null);
+    assert.deepEqual(data, [{ col1 : "first", col2 : "constant" }]);
+    
+    result.closeSync();
+    
+    stmt.execute(["second"], function (err, result) {
+      assert.equal(err, null);
+      
+      result.fetchAll(function (err, data) {
+        assert.equal(err, null);
+        assert.deepEqual(data, [{ col1 : "second", col2 : "constant" }]);
+        
+        result.closeSync();
+        
+        //preparing a different statement must not reuse the old columns
+        stmt.prepareSync("select 42 as other");
+        
+        stmt.execute(function (err, result) {
+          assert.equal(err, null);
+          
+          result.fetchAll(function (err, data) {
+            assert.equal(err, null);
+            assert.deepEqual(data, [{ other : 42 }]);
+            
+            result.closeSync();
+            db.closeSync();
+          });
+        });
+      });
+    });
+  });
+});
@@ -0,0 +1,70 @@
+var common = require("./common")
+  , odbc = require("../")
+  , db = new odbc.Database()
+  , assert = require("assert")
+  ;
+
+db.openSync(common.connectionString);
+
+common.dropTables(db, function () {
+  common.createTables(db, function (err, data) {
+    if (err) {
+      console.log(err);
+      
+      return finish(2);
+    }
+    
+    var stmt = db.prepareSync("insert into " + common.tableName + " (colint, coltext) VALUES (?, ?)");
+    assert.equal(stmt.constructor.name, "ODBCStatement");
+    
+    assert.throws(function () {
+      stmt.executeBatchSync([[1, 'one'], [2]]);
+    });
+    
+    //BigInts don't mix with non-integer Numbers, whichever row comes first
+    if (typeof BigInt === "function") {
+      assert.throws(function () {
+        stmt.executeBatchSync([[BigInt(1), 'one'], [2.5, 'two']]);
+      });
+      
+      assert.throws(function () {
+        stmt.executeBatchSync([[2.5, 'two'], [BigInt(1), 'one']]);
+      });
+    }
+    
+    //a rejected batch reports its error and leaves the statement usable
+    stmt.executeBatch([[1, 'one'], [2]], function (err, result) {
+      assert.ok(err);
+      assert.equal(result, undefined);
+    });
+    
+    stmt.executeBatch([[1, 'one'], [2, null], [3, 'three']], function (err, result) {
+      assert.equal(err, null);
+      assert.equal(result.affectedRows, 3);
+      assert.deepEqual(result.status, [
+          odbc.ODBC.SQL_PARAM_SUCCESS
+        , odbc.ODBC.SQL_PARAM_SUCCESS
+        , odbc.ODBC.SQL_PARAM_SUCCESS
+      ]);
+      
+      var data = db.querySync("select colint, coltext from " + common.tableName + " order by colint");
+      
+      assert.deepEqual(data, [
+          { colint : 1, coltext : 'one' }
+        , { colint : 2, coltext : null }
+        , { colint : 3, coltext : 'three' }
+      ]);
+      
+      common.dropTables(db, function () {
+        return finish(0);
+      });
+    });
+  });
+});
+
+function finish(retValue) {
+  console.log("finish exit value: %s", retValue);
+  
+  db.closeSync();
+  process.exit(retValue || 0);
+}
@@ -0,0 +1,45 @@
+var common = require("./common")
+  , odbc = require("../")
+  , db = new odbc.Database()
+  , assert = require("assert")
+  , tableName = "NODE_ODBC_TYPED_PARAM_TEST"
+  ;
+
+db.openSync(common.connectionString);
+
+try { db.querySync("drop table " + tableName); } catch (e) {}
+
+db.querySync("create table " + tableName + " (ID INTEGER, BIG BIGINT, AMOUNT DECIMAL(10,2), NAME VARCHAR(20))");
+
+//parameter types come from SQLDescribeParam where the driver supports it
+var stmt = db.prepareSync("insert into " + tableName + " (ID, BIG, AMOUNT, NAME) values (?, ?, ?, ?)");
+
+stmt.bindSync([1, Math.pow(2, 40), 12.5, "first"]);
+stmt.executeNonQuerySync();
+
+//explicit types
+stmt.bindSync([
+  { type : odbc.SQL_INTEGER, value : 2 },
+  { type : odbc.SQL_BIGINT, value : Math.pow(2, 41) },
+  { type : odbc.SQL_DECIMAL, precision : 10, scale : 2, value : 0.25 },
+  { type : odbc.SQL_VARCHAR, precision : 20, value : "second" }
+]);
+stmt.executeNonQuerySync();
+
+//a typed null
+stmt.bindSync([3, { type : odbc.SQL_BIGINT, value : null }, null, "third"]);
+stmt.executeNonQuerySync();
+
+stmt.closeSync();
+
+var data = db.querySync("select ID, BIG, AMOUNT, NAME from " + tableName + " where ID >= ? order by ID",
+  [{ type : odbc.SQL_INTEGER, value : 1 }]);
+
+assert.deepEqual(data, [
+  { ID : 1, BIG : Math.pow(2, 40), AMOUNT : 12.5, NAME : "first" },
+  { ID : 2, BIG : Math.pow(2, 41), AMOUNT : 0.25, NAME : "second" },
+  { ID : 3, BIG : null, AMOUNT : null, NAME : "third" }
+]);
+
+db.querySync("drop table " + tableName);
+db.closeSync();
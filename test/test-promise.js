@@ -0,0 +1,79 @@
+var common = require("./common")
+  , odbc = require("../")
+  , db = new odbc.Database()
+  , assert = require("assert")
+  ;
+
+db.openSync(common.connectionString);
+
+//async methods called without a callback return a Promise when the addon
+//was built against a V8 with Promise::Resolver support
+if (!odbc.NATIVE_PROMISES) {
+  //otherwise the callback is still required, by the native methods and the
+  //queued JavaScript wrappers alike
+  var unpromised = db.prepareSync("select ? as B");
+  
+  assert.throws(function () {
+    db.conn.query("select 1 as COLINT");
+  }, TypeError);
+  
+  assert.throws(function () {
+    unpromised.execute([3]);
+  }, TypeError);
+  
+  unpromised.closeSync();
+  db.closeSync();
+  
+  //always the case with the nan 1.8 dependency, which doesn't build against V8 5
+  console.log("Native promises are not available in this build; skipping");
+  return;
+}
+
+var conn = db.conn, stmt;
+
+conn.query("select 1 as COLINT, 'abc' as COLTEXT").then(function (result) {
+  return result.fetchAll().then(function (data) {
+    assert.deepEqual(data, [{ COLINT : 1, COLTEXT : "abc" }]);
+
+    result.closeSync();
+  });
+}).then(function () {
+  return conn.query("select ? as A", [2]);
+}).then(function (result) {
+  return result.fetch().then(function (row) {
+    assert.deepEqual(row, { A : 2 });
+
+    return result.fetch();
+  }).then(function (row) {
+    //no more rows
+    assert.equal(row, null);
+
+    result.closeSync();
+  });
+}).then(function () {
+  return conn.query("select * from NODE_ODBC_NOT_A_TABLE").then(function () {
+    assert.fail("the query should have failed");
+  }, function (err) {
+    assert.ok(err.message);
+  });
+}).then(function () {
+  stmt = db.prepareSync("select ? as B");
+
+  return stmt.execute([3]);
+}).then(function (result) {
+  assert.deepEqual(result.fetchAllSync(), [{ B : 3 }]);
+
+  result.closeSync();
+  stmt.closeSync();
+
+  return conn.beginTransaction().then(function () {
+    return conn.endTransaction(true);
+  });
+}).then(function () {
+  return conn.close();
+}).then(function () {
+  assert.equal(conn.connected, false);
+}).catch(function (err) {
+  console.error(err);
+  process.exit(1);
+});
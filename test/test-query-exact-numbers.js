@@ -0,0 +1,73 @@
+var common = require("./common")
+  , odbc = require("../")
+  , db = new odbc.Database()
+  , assert = require("assert")
+  , tableName = "NODE_ODBC_EXACT_NUMBERS_TEST"
+  ;
+
+db.openSync(common.connectionString);
+
+try { db.querySync("drop table " + tableName); } catch (e) {}
+
+db.querySync("create table " + tableName + " (ID INTEGER, BIG BIGINT, AMOUNT DECIMAL(10,2))");
+
+//2^53 + 1 can not be represented by a double
+db.querySync("insert into " + tableName + " (ID, BIG, AMOUNT) values (1, 9007199254740993, 12.5)");
+db.querySync("insert into " + tableName + " (ID, BIG, AMOUNT) values (2, null, null)");
+
+var sql = "select ID, BIG, AMOUNT from " + tableName + " order by ID";
+
+//BigInt where V8 has it, the decimal digits otherwise
+function exact (digits) {
+  return (typeof BigInt === "function") ? BigInt(digits) : digits;
+}
+
+function check (data) {
+  assert.equal(data.length, 2);
+  assert.equal(data[0].ID, 1);
+  assert.ok(data[0].BIG === exact("9007199254740993"));
+  assert.equal(typeof data[0].AMOUNT, "string");
+  assert.equal(parseFloat(data[0].AMOUNT), 12.5);
+  assert.equal(data[1].BIG, null);
+  assert.equal(data[1].AMOUNT, null);
+}
+
+//the default is unchanged
+var asDouble = db.querySync(sql);
+
+assert.equal(typeof asDouble[0].BIG, "number");
+assert.equal(typeof asDouble[0].AMOUNT, "number");
+
+var result = db.queryResultSync(sql);
+result.exactNumbers = true;
+assert.equal(result.exactNumbers, true);
+
+check(result.fetchAllSync());
+result.closeSync();
+
+result = db.queryResultSync(sql);
+check(result.fetchAllSync({ exactNumbers : true }));
+result.closeSync();
+
+db.queryResult(sql, function (err, result) {
+  assert.equal(err, null);
+
+  //block cursor fetches bind the columns as SQL_C_SBIGINT and text
+  result.fetchAll({ exactNumbers : true, rowArraySize : 10 }, function (err, data) {
+    assert.equal(err, null);
+    check(data);
+
+    result.closeSync();
+
+    db.closeSync();
+
+    var db2 = new odbc.Database({ exactNumbers : true });
+
+    db2.openSync(common.connectionString);
+
+    check(db2.querySync(sql));
+
+    db2.querySync("drop table " + tableName);
+    db2.closeSync();
+  });
+});
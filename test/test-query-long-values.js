@@ -0,0 +1,50 @@
+var common = require("./common")
+  , odbc = require("../")
+  , db = new odbc.Database()
+  , assert = require("assert")
+  ;
+
+db.openSync(common.connectionString);
+
+common.dropTables(db, function () {
+  common.createTables(db, function (err) {
+    assert.equal(err, null);
+    
+    //longer than a single SQLGetData chunk, both pure ASCII and with
+    //multi-byte characters
+    var ascii = repeat('{"key":"value","list":[1,2,3]}', 3 * 1024 * 1024);
+    var unicode = repeat('héllo wörld 世界 ', 3 * 1024 * 1024);
+    var short = repeat('abc', 100);
+    
+    db.querySync("insert into " + common.tableName + " (COLINT, COLTEXT) values (?, ?)", [1, ascii]);
+    db.querySync("insert into " + common.tableName + " (COLINT, COLTEXT) values (?, ?)", [2, unicode]);
+    db.querySync("insert into " + common.tableName + " (COLINT, COLTEXT) values (?, ?)", [3, short]);
+    
+    var data = db.querySync("select COLINT, COLTEXT from " + common.tableName + " order by COLINT");
+    
+    assert.equal(data[0].COLTEXT.length, ascii.length);
+    assert.ok(data[0].COLTEXT === ascii);
+    assert.equal(data[1].COLTEXT.length, unicode.length);
+    assert.ok(data[1].COLTEXT === unicode);
+    assert.equal(data[2].COLTEXT, short);
+    
+    db.query("select COLTEXT from " + common.tableName + " where COLINT = ?", [1], function (err, data) {
+      assert.equal(err, null);
+      assert.ok(data[0].COLTEXT === ascii);
+      
+      common.dropTables(db, function () {
+        db.closeSync();
+      });
+    });
+  });
+});
+
+function repeat(str, length) {
+  var result = str;
+  
+  while (result.length < length) {
+    result += result;
+  }
+  
+  return result.substr(0, length);
+}
@@ -0,0 +1,25 @@
+var common = require("./common")
+  , odbc = require("../")
+  , db = new odbc.Database()
+  , assert = require("assert")
+  ;
+
+db.openSync(common.connectionString);
+
+assert.equal(db.connected, true);
+
+db.queryResult("select 1 as COLINT, 'some test' as COLTEXT union select 2, 'something else' union select 3, 'a third thing'", function (err, result) {
+  assert.equal(err, null);
+  assert.equal(result.chunkSize > 0, true);
+  
+  //force more than one trip to the thread pool
+  result.fetchAll({ chunkSize : 2 }, function (err, data) {
+    db.closeSync();
+    assert.equal(err, null);
+    assert.deepEqual(data, [
+        {"COLINT":1,"COLTEXT":"some test"}
+      ,{"COLINT":2,"COLTEXT":"something else"}
+      ,{"COLINT":3,"COLTEXT":"a third thing"}
+    ]);
+  });
+});
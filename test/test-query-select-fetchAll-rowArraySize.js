@@ -0,0 +1,56 @@
+var common = require("./common")
+  , odbc = require("../")
+  , db = new odbc.Database()
+  , assert = require("assert")
+  ;
+
+db.openSync(common.connectionString);
+
+assert.equal(db.connected, true);
+
+db.queryResult("select 1 as COLINT, 'some test' as COLTEXT union select 2, 'something else' union select 3, 'a third thing'", function (err, result) {
+  assert.equal(err, null);
+  assert.equal(result.rowArraySize, 1);
+  
+  //the last rowset is only partially filled; drivers that can't do block
+  //cursors fall back to single row fetches and must return the same rows
+  result.fetchAll({ rowArraySize : 2, chunkSize : 2 }, function (err, data) {
+    assert.equal(err, null);
+    assert.deepEqual(data, [
+        {"COLINT":1,"COLTEXT":"some test"}
+      ,{"COLINT":2,"COLTEXT":"something else"}
+      ,{"COLINT":3,"COLTEXT":"a third thing"}
+    ]);
+    
+    fetchTruncated();
+  });
+});
+
+//values longer than the declared column size do not fit in the bound
+//buffer; they are read in full instead of failing the fetch
+function fetchTruncated() {
+  var long = new Array(200).join("x");
+  
+  try { db.querySync("drop table NODE_ODBC_BOUND_TRUNCATE_TEST"); } catch (e) {}
+  
+  db.querySync("create table NODE_ODBC_BOUND_TRUNCATE_TEST (COLINT INTEGER, COLTEXT VARCHAR(4))");
+  db.querySync("insert into NODE_ODBC_BOUND_TRUNCATE_TEST values (1, 'abc')");
+  db.querySync("insert into NODE_ODBC_BOUND_TRUNCATE_TEST values (2, ?)", [long]);
+  db.querySync("insert into NODE_ODBC_BOUND_TRUNCATE_TEST values (3, 'def')");
+  
+  db.queryResult("select COLINT, COLTEXT from NODE_ODBC_BOUND_TRUNCATE_TEST order by COLINT", function (err, result) {
+    assert.equal(err, null);
+    
+    result.fetchAll({ rowArraySize : 2, chunkSize : 2 }, function (err, data) {
+      db.querySync("drop table NODE_ODBC_BOUND_TRUNCATE_TEST");
+      db.closeSync();
+      
+      assert.equal(err, null);
+      assert.deepEqual(data, [
+          {"COLINT":1,"COLTEXT":"abc"}
+        ,{"COLINT":2,"COLTEXT":long}
+        ,{"COLINT":3,"COLTEXT":"def"}
+      ]);
+    });
+  });
+}
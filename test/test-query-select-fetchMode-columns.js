@@ -0,0 +1,36 @@
+var common = require("./common")
+  , odbc = require("../")
+  , db = odbc({ fetchMode : odbc.FETCH_COLUMNS })
+  , assert = require("assert")
+  ;
+
+db.openSync(common.connectionString);
+
+assert.equal(db.connected, true);
+
+db.query("select 1 as COLINT, 'some test' as COLTEXT union select 2, null union select 3, 'a third thing'", function (err, data) {
+  assert.equal(err, null);
+  
+  db.closeSync();
+  
+  assert.equal(data.COLINT.type, "int32");
+  assert.deepEqual(Array.prototype.slice.call(data.COLINT.values), [1, 2, 3]);
+  assert.equal(data.COLINT.nulls[0], 0);
+  
+  var text = data.COLTEXT
+    , values = [];
+  
+  assert.equal(text.type, "string");
+  assert.equal(text.offsets.length, 4);
+  
+  for (var i = 0; i < 3; i++) {
+    if (text.nulls[i >> 3] & (1 << (i % 8))) {
+      values.push(null);
+    }
+    else {
+      values.push(text.values.toString(text.encoding, text.offsets[i], text.offsets[i + 1]));
+    }
+  }
+  
+  assert.deepEqual(values, ["some test", null, "a third thing"]);
+});
@@ -0,0 +1,55 @@
+var common = require("./common")
+  , odbc = require("../")
+  , db = new odbc.Database({ statementCacheSize : 2 })
+  , assert = require("assert")
+  ;
+
+db.openSync(common.connectionString);
+
+assert.equal(db.connected, true);
+
+assert.deepEqual(db.querySync("select ? as COLINT", [1]), [{ COLINT : 1 }]);
+assert.deepEqual(db.querySync("select ? as COLINT", [2]), [{ COLINT : 2 }]);
+
+var stats = db.getStatementCacheStats();
+
+assert.equal(stats.misses, 1);
+assert.equal(stats.hits, 1);
+assert.equal(stats.size, 1);
+
+db.query("select ? as COLTEXT", ["a"], function (err, data) {
+  assert.equal(err, null);
+  assert.deepEqual(data, [{ COLTEXT : "a" }]);
+  
+  //a third statement pushes out the least recently used one
+  db.query("select ? + 1 as COLINT", [1], function (err, data) {
+    assert.equal(err, null);
+    assert.deepEqual(data, [{ COLINT : 2 }]);
+    
+    var stats = db.getStatementCacheStats();
+    
+    assert.equal(stats.misses, 3);
+    assert.equal(stats.evictions, 1);
+    assert.equal(stats.size, 2);
+    
+    db.clearStatementCache();
+    
+    assert.equal(db.getStatementCacheStats().size, 0);
+    
+    //a statement that fails because its table is gone is not kept
+    db.querySync("create table NODE_ODBC_CACHE_TEST (COLINT INTEGER)");
+    
+    assert.deepEqual(db.querySync("select COLINT from NODE_ODBC_CACHE_TEST where COLINT = ?", [1]), []);
+    assert.equal(db.getStatementCacheStats().size, 1);
+    
+    db.querySync("drop table NODE_ODBC_CACHE_TEST");
+    
+    assert.throws(function () {
+      db.querySync("select COLINT from NODE_ODBC_CACHE_TEST where COLINT = ?", [1]);
+    });
+    
+    assert.equal(db.getStatementCacheStats().size, 0);
+    
+    db.closeSync();
+  });
+});
@@ -0,0 +1,43 @@
+var common = require("./common")
+  , odbc = require("../")
+  , db = new odbc.Database()
+  , assert = require("assert")
+  ;
+
+db.openSync(common.connectionString);
+
+assert.equal(db.connected, true);
+
+var before = db.conn.getStatementStats();
+
+for (var i = 0; i < 5; i++) {
+  assert.deepEqual(db.querySync("select ? as COLINT", [i]), [{ COLINT : i }]);
+}
+
+var after = db.conn.getStatementStats();
+
+//the first query allocates a handle, the rest reuse it
+assert.equal(after.misses - before.misses, 1);
+assert.equal(after.hits - before.hits, 4);
+assert.equal(after.pooled, 1);
+
+db.query("select 1 as COLINT", function (err, data) {
+  assert.equal(err, null);
+  assert.deepEqual(data, [{ COLINT : 1 }]);
+  
+  assert.equal(db.conn.getStatementStats().hits - after.hits, 1);
+  
+  var conn = db.conn;
+  
+  db.closeSync();
+  
+  //the native connection has no pool left to take a handle from
+  assert.throws(function () {
+    conn.querySync("select 1 as COLINT");
+  }, /Connection not open/);
+  
+  conn.query("select 1 as COLINT", function (err, result) {
+    assert.ok(err);
+    assert.equal(result, undefined);
+  });
+});
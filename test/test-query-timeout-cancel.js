@@ -0,0 +1,70 @@
+var common = require("./common")
+  , odbc = require("../")
+  , db = new odbc.Database({ queryTimeout : 5 })
+  , assert = require("assert")
+  ;
+
+db.openSync(common.connectionString);
+
+assert.equal(db.connected, true);
+
+//nothing is executing
+assert.equal(db.cancel(), false);
+
+assert.deepEqual(db.querySync("select 1 as COLINT"), [{ COLINT : 1 }]);
+
+db.query("select ? as COLINT", [2], function (err, data) {
+  assert.equal(err, null);
+  assert.deepEqual(data, [{ COLINT : 2 }]);
+  
+  db.conn.query({ sql : "select 3 as COLINT", timeout : 1 }, function (err, result) {
+    assert.equal(err, null);
+    assert.deepEqual(result.fetchAllSync(), [{ COLINT : 3 }]);
+    
+    result.closeSync();
+    
+    streamQuery();
+  });
+});
+
+//queryStream runs with the queryTimeout as well
+function streamQuery() {
+  var batches = [];
+  var stream = db.queryStream("select ? as COLINT", [4]);
+  
+  stream.on("data", function (rows) {
+    batches.push(rows);
+  });
+  
+  stream.on("error", function (err) {
+    assert.equal(err, null);
+  });
+  
+  stream.on("end", function () {
+    assert.deepEqual(batches, [[{ COLINT : 4 }]]);
+    
+    cancelLongQuery();
+  });
+}
+
+//a query that takes a long time to fetch is stopped with HY008 (or HYT00 if
+//the timeout gets there first)
+function cancelLongQuery() {
+  var canceled = null;
+  
+  db.query("with recursive C(X) as (select 1 union all select X + 1 from C where X < 100000000) "
+    + "select X as COLINT from C", function (err, data) {
+    assert.equal(canceled, true);
+    assert.ok(err);
+    assert.ok(err.state === "HY008" || err.state === "HYT00", "unexpected state " + err.state);
+    
+    //nothing is left running
+    assert.equal(db.cancel(), false);
+    
+    db.closeSync();
+  });
+  
+  setTimeout(function () {
+    canceled = db.cancel();
+  }, 200);
+}
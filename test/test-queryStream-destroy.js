@@ -0,0 +1,35 @@
+var common = require("./common")
+  , odbc = require("../")
+  , db = new odbc.Database()
+  , assert = require("assert")
+  , batches = 0
+  ;
+
+db.openSync(common.connectionString);
+
+var stream = db.queryStream("select 1 as COLINT union select 2 union select 3 union select 4 union select 5", { chunkSize : 1 });
+
+stream.on("data", function (rows) {
+  batches++;
+  
+  //stop reading after the first batch
+  stream.destroy();
+});
+
+stream.on("end", function () {
+  assert.fail("a destroyed stream does not end");
+});
+
+stream.on("error", function (err) {
+  assert.equal(err, null);
+});
+
+//the query queued behind the stream only runs once the destroyed stream has
+//closed its result and released the connection
+db.query("select 1 as COLINT", function (err, data) {
+  db.closeSync();
+  
+  assert.equal(err, null);
+  assert.deepEqual(data, [{ COLINT : 1 }]);
+  assert.equal(batches, 1);
+});
@@ -0,0 +1,37 @@
+var common = require("./common")
+  , odbc = require("../")
+  , db = new odbc.Database()
+  , assert = require("assert")
+  , batches = []
+  ;
+
+db.openSync(common.connectionString);
+
+assert.equal(db.connected, true);
+
+var stream = db.queryStream("select 1 as COLINT union select 2 union select 3 union select 4 union select 5", { chunkSize : 2 });
+
+stream.on("data", function (rows) {
+  batches.push(rows);
+});
+
+stream.on("error", function (err) {
+  db.closeSync();
+  assert.equal(err, null);
+});
+
+stream.on("end", function () {
+  assert.deepEqual(batches, [
+    [{ COLINT : 1 }, { COLINT : 2 }],
+    [{ COLINT : 3 }, { COLINT : 4 }],
+    [{ COLINT : 5 }]
+  ]);
+  
+  //the connection is free again once the stream has ended
+  db.query("select 1 as COLINT", function (err, data) {
+    db.closeSync();
+    
+    assert.equal(err, null);
+    assert.deepEqual(data, [{ COLINT : 1 }]);
+  });
+});
@@ -0,0 +1,105 @@
+var common = require("./common")
+  , odbc = require("../")
+  , db = new odbc.Database()
+  , assert = require("assert")
+  ;
+
+db.openSync(common.connectionString);
+
+common.dropTables(db, function () {
+  common.createTables(db, function (err) {
+    assert.equal(err, null);
+    
+    var text = '';
+    
+    while (text.length < 1024 * 1024) {
+      text += '<item id="' + text.length + '"/>';
+    }
+    
+    db.querySync("insert into " + common.tableName + " (COLINT, COLTEXT) values (?, ?)", [1, text]);
+    db.querySync("insert into " + common.tableName + " (COLINT, COLTEXT) values (?, ?)", [2, null]);
+    db.querySync("insert into " + common.tableName + " (COLINT, COLTEXT) values (?, ?)", [3, text]);
+    db.querySync("insert into " + common.tableName + " (COLINT, COLTEXT) values (?, ?)", [4, text]);
+    
+    db.queryResult("select COLINT, COLTEXT from " + common.tableName + " order by COLINT", function (err, result) {
+      assert.equal(err, null);
+      
+      var rows = [], skipped = [];
+      
+      //a regular column after a streamed one is rejected
+      result.fetch({ streamColumns : ['COLINT'] }, function (err, row) {
+        assert.ok(err);
+      });
+      
+      fetchNext();
+      
+      function fetchNext() {
+        result.fetch({ streamColumns : ['COLTEXT'], streamChunkSize : 4096 }, function (err, row) {
+          assert.equal(err, null);
+          
+          if (!row) {
+            return finish();
+          }
+          
+          var chunks = [], chunkCount = 0;
+          
+          //a NULL column is not a stream
+          if (row.COLINT === 2) {
+            assert.strictEqual(row.COLTEXT, null);
+            rows.push({ id : row.COLINT, value : null });
+            
+            return fetchNext();
+          }
+          
+          assert.ok(row.COLTEXT && typeof row.COLTEXT.pipe === 'function');
+          
+          //a destroyed stream and one nobody reads must not hold up the
+          //next fetch
+          if (row.COLINT === 3) {
+            skipped.push(row.COLINT);
+            row.COLTEXT.destroy();
+            
+            return fetchNext();
+          }
+          
+          if (row.COLINT === 4) {
+            skipped.push(row.COLINT);
+            
+            return fetchNext();
+          }
+          
+          row.COLTEXT.on('data', function (chunk) {
+            assert.ok(Buffer.isBuffer(chunk));
+            chunks.push(chunk);
+            chunkCount++;
+          });
+          
+          row.COLTEXT.on('end', function () {
+            rows.push({ id : row.COLINT, value : Buffer.concat(chunks), chunks : chunkCount });
+          });
+          
+          fetchNext();
+        });
+      }
+      
+      function finish() {
+        result.closeSync();
+        
+        rows.sort(function (a, b) { return a.id - b.id; });
+        
+        assert.equal(rows.length, 2);
+        assert.equal(rows[0].id, 1);
+        assert.ok(rows[0].chunks > 1);
+        //text arrives in the driver's encoding: utf16le for UNICODE builds
+        assert.ok(rows[0].value.toString('utf8') === text || rows[0].value.toString('utf16le') === text);
+        assert.equal(rows[1].id, 2);
+        assert.strictEqual(rows[1].value, null);
+        assert.deepEqual(skipped, [3, 4]);
+        
+        common.dropTables(db, function () {
+          db.closeSync();
+        });
+      }
+    });
+  });
+});
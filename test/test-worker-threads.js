@@ -0,0 +1,38 @@
+var common = require("./common")
+  , odbc = require("../")
+  , assert = require("assert")
+  , openCount = 4
+  , doneCount = 0
+  ;
+
+odbc.setWorkerThreads(2);
+
+//threads can be added but not taken away
+odbc.setWorkerThreads(4);
+
+assert.throws(function () {
+  odbc.setWorkerThreads(1);
+});
+
+for (var x = 0; x < openCount; x++) {
+  (function (x) {
+    var db = new odbc.Database();
+    
+    db.open(common.connectionString, function (err) {
+      assert.equal(err, null);
+      
+      db.query("select ? as COLINT", [x], function (err, data) {
+        assert.equal(err, null);
+        assert.deepEqual(data, [{ COLINT : x }]);
+        
+        db.close(function () {
+          doneCount += 1;
+        });
+      });
+    });
+  })(x);
+}
+
+process.on("exit", function () {
+  assert.equal(doneCount, openCount);
+});